@@ -2,6 +2,7 @@
 #include "async_core/events.h"
 #include "async_vfo.h"
 #include "core/vfo_channel.h"
+#include "dsp/perf_counters.h"
 #include "error_codes.h"
 #include "utility/worker_thread.h"
 
@@ -14,7 +15,11 @@
 namespace violetrx
 {
 
-int64_t EventCommon::last_id = 0;
+// Time between FFT frames written to shared memory, 25 per second
+constexpr auto kShmFftPeriod = std::chrono::milliseconds(40);
+
+// How often the snapshot read by getMetrics() is refreshed
+constexpr auto kMetricsRefreshPeriod = std::chrono::seconds(1);
 
 #define INVOKE(callback, ...)                                                  \
     if (callback) {                                                            \
@@ -48,6 +53,7 @@ void invokeDefault(Callback<Args...>& callback, ErrorCode code)
 template <typename Event, typename... Args>
 void AsyncReceiver::stateChanged(Args... args)
 {
+    updateState<Event>(args...);
     signalStateChanged(
         createEvent<Event>(EventCommon::make(), std::move(args)...));
 }
@@ -173,6 +179,11 @@ AsyncReceiver::createEvent<IqRecordingStopped>(EventCommon ec) const
     return IqRecordingStopped{ec};
 }
 template <>
+InputEof AsyncReceiver::createEvent<InputEof>(EventCommon ec) const
+{
+    return InputEof{ec};
+}
+template <>
 FftWindowChanged
 AsyncReceiver::createEvent<FftWindowChanged>(EventCommon ec) const
 {
@@ -183,6 +194,145 @@ FftSizeChanged AsyncReceiver::createEvent<FftSizeChanged>(EventCommon ec) const
 {
     return FftSizeChanged{ec, getIqFftSize()};
 }
+// Events that don't carry receiver state leave it alone.
+template <typename Event, typename... Args>
+void AsyncReceiver::updateState(const Args&...)
+{
+}
+template <>
+void AsyncReceiver::updateState<Started>()
+{
+    state.running = rx->is_running();
+}
+template <>
+void AsyncReceiver::updateState<Stopped>()
+{
+    state.running = rx->is_running();
+}
+template <>
+void AsyncReceiver::updateState<InputDeviceChanged>()
+{
+    state.inputDevice = rx->get_input_device();
+}
+template <>
+void AsyncReceiver::updateState<GainStagesChanged>()
+{
+    state.gainStages = readGainStages();
+}
+template <>
+void AsyncReceiver::updateState<AntennasChanged>()
+{
+    state.antennas = rx->get_antennas();
+}
+template <>
+void AsyncReceiver::updateState<AntennaChanged>()
+{
+    state.antenna = rx->get_antenna();
+}
+template <>
+void AsyncReceiver::updateState<RfFreqChanged>()
+{
+    state.rfFreq = rx->get_rf_freq();
+}
+template <>
+void AsyncReceiver::updateState<InputRateChanged>()
+{
+    state.inputRate = rx->get_input_rate();
+}
+template <>
+void AsyncReceiver::updateState<InputDecimChanged>()
+{
+    state.inputDecim = rx->get_input_decim();
+}
+template <>
+void AsyncReceiver::updateState<IqSwapChanged>()
+{
+    state.iqSwap = rx->get_iq_swap();
+}
+template <>
+void AsyncReceiver::updateState<DcCancelChanged>()
+{
+    state.dcCancel = rx->get_dc_cancel();
+}
+template <>
+void AsyncReceiver::updateState<IqBalanceChanged>()
+{
+    state.iqBalance = rx->get_iq_balance();
+}
+template <>
+void AsyncReceiver::updateState<AutoGainChanged>()
+{
+    state.autoGain = rx->get_auto_gain();
+}
+template <>
+void AsyncReceiver::updateState<FreqCorrChanged>()
+{
+    state.freqCorr = rx->get_freq_corr();
+}
+template <>
+void AsyncReceiver::updateState<GainChanged>(const std::string& name,
+                                             const double& value)
+{
+    for (auto& stage : state.gainStages) {
+        if (stage.name == name)
+            stage.value = value;
+    }
+}
+template <>
+void AsyncReceiver::updateState<IqRecordingStarted>()
+{
+    state.iqRecording = rx->is_iq_recording();
+    state.iqRecordingPath = rx->get_iq_filename();
+}
+template <>
+void AsyncReceiver::updateState<IqRecordingStopped>()
+{
+    state.iqRecording = rx->is_iq_recording();
+}
+template <>
+void AsyncReceiver::updateState<FftSizeChanged>()
+{
+    state.fftSize = rx->iq_fft_size();
+}
+template <>
+void AsyncReceiver::updateState<FftWindowChanged>()
+{
+    state.fftWindow = (WindowType)rx->get_iq_fft_window();
+}
+
+void AsyncReceiver::updateAllState()
+{
+    updateState<Started>();
+    updateState<InputDeviceChanged>();
+    updateState<GainStagesChanged>();
+    updateState<AntennasChanged>();
+    updateState<AntennaChanged>();
+    updateState<RfFreqChanged>();
+    updateState<InputRateChanged>();
+    updateState<InputDecimChanged>();
+    updateState<IqSwapChanged>();
+    updateState<DcCancelChanged>();
+    updateState<IqBalanceChanged>();
+    updateState<AutoGainChanged>();
+    updateState<FreqCorrChanged>();
+    updateState<IqRecordingStarted>();
+    updateState<FftSizeChanged>();
+    updateState<FftWindowChanged>();
+}
+
+std::vector<GainStage> AsyncReceiver::readGainStages() const
+{
+    std::vector<GainStage> gainStages;
+    for (const std::string& name : rx->get_gain_names()) {
+        double value = rx->get_gain(name);
+        double start, stop, step;
+        rx->get_gain_range(name, &start, &stop, &step);
+        gainStages.push_back(GainStage{name, start, stop, step, value});
+    }
+
+    return gainStages;
+}
+
 AsyncReceiver::sptr AsyncReceiver::make()
 {
     return std::make_shared<AsyncReceiver>();
@@ -191,11 +341,33 @@ AsyncReceiver::sptr AsyncReceiver::make()
 AsyncReceiver::AsyncReceiver()
 {
     rx = receiver::make();
+    updateAllState();
+
     workerThread = std::make_shared<WorkerThread>();
     workerThread->start();
+
+    // called from the scheduler thread when file playback is over, right
+    // before the source finishes. The rest of the graph drains on its own, so
+    // it is waited for rather than stopped, which would drop the tail.
+    rx->set_input_eof_callback([this]() {
+        schedule([this]() {
+            if (rx->is_running()) {
+                rx->wait_done();
+                stateChanged<Stopped>();
+            }
+            stateChanged<InputEof>();
+        });
+    });
 }
 
-AsyncReceiver::~AsyncReceiver() { spdlog::debug("~AsyncReceiver"); }
+AsyncReceiver::~AsyncReceiver()
+{
+    spdlog::debug("~AsyncReceiver");
+    rx->set_input_eof_callback({});
+
+    // the VFOs may keep the worker thread alive, waits for a running refresh
+    workerThread->setPeriodicTask(std::chrono::milliseconds{0}, {});
+}
 
 template <typename Function>
 auto AsyncReceiver::schedule(Function&& func, const std::source_location loc)
@@ -271,7 +443,7 @@ void AsyncReceiver::setAntenna(std::string antenna, Callback<> callback)
 
     schedule([this, antenna = std::move(antenna),
               callback = std::move(callback)]() mutable {
-        std::string old_antenna = rx->get_antenna();
+        std::string old_antenna = state.antenna;
 
         if (antenna == old_antenna) {
             CALLBACK_ON_SUCCESS();
@@ -294,7 +466,7 @@ void AsyncReceiver::setInputRate(int rate, Callback<int> callback)
     RETURN_IF_WORKER_BUSY();
 
     schedule([this, rate, callback = std::move(callback)]() mutable {
-        int old_rate = (int)rx->get_input_rate();
+        int old_rate = state.inputRate;
         if (old_rate == rate) {
             CALLBACK_ON_SUCCESS(rate);
             return;
@@ -381,7 +553,7 @@ void AsyncReceiver::setAutoGain(bool enable, Callback<> callback)
     RETURN_IF_WORKER_BUSY();
 
     schedule([this, enable, callback = std::move(callback)]() mutable {
-        bool old_auto_gain = rx->get_auto_gain();
+        bool old_auto_gain = state.autoGain;
 
         if (enable == old_auto_gain) {
             CALLBACK_ON_SUCCESS();
@@ -402,7 +574,7 @@ void AsyncReceiver::setRfFreq(int64_t freq, Callback<int64_t> callback)
     RETURN_IF_WORKER_BUSY();
 
     schedule([this, freq, callback = std::move(callback)]() mutable {
-        int64_t old_freq = (int64_t)rx->get_rf_freq();
+        int64_t old_freq = state.rfFreq;
         if (old_freq == freq) {
             CALLBACK_ON_SUCCESS(freq);
             return;
@@ -422,11 +594,10 @@ void AsyncReceiver::setGain(std::string gain, double val,
 
     schedule([this, gain = std::move(gain), val,
               callback = std::move(callback)]() mutable {
-        // should we cache this vector?
-        std::vector<std::string> gains = rx->get_gain_names();
-
-        auto it = std::find(gains.begin(), gains.end(), gain);
-        if (it == gains.end()) {
+        auto it = std::find_if(
+            state.gainStages.begin(), state.gainStages.end(),
+            [&](const GainStage& stage) { return stage.name == gain; });
+        if (it == state.gainStages.end()) {
             CALLBACK_ON_ERROR(GAIN_NOT_FOUND);
             return;
         }
@@ -511,17 +682,19 @@ void AsyncReceiver::getIqFftData(
     });
 }
 
-void AsyncReceiver::startIqRecording(std::string filepath, Callback<> callback)
+void AsyncReceiver::startIqRecording(std::string filepath, IqFormat format,
+                                     Callback<> callback)
 {
     RETURN_IF_WORKER_BUSY();
 
-    schedule([this, filepath = std::move(filepath),
+    schedule([this, filepath = std::move(filepath), format,
               callback = std::move(callback)]() mutable {
         if (rx->is_iq_recording()) {
             CALLBACK_ON_ERROR(ALREADY_RECORDING);
             return;
         }
-        if (rx->start_iq_recording(filepath)) {
+        if (rx->start_iq_recording(filepath,
+                                   (iq_file_sink::format)format)) {
             CALLBACK_ON_SUCCESS();
             stateChanged<IqRecordingStarted>();
         } else {
@@ -549,6 +722,108 @@ void AsyncReceiver::stopIqRecording(Callback<> callback)
     });
 }
 
+void AsyncReceiver::setIqHistory(double seconds, Callback<> callback)
+{
+    RETURN_IF_WORKER_BUSY();
+
+    schedule([this, seconds, callback = std::move(callback)]() mutable {
+        rx->set_iq_history(seconds);
+        CALLBACK_ON_SUCCESS();
+    });
+}
+
+void AsyncReceiver::saveIqSnapshot(std::string filepath, double secondsBefore,
+                                   double secondsAfter, Callback<> callback)
+{
+    RETURN_IF_WORKER_BUSY();
+
+    schedule([this, filepath = std::move(filepath), secondsBefore,
+              secondsAfter, callback = std::move(callback)]() mutable {
+        if (rx->get_iq_history() == 0) {
+            CALLBACK_ON_ERROR(IQ_HISTORY_DISABLED);
+            return;
+        }
+        if (rx->save_iq_snapshot(filepath, secondsBefore, secondsAfter)) {
+            CALLBACK_ON_SUCCESS();
+        } else {
+            CALLBACK_ON_ERROR(COULDNT_CREATE_FILE);
+        }
+    });
+}
+
+void AsyncReceiver::startShmOutput(std::string prefix, Callback<> callback)
+{
+    RETURN_IF_WORKER_BUSY();
+
+    schedule([this, prefix = std::move(prefix),
+              callback = std::move(callback)]() mutable {
+        if (!shmPrefix.empty()) {
+            CALLBACK_ON_ERROR(SHM_OUTPUT_ALREADY_ACTIVE);
+            return;
+        }
+        if (prefix.empty() || !rx->start_shm_output(prefix)) {
+            CALLBACK_ON_ERROR(COULDNT_CREATE_FILE);
+            return;
+        }
+
+        shmPrefix = std::move(prefix);
+        for (auto& vfo : vfos)
+            startVfoShmOutput(vfo);
+
+        // FFT frames are computed on demand, so they're computed here at a
+        // steady rate, in the worker thread like every other use of the FFT.
+        // A busy worker skips frames instead of piling up publishes.
+        shmFftPending = false;
+        shmFftThread = std::jthread([this](std::stop_token stoken) {
+            while (!stoken.stop_requested()) {
+                std::this_thread::sleep_for(kShmFftPeriod);
+                if (shmFftPending.exchange(true))
+                    continue;
+
+                bool scheduled =
+                    workerThread->schedule("PublishShmFft", [this]() {
+                        shmFftPending = false;
+                        rx->publish_shm_fft();
+                    });
+                if (!scheduled)
+                    shmFftPending = false;
+            }
+        });
+
+        CALLBACK_ON_SUCCESS();
+    });
+}
+
+void AsyncReceiver::stopShmOutput(Callback<> callback)
+{
+    RETURN_IF_WORKER_BUSY();
+
+    schedule([this, callback = std::move(callback)]() mutable {
+        if (shmPrefix.empty()) {
+            CALLBACK_ON_ERROR(SHM_OUTPUT_ALREADY_INACTIVE);
+            return;
+        }
+
+        // joins the thread
+        shmFftThread = std::jthread{};
+
+        for (auto& vfo : vfos) {
+            if (vfo->inner()->is_shm_output())
+                vfo->inner()->stop_shm_output();
+        }
+        rx->stop_shm_output();
+        shmPrefix.clear();
+
+        CALLBACK_ON_SUCCESS();
+    });
+}
+
+bool AsyncReceiver::startVfoShmOutput(const AsyncVfo::sptr& vfo)
+{
+    return vfo->inner()->start_shm_output(shmPrefix + "-vfo" +
+                                          std::to_string(vfo->getId()));
+}
+
 void AsyncReceiver::addVfoChannel(Callback<AsyncVfoIfaceSptr> callback)
 {
     RETURN_IF_WORKER_BUSY();
@@ -558,6 +833,9 @@ void AsyncReceiver::addVfoChannel(Callback<AsyncVfoIfaceSptr> callback)
         auto asyncVfo = AsyncVfo::make(vfo, workerThread);
         vfos.push_back(asyncVfo);
 
+        if (!shmPrefix.empty())
+            startVfoShmOutput(asyncVfo);
+
         CALLBACK_ON_SUCCESS(asyncVfo);
 
         stateChanged<VfoAdded>(asyncVfo->getId());
@@ -573,6 +851,9 @@ void AsyncReceiver::removeVfoChannelImpl(AsyncVfo::sptr vfo,
         return;
     }
 
+    // Disconnect the sinks while the channel is still in the flow graph
+    if (vfo->inner()->is_shm_output())
+        vfo->inner()->stop_shm_output();
     rx->remove_vfo_channel(vfo->inner());
 
     auto vfo_removed_event =
@@ -698,51 +979,37 @@ void AsyncReceiver::synchronize(Callback<> callback)
         [callback = std::move(callback)]() mutable { CALLBACK_ON_SUCCESS(); });
 }
 
-bool AsyncReceiver::isRunning() const { return rx->is_running(); }
+bool AsyncReceiver::isRunning() const { return state.running; }
 
-bool AsyncReceiver::isIqRecording() const { return rx->is_iq_recording(); }
+bool AsyncReceiver::isIqRecording() const { return state.iqRecording; }
 
-std::string AsyncReceiver::getInputDevice() const
-{
-    return rx->get_input_device();
-}
+std::string AsyncReceiver::getInputDevice() const { return state.inputDevice; }
 
-std::string AsyncReceiver::getAntenna() const { return rx->get_antenna(); }
+std::string AsyncReceiver::getAntenna() const { return state.antenna; }
 
-int AsyncReceiver::getInputRate() const { return rx->get_input_rate(); }
+int AsyncReceiver::getInputRate() const { return state.inputRate; }
 
-int AsyncReceiver::getInputDecim() const { return rx->get_input_decim(); }
+int AsyncReceiver::getInputDecim() const { return state.inputDecim; }
 
-bool AsyncReceiver::getDcCancel() const { return rx->get_dc_cancel(); }
+bool AsyncReceiver::getDcCancel() const { return state.dcCancel; }
 
-bool AsyncReceiver::getIqBalance() const { return rx->get_iq_balance(); }
-bool AsyncReceiver::getIqSwap() const { return rx->get_iq_swap(); }
-int64_t AsyncReceiver::getRfFreq() const { return rx->get_rf_freq(); }
+bool AsyncReceiver::getIqBalance() const { return state.iqBalance; }
+bool AsyncReceiver::getIqSwap() const { return state.iqSwap; }
+int64_t AsyncReceiver::getRfFreq() const { return state.rfFreq; }
 
 std::vector<GainStage> AsyncReceiver::getGainStages() const
 {
-    std::vector<GainStage> gainStages;
-    for (const std::string& name : rx->get_gain_names()) {
-        double value = rx->get_gain(name);
-        double start, stop, step;
-        rx->get_gain_range(name, &start, &stop, &step);
-        gainStages.push_back(GainStage{name, start, stop, step, value});
-    }
-
-    return gainStages;
+    return state.gainStages;
 }
 
 std::vector<std::string> AsyncReceiver::getAntennas() const
 {
-    return rx->get_antennas();
-}
-bool AsyncReceiver::getAutoGain() const { return rx->get_auto_gain(); }
-double AsyncReceiver::getFreqCorr() const { return rx->get_freq_corr(); }
-int AsyncReceiver::getIqFftSize() const { return rx->iq_fft_size(); }
-WindowType AsyncReceiver::getIqFftWindow() const
-{
-    return (WindowType)rx->get_iq_fft_window();
+    return state.antennas;
 }
+bool AsyncReceiver::getAutoGain() const { return state.autoGain; }
+double AsyncReceiver::getFreqCorr() const { return state.freqCorr; }
+int AsyncReceiver::getIqFftSize() const { return state.fftSize; }
+WindowType AsyncReceiver::getIqFftWindow() const { return state.fftWindow; }
 std::vector<std::shared_ptr<AsyncVfoIface>> AsyncReceiver::getVfos() const
 {
     std::vector<std::shared_ptr<AsyncVfoIface>> result;
@@ -764,7 +1031,7 @@ AsyncVfoIfaceSptr AsyncReceiver::getVfo(uint64_t handle) const
 
 std::string AsyncReceiver::getIqRecordingPath() const
 {
-    return rx->get_iq_filename();
+    return state.iqRecordingPath;
 }
 
 void AsyncReceiver::getDevices(Callback<std::vector<Device>> callback) const
@@ -796,4 +1063,153 @@ void AsyncReceiver::getDevices(Callback<std::vector<Device>> callback) const
     });
 }
 
+static std::vector<BlockPerfStats>
+toBlockPerfStats(const std::vector<block_perf_counters>& counters)
+{
+    std::vector<BlockPerfStats> result;
+    result.reserve(counters.size());
+
+    for (const auto& c : counters) {
+        result.push_back(BlockPerfStats{
+            .name = c.name,
+            .workTimeAvg = c.work_time_avg,
+            .workTimeTotal = c.work_time_total,
+            .nproducedAvg = c.nproduced_avg,
+            .inputBuffersFull = c.input_buffers_full,
+            .outputBuffersFull = c.output_buffers_full,
+        });
+    }
+
+    return result;
+}
+
+// Only on the worker thread, the block lists change with the flow graph
+PerfStats AsyncReceiver::readPerfStats() const
+{
+    PerfStats result;
+
+    std::vector<block_perf_counters> counters;
+    rx->get_perf_counters(counters);
+    result.blocks = toBlockPerfStats(counters);
+
+    for (const auto& vfo : vfos) {
+        counters.clear();
+        read_perf_counters(vfo->inner(), counters);
+
+        VfoPerfStats stats{
+            .handle = vfo->getId(),
+            .workTimeTotal = 0.0,
+            .blocks = toBlockPerfStats(counters),
+        };
+        for (const auto& block : stats.blocks) {
+            stats.workTimeTotal += block.workTimeTotal;
+        }
+
+        result.vfos.push_back(std::move(stats));
+    }
+
+    return result;
+}
+
+void AsyncReceiver::getPerfStats(Callback<PerfStats> callback) const
+{
+    RETURN_IF_WORKER_BUSY();
+
+    schedule([this, callback = std::move(callback)]() mutable {
+        CALLBACK_ON_SUCCESS(readPerfStats());
+    });
+}
+
+void AsyncReceiver::refreshMetrics()
+{
+    MetricsSnapshot snapshot{
+        .running = state.running,
+        .iqRecording = rx->get_iq_recording_stats(),
+        .vfos = {},
+        .perf = readPerfStats(),
+        .tapsCache = taps_cache::instance().get_stats(),
+    };
+
+    snapshot.vfos.reserve(vfos.size());
+    for (const auto& vfo : vfos) {
+        snapshot.vfos.emplace_back(vfo->getId(), vfo->getSignalStats());
+    }
+
+    std::scoped_lock lock{metricsMutex};
+    metrics = std::move(snapshot);
+}
+
+void AsyncReceiver::enableMetrics()
+{
+    workerThread->setPeriodicTask(kMetricsRefreshPeriod,
+                                  [this]() { refreshMetrics(); });
+}
+
+AsyncReceiver::Metrics AsyncReceiver::getMetrics() const
+{
+    std::scoped_lock lock{metricsMutex};
+
+    Metrics result{
+        .running = metrics.running,
+        .iqRecording = metrics.iqRecording,
+        .vfos = {},
+        .perf = metrics.perf,
+        .tapsCache = metrics.tapsCache,
+    };
+
+    result.vfos.reserve(metrics.vfos.size());
+    for (const auto& [handle, stats] : metrics.vfos) {
+        result.vfos.push_back(Metrics::Vfo{
+            .handle = handle,
+            .signalLevel = stats->level_db.load(std::memory_order_relaxed),
+            .sqlOpen = stats->sql_open.load(std::memory_order_relaxed),
+        });
+    }
+
+    return result;
+}
+
+static double toSeconds(std::chrono::microseconds duration)
+{
+    return std::chrono::duration<double>(duration).count();
+}
+
+static LatencyHistogram
+toLatencyHistogram(const WorkerThread::Histogram& histogram)
+{
+    return LatencyHistogram{
+        .buckets = {histogram.buckets.begin(), histogram.buckets.end()},
+        .count = histogram.count,
+        .sum = toSeconds(histogram.sum),
+        .max = toSeconds(histogram.max),
+    };
+}
+
+// Not scheduled on the worker thread, the point is to see what it is doing
+// even when it's stuck.
+void AsyncReceiver::getWorkerStats(Callback<WorkerStats> callback) const
+{
+    WorkerThread::Stats stats = workerThread->getStats();
+
+    WorkerStats result{
+        .queueDepth = stats.queueDepth,
+        .stalled = stats.stalled,
+        .currentCommand = std::move(stats.currentCmd),
+        .currentCommandDuration = toSeconds(stats.currentTaskDuration),
+        .avgLatency = toSeconds(stats.avgLatency),
+        .commands = {},
+    };
+
+    result.commands.reserve(stats.commands.size());
+    for (const auto& command : stats.commands) {
+        result.commands.push_back(CommandStats{
+            .command = command.cmd,
+            .queueWait = toLatencyHistogram(command.queueWait),
+            .execution = toLatencyHistogram(command.execution),
+        });
+    }
+
+    CALLBACK_ON_SUCCESS(std::move(result));
+}
+
 } // namespace violetrx
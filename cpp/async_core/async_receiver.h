@@ -1,13 +1,18 @@
 #ifndef ASYNC_RECEIVER_H
 #define ASYNC_RECEIVER_H
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 
 #include <source_location>
 
 #include "async_core/async_receiver_iface.h"
 #include "async_core/events.h"
 #include "core/receiver.h"
+#include "dsp/taps_cache.h"
 
 namespace violetrx
 {
@@ -23,6 +28,8 @@ public:
     ~AsyncReceiver() override;
 
     void getDevices(Callback<std::vector<Device>>) const override;
+    void getPerfStats(Callback<PerfStats>) const override;
+    void getWorkerStats(Callback<WorkerStats>) const override;
     void subscribe(ReceiverEventHandler, Callback<Connection>) override;
     void unsubscribe(const Connection&) override;
 
@@ -48,8 +55,16 @@ public:
                  Callback<Timestamp, int64_t, int, float*, int> = {}) override;
 
     /* I/Q Recording */
-    void startIqRecording(std::string, Callback<> = {}) override;
+    void startIqRecording(std::string, IqFormat,
+                          Callback<> = {}) override;
     void stopIqRecording(Callback<> = {}) override;
+    void setIqHistory(double, Callback<> = {}) override;
+    void saveIqSnapshot(std::string, double, double,
+                        Callback<> = {}) override;
+
+    /* Shared memory output */
+    void startShmOutput(std::string, Callback<> = {}) override;
+    void stopShmOutput(Callback<> = {}) override;
 
     /* VFO channels */
     void addVfoChannel(Callback<AsyncVfoIfaceSptr> = {}) override;
@@ -82,6 +97,28 @@ public:
 
     bool isRemote() const override { return false; }
 
+    // Read for the metrics endpoint of headless_server, from any thread.
+    // Signal levels and squelch states are read from the probes of the flow
+    // graph, the rest from a snapshot that the worker thread refreshes
+    // between its tasks once enableMetrics() was called. Nothing goes through
+    // the worker queue.
+    struct Metrics {
+        struct Vfo {
+            uint64_t handle;
+            float signalLevel; // dB
+            bool sqlOpen;
+        };
+
+        bool running;
+        iq_file_sink::stats iqRecording;
+        std::vector<Vfo> vfos;
+        PerfStats perf;
+        taps_cache::stats tapsCache;
+    };
+
+    void enableMetrics();
+    Metrics getMetrics() const;
+
 private:
     template <typename Function>
     auto schedule(Function&& func,
@@ -97,15 +134,67 @@ private:
     template <typename Event, typename... Args>
     void stateChanged(Args... args);
 
+    template <typename Event, typename... Args>
+    void updateState(const Args&...);
+
+    void updateAllState();
+    std::vector<GainStage> readGainStages() const;
+
+    PerfStats readPerfStats() const;
+    void refreshMetrics();
+
     void removeVfoChannelImpl(std::shared_ptr<AsyncVfo>, Callback<>);
+    bool startVfoShmOutput(const std::shared_ptr<AsyncVfo>&);
 
     template <typename Lambda>
     void forEachStateEvent(Lambda&&) const;
 
+private:
+    // The receiver state as last read from the receiver. It is updated right
+    // before every state change is emitted, and the getters and the sync of
+    // new subscribers read it instead of going to the device driver.
+    struct State {
+        bool running = false;
+        std::string inputDevice;
+        std::string antenna;
+        std::vector<std::string> antennas;
+        int inputRate = 0;
+        int inputDecim = 0;
+        bool dcCancel = false;
+        bool iqBalance = false;
+        bool iqSwap = false;
+        int64_t rfFreq = 0;
+        std::vector<GainStage> gainStages;
+        bool autoGain = false;
+        double freqCorr = 0;
+        int fftSize = 0;
+        WindowType fftWindow = WindowType::HAMMING;
+        bool iqRecording = false;
+        std::string iqRecordingPath;
+    };
+
 private:
     receiver::sptr rx;
+    State state;
     std::vector<std::shared_ptr<AsyncVfo>> vfos;
     std::shared_ptr<WorkerThread> workerThread;
+
+    std::string shmPrefix;     // empty if there's no shared memory output
+    std::jthread shmFftThread; // publishes FFT frames to shared memory
+    std::atomic<bool> shmFftPending{false}; // a publish is in the queue
+
+    // Written by refreshMetrics() on the worker thread, read by getMetrics()
+    struct MetricsSnapshot {
+        bool running = false;
+        iq_file_sink::stats iqRecording{};
+        std::vector<std::pair<uint64_t, std::shared_ptr<const rx_meter_stats>>>
+            vfos;
+        PerfStats perf;
+        taps_cache::stats tapsCache{};
+    };
+
+    mutable std::mutex metricsMutex;
+    MetricsSnapshot metrics;
 };
 
 } // namespace violetrx
@@ -8,7 +8,6 @@
 #include "async_core/events.h"
 #include "async_core/types.h"
 
-#include <boost/signals2.hpp>
 #include <function2/function2.hpp>
 
 namespace violetrx
@@ -24,6 +23,8 @@ public:
     virtual ~AsyncReceiverIface() {}
 
     virtual void getDevices(Callback<std::vector<Device>>) const = 0;
+    virtual void getPerfStats(Callback<PerfStats>) const = 0;
+    virtual void getWorkerStats(Callback<WorkerStats>) const = 0;
     virtual void subscribe(ReceiverEventHandler, Callback<Connection>) = 0;
     virtual void unsubscribe(const Connection&) = 0;
 
@@ -49,9 +50,19 @@ public:
                  Callback<Timestamp, int64_t, int, float*, int> = {}) = 0;
 
     /* I/Q Recording */
-    virtual void startIqRecording(std::string, Callback<> = {}) = 0;
+    virtual void startIqRecording(std::string, IqFormat,
+                                  Callback<> = {}) = 0;
     virtual void stopIqRecording(Callback<> = {}) = 0;
 
+    /* I/Q history */
+    virtual void setIqHistory(double, Callback<> = {}) = 0;
+    virtual void saveIqSnapshot(std::string, double, double,
+                                Callback<> = {}) = 0;
+
+    /* Shared memory output */
+    virtual void startShmOutput(std::string, Callback<> = {}) = 0;
+    virtual void stopShmOutput(Callback<> = {}) = 0;
+
     /* VFO channels */
     virtual void addVfoChannel(Callback<AsyncVfoIfaceSptr> = {}) = 0;
     virtual void removeVfoChannel(AsyncVfoIfaceSptr, Callback<> = {}) = 0;
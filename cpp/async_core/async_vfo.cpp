@@ -10,11 +10,17 @@
 // error codes.
 #include "core/receiver.h" // IWYU: pragma keep
 
+#include <cstring>
 #include <memory>
 
 namespace violetrx
 {
 
+// Packets of the I/Q stream kept for slow readers, about a megabyte
+constexpr int kIqQueueSize = 64;
+
+static_assert(IqPacket::MAX_SIZE >= iq_stream_sink::MAX_PACKET_SIZE);
+
 #define INVOKE(callback, ...)                                                  \
     do {                                                                       \
         if (callback) {                                                        \
@@ -183,6 +189,12 @@ AsyncVfo::createEvent<RecordingStopped>(VfoEventCommon ec) const
     return RecordingStopped{ec};
 }
 template <>
+AudioSegmentRecorded AsyncVfo::createEvent<AudioSegmentRecorded>(
+    VfoEventCommon ec, std::string path, Timestamp start, double duration) const
+{
+    return AudioSegmentRecorded{ec, std::move(path), start, duration};
+}
+template <>
 SnifferStarted AsyncVfo::createEvent<SnifferStarted>(VfoEventCommon ec) const
 {
     auto params = getSnifferParams();
@@ -198,7 +210,8 @@ UdpStreamingStarted
 AsyncVfo::createEvent<UdpStreamingStarted>(VfoEventCommon ec) const
 {
     auto params = getUdpStreamParams();
-    return UdpStreamingStarted{ec, params.host, params.port, params.stereo};
+    return UdpStreamingStarted{ec, params.host, params.port, params.stereo,
+                               params.rtp};
 }
 template <>
 UdpStreamingStopped
@@ -207,6 +220,22 @@ AsyncVfo::createEvent<UdpStreamingStopped>(VfoEventCommon ec) const
     return UdpStreamingStopped{ec};
 }
 template <>
+IqStreamStarted AsyncVfo::createEvent<IqStreamStarted>(VfoEventCommon ec) const
+{
+    auto params = getIqStreamParams();
+    return IqStreamStarted{ec,
+                           vfo->get_iq_stream_rate(),
+                           params.format,
+                           params.transport,
+                           params.host,
+                           params.port};
+}
+template <>
+IqStreamStopped AsyncVfo::createEvent<IqStreamStopped>(VfoEventCommon ec) const
+{
+    return IqStreamStopped{ec};
+}
+template <>
 RdsDecoderStarted
 AsyncVfo::createEvent<RdsDecoderStarted>(VfoEventCommon ec) const
 {
@@ -246,6 +275,7 @@ auto AsyncVfo::schedule(Function&& func, const std::source_location loc)
 AsyncVfo::AsyncVfo(vfo_channel::sptr vfo_, WorkerThread::sptr workerThread_) :
     vfo(vfo_),
     workerThread(workerThread_),
+    iqQueue(std::make_shared<broadcast_queue::sender<IqPacket>>(kIqQueueSize)),
     m_demod(Demod::OFF),
     m_fmMaxDev(5000),
     m_fmDeemph(75.0e-6),
@@ -914,9 +944,6 @@ void AsyncVfo::startAudioRecording(const std::string& filename,
         } else if (sptr->m_demod == Demod::OFF) {
             CALLBACK_ON_ERROR(DEMOD_IS_OFF);
             return;
-        } else if (!sptr->vfo->get_parent_receiver()->is_running()) {
-            CALLBACK_ON_ERROR(NOT_RUNNING);
-            return;
         }
 
         bool result = sptr->vfo->start_audio_recording(filename);
@@ -954,6 +981,79 @@ void AsyncVfo::stopAudioRecording(Callback<> callback)
         sptr->stateChanged<RecordingStopped>();
     });
 }
+void AsyncVfo::startSqlRecording(const std::string& prefix, double hangTime,
+                                 Callback<> callback)
+{
+    RETURN_IF_WORKER_BUSY();
+
+    std::weak_ptr<AsyncVfo> self =
+        static_pointer_cast<AsyncVfo>(shared_from_this());
+
+    schedule([self, prefix, hangTime,
+              callback = std::move(callback)]() mutable {
+        auto sptr = self.lock();
+        if (!sptr || sptr->m_removed) {
+            CALLBACK_ON_ERROR(VFO_NOT_FOUND);
+            return;
+        }
+
+        if (sptr->vfo->is_sql_recording()) {
+            CALLBACK_ON_ERROR(ALREADY_RECORDING);
+            return;
+        } else if (sptr->m_demod == Demod::OFF) {
+            CALLBACK_ON_ERROR(DEMOD_IS_OFF);
+            return;
+        }
+
+        // segments are reported from the recorder's writer thread, which must
+        // not end up owning the vfo, as destroying it joins that thread
+        auto onSegment = [self, worker = sptr->workerThread](
+                             const squelch_recorder::segment& segment) {
+            auto task = [self, segment]() {
+                auto sptr = self.lock();
+                if (!sptr || sptr->m_removed)
+                    return;
+
+                sptr->stateChanged<AudioSegmentRecorded>(
+                    segment.filename, Timestamp::FromTimepoint(segment.start),
+                    segment.duration);
+            };
+            worker->scheduleForced("AsyncVfo::AudioSegmentRecorded", task);
+        };
+
+        bool result =
+            sptr->vfo->start_sql_recording(prefix, hangTime, onSegment);
+        if (result) {
+            CALLBACK_ON_SUCCESS();
+        } else {
+            CALLBACK_ON_ERROR(COULDNT_CREATE_FILE);
+        }
+    });
+}
+void AsyncVfo::stopSqlRecording(Callback<> callback)
+{
+    RETURN_IF_WORKER_BUSY();
+
+    std::weak_ptr<AsyncVfo> self =
+        static_pointer_cast<AsyncVfo>(shared_from_this());
+
+    schedule([self, callback = std::move(callback)]() mutable {
+        auto sptr = self.lock();
+        if (!sptr || sptr->m_removed) {
+            CALLBACK_ON_ERROR(VFO_NOT_FOUND);
+            return;
+        }
+
+        if (!sptr->vfo->is_sql_recording()) {
+            CALLBACK_ON_ERROR(ALREADY_NOT_RECORDING);
+            return;
+        }
+
+        sptr->vfo->stop_sql_recording();
+
+        CALLBACK_ON_SUCCESS();
+    });
+}
 void AsyncVfo::setAudioGain(float gain, Callback<> callback)
 {
     RETURN_IF_WORKER_BUSY();
@@ -976,27 +1076,30 @@ void AsyncVfo::setAudioGain(float gain, Callback<> callback)
 }
 
 void AsyncVfo::startUdpStreaming(const std::string& host, int port, bool stereo,
-                                 Callback<> callback)
+                                 bool rtp, Callback<> callback)
 {
     RETURN_IF_WORKER_BUSY();
 
     std::weak_ptr<AsyncVfo> self =
         static_pointer_cast<AsyncVfo>(shared_from_this());
 
-    schedule(
-        [self, host, port, stereo, callback = std::move(callback)]() mutable {
-            auto sptr = self.lock();
-            if (!sptr || sptr->m_removed) {
-                CALLBACK_ON_ERROR(VFO_NOT_FOUND);
-                return;
-            }
+    schedule([self, host, port, stereo, rtp,
+              callback = std::move(callback)]() mutable {
+        auto sptr = self.lock();
+        if (!sptr || sptr->m_removed) {
+            CALLBACK_ON_ERROR(VFO_NOT_FOUND);
+            return;
+        }
 
-            // FIXME: we should validate host/port
-            sptr->vfo->start_udp_streaming(host, port, stereo);
-            CALLBACK_ON_SUCCESS();
+        // FIXME: we should validate the port
+        if (!sptr->vfo->start_udp_streaming(host, port, stereo, rtp)) {
+            CALLBACK_ON_ERROR(INVALID_HOST);
+            return;
+        }
+        CALLBACK_ON_SUCCESS();
 
-            sptr->stateChanged<UdpStreamingStarted>();
-        });
+        sptr->stateChanged<UdpStreamingStarted>();
+    });
 }
 
 void AsyncVfo::stopUdpStreaming(Callback<> callback)
@@ -1021,7 +1124,115 @@ void AsyncVfo::stopUdpStreaming(Callback<> callback)
     });
 }
 
+void AsyncVfo::startIqStream(const IqStreamParams& params, Callback<> callback)
+{
+    RETURN_IF_WORKER_BUSY();
+
+    std::weak_ptr<AsyncVfo> self =
+        static_pointer_cast<AsyncVfo>(shared_from_this());
+
+    schedule([self, params, callback = std::move(callback)]() mutable {
+        auto sptr = self.lock();
+        if (!sptr || sptr->m_removed) {
+            CALLBACK_ON_ERROR(VFO_NOT_FOUND);
+            return;
+        }
+
+        if (sptr->vfo->is_iq_streaming()) {
+            CALLBACK_ON_ERROR(IQ_STREAM_ALREADY_ACTIVE);
+            return;
+        }
+
+        vfo_channel::iq_stream_params vfoParams{
+            .rate = params.sampleRate,
+            .format = (iq_file_sink::format)params.format,
+            .transport = (iq_net_sink::transport)params.transport,
+            .host = params.host,
+            .port = params.port,
+        };
+
+        // runs in the scheduler thread, so it holds on to the queue rather
+        // than to the vfo
+        auto onPacket = [queue = sptr->iqQueue,
+                         format = params.format](const void* data, size_t size,
+                                                 uint64_t offset, int rate) {
+            IqPacket packet;
+            packet.offset = offset;
+            packet.sampleRate = rate;
+            packet.format = format;
+            packet.size = size;
+            std::memcpy(packet.data, data, size);
+
+            queue->push(packet);
+        };
+
+        if (!sptr->vfo->start_iq_stream(vfoParams, std::move(onPacket))) {
+            CALLBACK_ON_ERROR(INVALID_HOST);
+            return;
+        }
+        CALLBACK_ON_SUCCESS();
+
+        sptr->stateChanged<IqStreamStarted>();
+    });
+}
+
+void AsyncVfo::stopIqStream(Callback<> callback)
+{
+    RETURN_IF_WORKER_BUSY();
+
+    std::weak_ptr<AsyncVfo> self =
+        static_pointer_cast<AsyncVfo>(shared_from_this());
+
+    schedule([self, callback = std::move(callback)]() mutable {
+        auto sptr = self.lock();
+        if (!sptr || sptr->m_removed) {
+            CALLBACK_ON_ERROR(VFO_NOT_FOUND);
+            return;
+        }
+
+        if (!sptr->vfo->is_iq_streaming()) {
+            CALLBACK_ON_ERROR(IQ_STREAM_ALREADY_INACTIVE);
+            return;
+        }
+
+        sptr->vfo->stop_iq_stream();
+        CALLBACK_ON_SUCCESS();
+
+        sptr->stateChanged<IqStreamStopped>();
+    });
+}
+
+void AsyncVfo::subscribeIq(Callback<IqReceiver> callback)
+{
+    std::weak_ptr<AsyncVfo> self =
+        static_pointer_cast<AsyncVfo>(shared_from_this());
+
+    schedule([self, callback = std::move(callback)]() mutable {
+        auto sptr = self.lock();
+        if (!sptr || sptr->m_removed) {
+            CALLBACK_ON_ERROR(VFO_NOT_FOUND);
+            return;
+        }
+
+        // readers only see packets pushed after they subscribe, and keep
+        // working across restarts of the stream
+        CALLBACK_ON_SUCCESS(sptr->iqQueue->subscribe());
+    });
+}
+
 void AsyncVfo::startSniffer(int samplerate, int buffsize, Callback<> callback)
+{
+    startSnifferImpl(samplerate, buffsize, false, std::move(callback));
+}
+
+void AsyncVfo::startBlockingSniffer(int samplerate, int buffsize,
+                                    Callback<> callback)
+{
+    startSnifferImpl(samplerate, buffsize, true, std::move(callback));
+}
+
+void AsyncVfo::startSnifferImpl(int samplerate, int buffsize, bool blocking,
+                                Callback<> callback)
 {
     RETURN_IF_WORKER_BUSY();
 
@@ -1029,7 +1240,8 @@ void AsyncVfo::startSniffer(int samplerate, int buffsize, Callback<> callback)
         static_pointer_cast<AsyncVfo>(shared_from_this());
 
     schedule(
-        [self, samplerate, buffsize, callback = std::move(callback)]() mutable {
+        [self, samplerate, buffsize, blocking,
+         callback = std::move(callback)]() mutable {
             auto sptr = self.lock();
             if (!sptr || sptr->m_removed) {
                 CALLBACK_ON_ERROR(VFO_NOT_FOUND);
@@ -1041,7 +1253,7 @@ void AsyncVfo::startSniffer(int samplerate, int buffsize, Callback<> callback)
                 return;
             }
 
-            sptr->vfo->start_sniffer(samplerate, buffsize);
+            sptr->vfo->start_sniffer(samplerate, buffsize, blocking);
 
             CALLBACK_ON_SUCCESS();
 
@@ -1108,6 +1320,17 @@ void AsyncVfo::getSnifferData(float* data, int size,
     });
 }
 
+int AsyncVfo::readSnifferData(float* data, int size)
+{
+    if (vfo->get_sniffer_buffsize() > size)
+        return -1;
+
+    int num;
+    vfo->get_sniffer_data(data, num);
+
+    return num;
+}
+
 void AsyncVfo::getRdsData(Callback<std::string, int> callback)
 {
     RETURN_IF_WORKER_BUSY();
@@ -1233,6 +1456,7 @@ std::string AsyncVfo::getRecordingFilename() const
     return vfo->get_recording_filename();
 }
 bool AsyncVfo::isUdpStreaming() const { return vfo->is_udp_streaming(); }
+bool AsyncVfo::isIqStreaming() const { return vfo->is_iq_streaming(); }
 bool AsyncVfo::isSniffing() const { return vfo->is_snifffer_active(); }
 bool AsyncVfo::isRdsDecoderActive() const
 {
@@ -1261,8 +1485,20 @@ UdpStreamParams AsyncVfo::getUdpStreamParams() const
 {
     // YUCK
     auto params = vfo->get_udp_stream_params();
-    return UdpStreamParams{
-        .host = params.host, .port = params.port, .stereo = params.stereo};
+    return UdpStreamParams{.host = params.host,
+                           .port = params.port,
+                           .stereo = params.stereo,
+                           .rtp = params.rtp};
+}
+
+IqStreamParams AsyncVfo::getIqStreamParams() const
+{
+    auto params = vfo->get_iq_stream_params();
+    return IqStreamParams{.sampleRate = params.rate,
+                          .format = (IqFormat)params.format,
+                          .transport = (IqTransport)params.transport,
+                          .host = params.host,
+                          .port = params.port};
 }
 
 uint64_t AsyncVfo::getId() const { return (uint64_t)vfo.get(); }
@@ -1323,6 +1559,9 @@ void AsyncVfo::forEachStateEvent(Lambda&& lambda) const
     if (isUdpStreaming()) {
         lambda(createEvent<UdpStreamingStarted>(ec));
     }
+    if (isIqStreaming()) {
+        lambda(createEvent<IqStreamStarted>(ec));
+    }
     if (isRdsDecoderActive()) {
         lambda(createEvent<RdsDecoderStarted>(ec));
     }
@@ -61,17 +61,32 @@ public:
     /* Audio Recording */
     void startAudioRecording(const std::string&, Callback<> = {}) override;
     void stopAudioRecording(Callback<> = {}) override;
+    void startSqlRecording(const std::string&, double,
+                           Callback<> = {}) override;
+    void stopSqlRecording(Callback<> = {}) override;
     void setAudioGain(float, Callback<> = {}) override;
 
     /* UDP streaming */
-    void startUdpStreaming(const std::string&, int, bool,
+    void startUdpStreaming(const std::string&, int, bool, bool,
                            Callback<> = {}) override;
     void stopUdpStreaming(Callback<> = {}) override;
 
+    /* I/Q streaming */
+    void startIqStream(const IqStreamParams&, Callback<> = {}) override;
+    void stopIqStream(Callback<> = {}) override;
+    void subscribeIq(Callback<IqReceiver>) override;
+
     /* sample sniffer */
     void startSniffer(int, int, Callback<> = {}) override;
     void stopSniffer(Callback<> = {}) override;
     void getSnifferData(float*, int, Callback<float*, int> = {}) override;
+    // For batch mode: the channel waits for readSnifferData() to make room
+    // instead of dropping samples
+    void startBlockingSniffer(int, int, Callback<> = {});
+    // Reads the sniffer from the calling thread, not through the worker, which
+    // waits for the flow graph at the end of the input. Returns the number of
+    // samples, or -1 if the buffer is smaller than the sniffer's.
+    int readSnifferData(float*, int);
 
     /* rds functions */
     void getRdsData(Callback<std::string, int> = {}) override;
@@ -81,6 +96,12 @@ public:
 
     vfo_channel::sptr inner() { return vfo; }
 
+    // Accumulated by the flow graph, can be read from any thread
+    std::shared_ptr<const rx_meter_stats> getSignalStats() const
+    {
+        return vfo->get_signal_stats();
+    }
+
     /* Sync API: getters can only be called inside a successful callback
      * function */
     void synchronize(Callback<>) override;
@@ -96,6 +117,7 @@ public:
     bool isAudioRecording() const override;
     std::string getRecordingFilename() const override;
     bool isUdpStreaming() const override;
+    bool isIqStreaming() const override;
     bool isSniffing() const override;
     bool isRdsDecoderActive() const override;
     bool isAgcOn() const override;
@@ -112,12 +134,14 @@ public:
     float getNoiseBlanker2Threshold() const override;
     float getAfGain() const override;
     UdpStreamParams getUdpStreamParams() const override;
+    IqStreamParams getIqStreamParams() const override;
     SnifferParams getSnifferParams() const override;
     std::vector<VfoEvent> getStateAsEvents() const override;
 
     uint64_t getId() const override;
 
 private:
+    void startSnifferImpl(int, int, bool, Callback<>);
     bool isValidFilter(int64_t low, int64_t high);
     void setDefaultFilter();
     void prepareToDie(VfoRemoved);
@@ -140,6 +164,9 @@ private:
     vfo_channel::sptr vfo;
     std::shared_ptr<WorkerThread> workerThread;
 
+    // I/Q packets, pushed from the scheduler thread
+    std::shared_ptr<broadcast_queue::sender<IqPacket>> iqQueue;
+
     Demod m_demod;
 
     // FM parameters
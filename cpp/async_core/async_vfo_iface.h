@@ -58,13 +58,21 @@ public:
     /* Audio Recording */
     virtual void startAudioRecording(const std::string&, Callback<> = {}) = 0;
     virtual void stopAudioRecording(Callback<> = {}) = 0;
+    virtual void startSqlRecording(const std::string&, double,
+                                   Callback<> = {}) = 0;
+    virtual void stopSqlRecording(Callback<> = {}) = 0;
     virtual void setAudioGain(float, Callback<> = {}) = 0;
 
     /* UDP streaming */
-    virtual void startUdpStreaming(const std::string&, int, bool,
+    virtual void startUdpStreaming(const std::string&, int, bool, bool,
                                    Callback<> = {}) = 0;
     virtual void stopUdpStreaming(Callback<> = {}) = 0;
 
+    /* I/Q streaming */
+    virtual void startIqStream(const IqStreamParams&, Callback<> = {}) = 0;
+    virtual void stopIqStream(Callback<> = {}) = 0;
+    virtual void subscribeIq(Callback<IqReceiver>) = 0;
+
     /* sample sniffer */
     virtual void startSniffer(int, int, Callback<> = {}) = 0;
     virtual void stopSniffer(Callback<> = {}) = 0;
@@ -91,6 +99,7 @@ public:
     virtual bool isAudioRecording() const = 0;
     virtual std::string getRecordingFilename() const = 0;
     virtual bool isUdpStreaming() const = 0;
+    virtual bool isIqStreaming() const = 0;
     virtual bool isSniffing() const = 0;
     virtual bool isRdsDecoderActive() const = 0;
     virtual bool isAgcOn() const = 0;
@@ -107,6 +116,7 @@ public:
     virtual float getNoiseBlanker2Threshold() const = 0;
     virtual float getAfGain() const = 0;
     virtual UdpStreamParams getUdpStreamParams() const = 0;
+    virtual IqStreamParams getIqStreamParams() const = 0;
     virtual SnifferParams getSnifferParams() const = 0;
     virtual std::vector<VfoEvent> getStateAsEvents() const = 0;
 
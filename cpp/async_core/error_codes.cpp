@@ -48,6 +48,18 @@ const char* errorMsg(ErrorCode code)
         return "Function call error";
     case UNIMPLEMENTED:
         return "Unimplemented";
+    case IQ_HISTORY_DISABLED:
+        return "I/Q history disabled";
+    case INVALID_HOST:
+        return "Invalid host";
+    case IQ_STREAM_ALREADY_ACTIVE:
+        return "I/Q stream already active";
+    case IQ_STREAM_ALREADY_INACTIVE:
+        return "I/Q stream already inactive";
+    case SHM_OUTPUT_ALREADY_ACTIVE:
+        return "Shared memory output already active";
+    case SHM_OUTPUT_ALREADY_INACTIVE:
+        return "Shared memory output already inactive";
     case UNKNOWN_ERROR:
     default:
         return "Unknown error";
@@ -28,6 +28,12 @@ enum ErrorCode : int {
     INVALID_NOISE_BLANKER_ID = 19,
     CALL_ERROR = 20,
     UNIMPLEMENTED = 21,
+    IQ_HISTORY_DISABLED = 22,
+    INVALID_HOST = 23,
+    IQ_STREAM_ALREADY_ACTIVE = 24,
+    IQ_STREAM_ALREADY_INACTIVE = 25,
+    SHM_OUTPUT_ALREADY_ACTIVE = 26,
+    SHM_OUTPUT_ALREADY_INACTIVE = 27,
     UNKNOWN_ERROR = 99999,
 };
 
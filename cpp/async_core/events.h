@@ -1,6 +1,8 @@
 #ifndef CORE_EVENTS
 #define CORE_EVENTS
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <string>
 #include <variant>
@@ -14,14 +16,22 @@ namespace violetrx
 {
 
 struct EventCommon {
-    static int64_t last_id;
+    // Events are made on the worker thread, the server and the DSP threads.
+    // Ids start from the startup time in microseconds, so that they keep
+    // increasing across restarts, and a client resuming its subscription
+    // can't mistake the events of a new server for ones it has seen.
+    static inline std::atomic<int64_t> last_id{
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count()};
 
     int64_t id;
     Timestamp timestamp;
 
     static EventCommon make()
     {
-        return EventCommon{last_id++, Timestamp::Now()};
+        return EventCommon{last_id.fetch_add(1, std::memory_order_relaxed),
+                           Timestamp::Now()};
     }
 };
 
@@ -95,6 +105,8 @@ struct IqRecordingStarted : public EventCommon {
 };
 struct IqRecordingStopped : public EventCommon {
 };
+struct InputEof : public EventCommon {
+};
 struct VfoSyncStart : public VfoEventCommon {
 };
 struct VfoSyncEnd : public VfoEventCommon {
@@ -175,6 +187,11 @@ struct RecordingStarted : public VfoEventCommon {
 };
 struct RecordingStopped : public VfoEventCommon {
 };
+struct AudioSegmentRecorded : public VfoEventCommon {
+    std::string path;
+    Timestamp start;
+    double duration;
+};
 struct SnifferStarted : public VfoEventCommon {
     int sample_rate;
     int size;
@@ -191,9 +208,19 @@ struct UdpStreamingStarted : public VfoEventCommon {
     std::string host;
     int port;
     bool stereo;
+    bool rtp;
 };
 struct UdpStreamingStopped : public VfoEventCommon {
 };
+struct IqStreamStarted : public VfoEventCommon {
+    int sample_rate;
+    IqFormat format;
+    IqTransport transport;
+    std::string host;
+    int port;
+};
+struct IqStreamStopped : public VfoEventCommon {
+};
 
 // FIXME: audio should be client side, and hence this should be removed
 struct AudioGainChanged : public VfoEventCommon {
@@ -207,7 +234,7 @@ using ReceiverEvent =
                  IqBalanceChanged, RfFreqChanged, GainStagesChanged,
                  AntennasChanged, AutoGainChanged, GainChanged, FreqCorrChanged,
                  FftSizeChanged, FftWindowChanged, IqRecordingStarted,
-                 IqRecordingStopped, VfoAdded, VfoRemoved>;
+                 IqRecordingStopped, InputEof, VfoAdded, VfoRemoved>;
 
 using VfoEvent = std::variant<
     VfoSyncStart, VfoSyncEnd, DemodChanged, OffsetChanged, CwOffsetChanged,
@@ -215,8 +242,9 @@ using VfoEvent = std::variant<
     SqlLevelChanged, SqlAlphaChanged, AgcOnChanged, AgcHangChanged,
     AgcThresholdChanged, AgcSlopeChanged, AgcDecayChanged, AgcManualGainChanged,
     FmMaxDevChanged, FmDeemphChanged, AmDcrChanged, AmSyncDcrChanged,
-    AmSyncPllBwChanged, RecordingStarted, RecordingStopped, SnifferStarted,
-    SnifferStopped, UdpStreamingStarted, UdpStreamingStopped, RdsDecoderStarted,
+    AmSyncPllBwChanged, RecordingStarted, RecordingStopped,
+    AudioSegmentRecorded, SnifferStarted, SnifferStopped, UdpStreamingStarted,
+    UdpStreamingStopped, IqStreamStarted, IqStreamStopped, RdsDecoderStarted,
     RdsDecoderStopped, RdsParserReset, AudioGainChanged, VfoRemoved>;
 
 using Event = std::variant<
@@ -225,15 +253,15 @@ using Event = std::variant<
     DcCancelChanged, IqBalanceChanged, RfFreqChanged, GainStagesChanged,
     AntennasChanged, AutoGainChanged, GainChanged, FreqCorrChanged,
     FftSizeChanged, FftWindowChanged, IqRecordingStarted, IqRecordingStopped,
-    VfoAdded, VfoRemoved, AudioGainChanged, VfoSyncStart, VfoSyncEnd,
+    InputEof, VfoAdded, VfoRemoved, AudioGainChanged, VfoSyncStart, VfoSyncEnd,
     DemodChanged, OffsetChanged, CwOffsetChanged, FilterChanged,
     NoiseBlankerOnChanged, NoiseBlankerThresholdChanged, SqlLevelChanged,
     SqlAlphaChanged, AgcOnChanged, AgcHangChanged, AgcThresholdChanged,
     AgcSlopeChanged, AgcDecayChanged, AgcManualGainChanged, FmMaxDevChanged,
     FmDeemphChanged, AmDcrChanged, AmSyncDcrChanged, AmSyncPllBwChanged,
-    RecordingStarted, RecordingStopped, SnifferStarted, SnifferStopped,
-    UdpStreamingStarted, UdpStreamingStopped, RdsDecoderStarted,
-    RdsDecoderStopped, RdsParserReset>;
+    RecordingStarted, RecordingStopped, AudioSegmentRecorded, SnifferStarted,
+    SnifferStopped, UdpStreamingStarted, UdpStreamingStopped, IqStreamStarted,
+    IqStreamStopped, RdsDecoderStarted, RdsDecoderStopped, RdsParserReset>;
 
 inline constexpr bool IsReceiverEvent(const Event& event)
 {
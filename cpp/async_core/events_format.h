@@ -743,9 +743,10 @@ struct fmt::formatter<violetrx::UdpStreamingStarted> {
     {
         return fmt::format_to(ctx.out(),
                               "UdpStreamingStarted(id={}, time={}, "
-                              "handle={}, host='{}', port={}, stereo={})",
+                              "handle={}, host='{}', port={}, stereo={}, "
+                              "rtp={})",
                               tx.id, tx.timestamp, tx.handle, tx.host, tx.port,
-                              tx.stereo);
+                              tx.stereo, tx.rtp);
     }
 };
 template <>
@@ -765,6 +766,40 @@ struct fmt::formatter<violetrx::UdpStreamingStopped> {
     }
 };
 template <>
+struct fmt::formatter<violetrx::IqStreamStarted> {
+    template <typename ParseContext>
+    constexpr auto parse(ParseContext& ctx) const
+    {
+        return ctx.begin();
+    }
+    template <typename FormatContext>
+    auto format(const violetrx::IqStreamStarted& tx, FormatContext& ctx) const
+    {
+        return fmt::format_to(ctx.out(),
+                              "IqStreamStarted(id={}, time={}, handle={}, "
+                              "sample_rate={}, format={}, transport={}, "
+                              "host='{}', port={})",
+                              tx.id, tx.timestamp, tx.handle, tx.sample_rate,
+                              static_cast<int>(tx.format),
+                              static_cast<int>(tx.transport), tx.host, tx.port);
+    }
+};
+template <>
+struct fmt::formatter<violetrx::IqStreamStopped> {
+    template <typename ParseContext>
+    constexpr auto parse(ParseContext& ctx) const
+    {
+        return ctx.begin();
+    }
+    template <typename FormatContext>
+    auto format(const violetrx::IqStreamStopped& tx, FormatContext& ctx) const
+    {
+        return fmt::format_to(ctx.out(),
+                              "IqStreamStopped(id={}, time={}, handle={})",
+                              tx.id, tx.timestamp, tx.handle);
+    }
+};
+template <>
 struct fmt::formatter<violetrx::SqlLevelChanged> {
     template <typename ParseContext>
     constexpr auto parse(ParseContext& ctx) const
@@ -840,6 +875,24 @@ struct fmt::formatter<violetrx::RecordingStopped> {
     }
 };
 template <>
+struct fmt::formatter<violetrx::AudioSegmentRecorded> {
+    template <typename ParseContext>
+    constexpr auto parse(ParseContext& ctx) const
+    {
+        return ctx.begin();
+    }
+    template <typename FormatContext>
+    auto format(const violetrx::AudioSegmentRecorded& tx,
+                FormatContext& ctx) const
+    {
+        return fmt::format_to(ctx.out(),
+                              "AudioSegmentRecorded(id={}, time={}, handle={}, "
+                              "path='{}', start={}, duration={})",
+                              tx.id, tx.timestamp, tx.handle, tx.path, tx.start,
+                              tx.duration);
+    }
+};
+template <>
 struct fmt::formatter<violetrx::IqRecordingStarted> {
     template <typename ParseContext>
     constexpr auto parse(ParseContext& ctx) const
@@ -871,6 +924,20 @@ struct fmt::formatter<violetrx::IqRecordingStopped> {
     }
 };
 template <>
+struct fmt::formatter<violetrx::InputEof> {
+    template <typename ParseContext>
+    constexpr auto parse(ParseContext& ctx) const
+    {
+        return ctx.begin();
+    }
+    template <typename FormatContext>
+    auto format(const violetrx::InputEof& tx, FormatContext& ctx) const
+    {
+        return fmt::format_to(ctx.out(), "InputEof(id={}, time={})", tx.id,
+                              tx.timestamp);
+    }
+};
+template <>
 struct fmt::formatter<violetrx::AudioGainChanged> {
     template <typename ParseContext>
     constexpr auto parse(ParseContext& ctx) const
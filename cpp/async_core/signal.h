@@ -0,0 +1,240 @@
+#ifndef ASYNC_CORE_SIGNAL_H
+#define ASYNC_CORE_SIGNAL_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <function2/function2.hpp>
+
+namespace violetrx
+{
+
+namespace detail
+{
+
+class ConnectionBody
+{
+public:
+    virtual ~ConnectionBody() {}
+
+    virtual void disconnect() = 0;
+    bool connected() const { return connected_.load(); }
+
+protected:
+    std::atomic<bool> connected_{true};
+};
+
+} // namespace detail
+
+// Same semantics as boost::signals2::connection: a cheap copyable handle that
+// disconnects its slot, and is harmless once the slot or the signal is gone.
+class Connection
+{
+public:
+    Connection() noexcept {}
+    Connection(std::weak_ptr<detail::ConnectionBody> body) noexcept :
+        body_{std::move(body)}
+    {
+    }
+
+    void disconnect() const
+    {
+        if (auto body = body_.lock()) {
+            body->disconnect();
+        }
+    }
+
+    bool connected() const
+    {
+        auto body = body_.lock();
+        return body && body->connected();
+    }
+
+protected:
+    std::weak_ptr<detail::ConnectionBody> body_;
+};
+
+// Disconnects on destruction, like boost::signals2::scoped_connection.
+class ScopedConnection : public Connection
+{
+public:
+    ScopedConnection() noexcept {}
+    ScopedConnection(const Connection& other) noexcept : Connection{other} {}
+    ScopedConnection(ScopedConnection&& other) noexcept :
+        Connection{std::move(other)}
+    {
+        other.body_.reset();
+    }
+    ScopedConnection(const ScopedConnection&) = delete;
+
+    ~ScopedConnection() { disconnect(); }
+
+    ScopedConnection& operator=(const Connection& other)
+    {
+        disconnect();
+        Connection::operator=(other);
+        return *this;
+    }
+    ScopedConnection& operator=(ScopedConnection&& other)
+    {
+        if (this != &other) {
+            disconnect();
+            Connection::operator=(std::move(other));
+            other.body_.reset();
+        }
+        return *this;
+    }
+    ScopedConnection& operator=(const ScopedConnection&) = delete;
+};
+
+template <typename Signature>
+class Signal;
+
+// A signal whose emission takes no lock and allocates nothing.
+//
+// The slots live in an immutable list that is replaced as a whole, under a
+// mutex, whenever a slot is connected or disconnected. Emitting only counts
+// itself as a reader and loads the current list. A replaced list is freed by
+// the next writer that finds no readers, since any emission starting after
+// that can only load the newer list. Slots disconnected in the middle of an
+// emission are skipped for the rest of it.
+template <typename... Args>
+class Signal<void(Args...)>
+{
+public:
+    using Handler = fu2::function<void(Args...)>;
+
+private:
+    class Slot;
+    using SlotList = std::vector<std::shared_ptr<Slot>>;
+
+    struct State {
+        std::atomic<const SlotList*> slots{new SlotList{}};
+        std::atomic<uint32_t> readers{0};
+
+        std::mutex mutex; // Serializes writers
+        std::vector<const SlotList*> retired;
+
+        ~State()
+        {
+            for (const SlotList* list : retired) {
+                delete list;
+            }
+            delete slots.load();
+        }
+
+        // Must be called with the mutex held.
+        void publish(const SlotList* list)
+        {
+            retired.push_back(slots.exchange(list));
+
+            if (readers.load() == 0) {
+                for (const SlotList* old : retired) {
+                    delete old;
+                }
+                retired.clear();
+            }
+        }
+
+        void remove(const Slot* slot)
+        {
+            std::scoped_lock lk{mutex};
+
+            auto* list = new SlotList{};
+            for (const auto& s : *slots.load()) {
+                if (s.get() != slot) {
+                    list->push_back(s);
+                }
+            }
+            publish(list);
+        }
+    };
+
+    class Slot : public detail::ConnectionBody
+    {
+    public:
+        Slot(Handler handler, std::weak_ptr<State> state) :
+            handler{std::move(handler)},
+            state_{std::move(state)}
+        {
+        }
+
+        void disconnect() override
+        {
+            if (connected_.exchange(false)) {
+                if (auto state = state_.lock()) {
+                    state->remove(this);
+                }
+            }
+        }
+
+        void markDisconnected() { connected_ = false; }
+
+        Handler handler;
+
+    private:
+        std::weak_ptr<State> state_;
+    };
+
+public:
+    Signal() : state_{std::make_shared<State>()} {}
+    Signal(const Signal&) = delete;
+    Signal& operator=(const Signal&) = delete;
+
+    Connection connect(Handler handler)
+    {
+        auto slot = std::make_shared<Slot>(std::move(handler), state_);
+
+        std::scoped_lock lk{state_->mutex};
+
+        auto* list = new SlotList{*state_->slots.load()};
+        list->push_back(slot);
+        state_->publish(list);
+
+        return Connection{std::weak_ptr<detail::ConnectionBody>{slot}};
+    }
+
+    void disconnect_all_slots()
+    {
+        std::scoped_lock lk{state_->mutex};
+
+        for (const auto& slot : *state_->slots.load()) {
+            slot->markDisconnected();
+        }
+        state_->publish(new SlotList{});
+    }
+
+    size_t num_slots() const { return state_->slots.load()->size(); }
+
+    void operator()(const Args&... args) const
+    {
+        // Leaves the readers even if a handler throws.
+        struct ReaderGuard {
+            std::atomic<uint32_t>& readers;
+            ~ReaderGuard() { readers.fetch_sub(1); }
+        };
+
+        state_->readers.fetch_add(1);
+        ReaderGuard guard{state_->readers};
+
+        const SlotList* slots = state_->slots.load();
+        for (const auto& slot : *slots) {
+            if (slot->connected()) {
+                slot->handler(args...);
+            }
+        }
+    }
+
+private:
+    // Shared with the slots, so that a connection outliving its signal can
+    // still be disconnected.
+    std::shared_ptr<State> state_;
+};
+
+} // namespace violetrx
+
+#endif // ASYNC_CORE_SIGNAL_H
@@ -5,11 +5,13 @@
 #include <chrono>
 #include <cstdint>
 #include <string>
+#include <vector>
 
-#include <boost/signals2.hpp>
+#include <broadcast_queue.h>
 #include <function2/function2.hpp>
 
 #include "async_core/error_codes.h"
+#include "async_core/signal.h"
 
 namespace violetrx
 {
@@ -20,11 +22,6 @@ using AsyncVfoIfaceSptr = std::shared_ptr<AsyncVfoIface>;
 class AsyncReceiverIface;
 using AsyncReceiverIfaceSptr = std::shared_ptr<AsyncReceiverIface>;
 
-using Connection = boost::signals2::connection;
-
-template <typename... Args>
-using Signal = boost::signals2::signal<Args...>;
-
 struct Timestamp {
     uint64_t seconds;
     uint32_t nanos;
@@ -49,11 +46,18 @@ struct Timestamp {
             std::chrono::seconds(seconds) + std::chrono::nanoseconds(nanos)};
     }
 
+    // Wall time, but monotonic: the steady clock anchored once to the system
+    // clock, so adjusting the system clock doesn't reorder timestamps. Only
+    // reads the steady clock, it takes no lock and allocates nothing.
     static inline Timestamp Now()
     {
-        // Note: system_clock might change in the course of the program, which
-        // might cause unintended bugs.
-        return FromTimepoint(std::chrono::system_clock::now());
+        using std::chrono::steady_clock;
+        using std::chrono::system_clock;
+
+        static const system_clock::time_point anchor =
+            system_clock::now() - steady_clock::now().time_since_epoch();
+
+        return FromTimepoint(anchor + steady_clock::now().time_since_epoch());
     }
 };
 
@@ -86,6 +90,12 @@ enum class FilterShape {
     SHARP = 2   /*!< Sharp: Transition band is TBD of width */
 };
 
+enum class IqFormat {
+    CF32 = 0, /*!< Interleaved 32-bit float. */
+    CS16 = 1, /*!< Interleaved 16-bit signed integer. */
+    CS8 = 2   /*!< Interleaved 8-bit signed integer. */
+};
+
 struct Filter {
     FilterShape shape;
     int32_t low;
@@ -96,8 +106,35 @@ struct UdpStreamParams {
     std::string host;
     int port;
     bool stereo;
+    bool rtp;
 };
 
+enum class IqTransport {
+    NONE = 0, /*!< No network output. */
+    UDP = 1,  /*!< Raw datagrams to a host and port. */
+    TCP = 2   /*!< Raw stream to clients connecting to a port. */
+};
+
+struct IqStreamParams {
+    int sampleRate; /*!< 0 for the channel rate. */
+    IqFormat format;
+    IqTransport transport;
+    std::string host;
+    int port;
+};
+
+struct IqPacket {
+    static constexpr size_t MAX_SIZE = 16384;
+
+    uint64_t offset; /*!< Index of the first sample in the stream. */
+    int32_t sampleRate;
+    IqFormat format;
+    uint32_t size; /*!< Bytes used in data. */
+    uint8_t data[MAX_SIZE];
+};
+
+using IqReceiver = broadcast_queue::receiver<IqPacket>;
+
 struct SnifferParams {
     int sampleRate;
     int buffSize;
@@ -108,6 +145,51 @@ struct Device {
     std::string devstr;
 };
 
+// GNU Radio performance counters of a single block
+struct BlockPerfStats {
+    std::string name;         // Block alias, e.g. fft_filter_ccc(42)
+    double workTimeAvg;       // Average time spent in work(), in seconds
+    double workTimeTotal;     // Total time spent in work(), in seconds
+    double nproducedAvg;      // Average items produced by work()
+    double inputBuffersFull;  // Average fullness of the inputs, 0..1
+    double outputBuffersFull; // Average fullness of the outputs, 0..1
+};
+
+struct VfoPerfStats {
+    uint64_t handle;
+    double workTimeTotal; // Sum over the blocks of the VFO
+    std::vector<BlockPerfStats> blocks;
+};
+
+struct PerfStats {
+    std::vector<BlockPerfStats> blocks; // Blocks outside of the VFOs
+    std::vector<VfoPerfStats> vfos;
+};
+
+// Durations in power of two buckets: buckets[0] counts the ones under 1 us,
+// buckets[i] the ones in [2^(i-1), 2^i) us, the last one everything longer
+struct LatencyHistogram {
+    std::vector<uint64_t> buckets;
+    uint64_t count;
+    double sum; // In seconds
+    double max; // In seconds
+};
+
+struct CommandStats {
+    std::string command;
+    LatencyHistogram queueWait; // Time spent in the queue of the worker
+    LatencyHistogram execution;
+};
+
+struct WorkerStats {
+    uint64_t queueDepth;
+    bool stalled; // The worker is refusing new commands
+    std::string currentCommand;
+    double currentCommandDuration; // In seconds
+    double avgLatency;             // In seconds
+    std::vector<CommandStats> commands;
+};
+
 enum class Demod {
     OFF = 0,              /*!< Demodulator completely off. */
     RAW = 1,              /*!< Raw I/Q passthrough. */
@@ -7,7 +7,6 @@
 #include "async_core_c/events_c.h"
 #include "async_core_c/events_conversion.h"
 
-#include <boost/signals2/connection.hpp>
 #include <cstring>
 #include <deque>
 #include <memory>
@@ -236,6 +235,26 @@ void violet_rx_get_fft_data(VioletReceiver* rx_erased, float* data, int size,
                      });
 }
 
+void violet_rx_start_shm_output(VioletReceiver* rx_erased, const char* prefix,
+                                VioletVoidCallback callback, void* userdata)
+{
+    auto rx = static_cast<violetrx::AsyncReceiverIface*>(rx_erased);
+
+    rx->startShmOutput(prefix, [callback, userdata](violetrx::ErrorCode code) {
+        callback(code, userdata);
+    });
+}
+
+void violet_rx_stop_shm_output(VioletReceiver* rx_erased,
+                               VioletVoidCallback callback, void* userdata)
+{
+    auto rx = static_cast<violetrx::AsyncReceiverIface*>(rx_erased);
+
+    rx->stopShmOutput([callback, userdata](violetrx::ErrorCode code) {
+        callback(code, userdata);
+    });
+}
+
 void violet_rx_add_vfo(VioletReceiver* rx_erased, VioletVfoCallback callback,
                        void* userdata)
 {
@@ -389,23 +408,20 @@ VioletVfo* violet_rx_get_vfo(VioletReceiver* rx_erased, int idx)
     }
 }
 
-class Connection : public boost::signals2::connection
+class Connection : public violetrx::Connection
 {
 public:
     Connection() noexcept {}
-    Connection(const connection& other) : connection(other) {}
-    Connection(connection&& other) : connection(std::move(other)) {}
-    Connection(
-        const boost::weak_ptr<boost::signals2::detail::connection_body_base>&
-            connectionBody) noexcept :
-        connection(connectionBody)
+    Connection(const violetrx::Connection& other) :
+        violetrx::Connection(other)
     {
     }
-
-    boost::signals2::detail::connection_body_base* ptr()
+    Connection(violetrx::Connection&& other) :
+        violetrx::Connection(std::move(other))
     {
-        return _weak_connection_body.lock().get();
     }
+
+    violetrx::detail::ConnectionBody* ptr() { return body_.lock().get(); }
 };
 
 // FIXME: this should be the behaviour of subscribe
@@ -427,8 +443,7 @@ void violet_rx_subscribe(VioletReceiver* rx_erased, VioletEventHandler handler,
 }
 void violet_unsubscribe(VioletConnection* connection_erased)
 {
-    auto connection =
-        (boost::signals2::detail::connection_body_base*)connection_erased;
+    auto connection = (violetrx::detail::ConnectionBody*)connection_erased;
 
     connection->disconnect();
 }
@@ -49,6 +49,11 @@ void violet_rx_set_fft_window(VioletReceiver* rx, VioletWindowType window,
 void violet_rx_get_fft_data(VioletReceiver* rx, float* data, int size,
                             VioletFftDataCallback callback, void* userdata);
 
+void violet_rx_start_shm_output(VioletReceiver* rx, const char* prefix,
+                                VioletVoidCallback callback, void* userdata);
+void violet_rx_stop_shm_output(VioletReceiver* rx, VioletVoidCallback callback,
+                               void* userdata);
+
 void violet_rx_add_vfo(VioletReceiver* rx, VioletVfoCallback callback,
                        void* userdata);
 void violet_rx_remove_vfo(VioletReceiver* rx, VioletVfo* vfo,
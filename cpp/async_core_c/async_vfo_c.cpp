@@ -234,6 +234,27 @@ void violet_vfo_stop_audio_recording(VioletVfo* vfo_erased,
         callback(code, userdata);
     });
 }
+void violet_vfo_start_sql_recording(VioletVfo* vfo_erased, const char* prefix,
+                                    double hang_time,
+                                    VioletVoidCallback callback,
+                                    void* userdata)
+{
+    auto vfo = static_cast<violetrx::AsyncVfoIface*>(vfo_erased);
+
+    vfo->startSqlRecording(prefix, hang_time,
+                           [callback, userdata](violetrx::ErrorCode code) {
+                               callback(code, userdata);
+                           });
+}
+void violet_vfo_stop_sql_recording(VioletVfo* vfo_erased,
+                                   VioletVoidCallback callback, void* userdata)
+{
+    auto vfo = static_cast<violetrx::AsyncVfoIface*>(vfo_erased);
+
+    vfo->stopSqlRecording([callback, userdata](violetrx::ErrorCode code) {
+        callback(code, userdata);
+    });
+}
 void violet_vfo_set_audio_gain(VioletVfo* vfo_erased, float gain,
                                VioletVoidCallback callback, void* userdata)
 {
@@ -278,6 +299,36 @@ void violet_vfo_get_sniffer_data(VioletVfo* vfo_erased, float* data, int size,
         });
 }
 
+/* I/Q streaming */
+void violet_vfo_start_iq_stream(VioletVfo* vfo_erased, int sample_rate,
+                                VioletIqFormat format,
+                                VioletIqTransport transport, const char* host,
+                                int port, VioletVoidCallback callback,
+                                void* userdata)
+{
+    auto vfo = static_cast<violetrx::AsyncVfoIface*>(vfo_erased);
+
+    violetrx::IqStreamParams params{
+        .sampleRate = sample_rate,
+        .format = (violetrx::IqFormat)format,
+        .transport = (violetrx::IqTransport)transport,
+        .host = host ? host : "",
+        .port = port,
+    };
+    vfo->startIqStream(params, [callback, userdata](violetrx::ErrorCode code) {
+        callback(code, userdata);
+    });
+}
+void violet_vfo_stop_iq_stream(VioletVfo* vfo_erased,
+                               VioletVoidCallback callback, void* userdata)
+{
+    auto vfo = static_cast<violetrx::AsyncVfoIface*>(vfo_erased);
+
+    vfo->stopIqStream([callback, userdata](violetrx::ErrorCode code) {
+        callback(code, userdata);
+    });
+}
+
 /* rds functions */
 void violet_vfo_get_rds_data(VioletVfo* vfo_erased,
                              VioletRdsDataCallback callback, void* userdata)
@@ -411,6 +462,11 @@ bool violet_vfo_is_udp_streaming(VioletVfo* vfo_erased)
     auto vfo = static_cast<violetrx::AsyncVfoIface*>(vfo_erased);
     return vfo->isUdpStreaming();
 }
+bool violet_vfo_is_iq_streaming(VioletVfo* vfo_erased)
+{
+    auto vfo = static_cast<violetrx::AsyncVfoIface*>(vfo_erased);
+    return vfo->isIqStreaming();
+}
 bool violet_vfo_is_sniffing(VioletVfo* vfo_erased)
 {
     auto vfo = static_cast<violetrx::AsyncVfoIface*>(vfo_erased);
@@ -483,23 +539,20 @@ float violet_vfo_get_noise_blanker2_threshold(VioletVfo* vfo_erased)
 }
 
 // FIXME: DRY please!
-class Connection : public boost::signals2::connection
+class Connection : public violetrx::Connection
 {
 public:
     Connection() noexcept {}
-    Connection(const connection& other) : connection(other) {}
-    Connection(connection&& other) : connection(std::move(other)) {}
-    Connection(
-        const boost::weak_ptr<boost::signals2::detail::connection_body_base>&
-            connectionBody) noexcept :
-        connection(connectionBody)
+    Connection(const violetrx::Connection& other) :
+        violetrx::Connection(other)
     {
     }
-
-    boost::signals2::detail::connection_body_base* ptr()
+    Connection(violetrx::Connection&& other) :
+        violetrx::Connection(std::move(other))
     {
-        return _weak_connection_body.lock().get();
     }
+
+    violetrx::detail::ConnectionBody* ptr() { return body_.lock().get(); }
 };
 
 void violet_vfo_subscribe(VioletVfo* vfo_erased, VioletVfoEventHandler handler,
@@ -77,6 +77,12 @@ void violet_vfo_start_audio_recording(VioletVfo* vfo, const char* filename,
 void violet_vfo_stop_audio_recording(VioletVfo* vfo,
                                      VioletVoidCallback callback,
                                      void* userdata);
+void violet_vfo_start_sql_recording(VioletVfo* vfo, const char* prefix,
+                                    double hang_time,
+                                    VioletVoidCallback callback,
+                                    void* userdata);
+void violet_vfo_stop_sql_recording(VioletVfo* vfo, VioletVoidCallback callback,
+                                   void* userdata);
 void violet_vfo_set_audio_gain(VioletVfo* vfo, float,
                                VioletVoidCallback callback, void* userdata);
 
@@ -89,6 +95,15 @@ void violet_vfo_get_sniffer_data(VioletVfo* vfo, float* data, int size,
                                  VioletSnifferDataCallback callback,
                                  void* userdata);
 
+/* I/Q streaming */
+void violet_vfo_start_iq_stream(VioletVfo* vfo, int sample_rate,
+                                VioletIqFormat format,
+                                VioletIqTransport transport, const char* host,
+                                int port, VioletVoidCallback callback,
+                                void* userdata);
+void violet_vfo_stop_iq_stream(VioletVfo* vfo, VioletVoidCallback callback,
+                               void* userdata);
+
 /* rds functions */
 void violet_vfo_get_rds_data(VioletVfo* vfo, VioletRdsDataCallback callback,
                              void* userdata);
@@ -117,6 +132,7 @@ float violet_vfo_get_am_sync_pll_bw(VioletVfo* vfo);
 bool violet_vfo_is_audio_recording(VioletVfo* vfo);
 char* violet_vfo_recording_filename(VioletVfo* vfo);
 bool violet_vfo_is_udp_streaming(VioletVfo* vfo);
+bool violet_vfo_is_iq_streaming(VioletVfo* vfo);
 bool violet_vfo_is_sniffing(VioletVfo* vfo);
 bool violet_vfo_is_rds_decoder_active(VioletVfo* vfo);
 bool violet_vfo_is_agc_on(VioletVfo* vfo);
@@ -33,6 +33,7 @@ enum VioletEvent {
     VIOLET_RECEIVER_FFT_WINDOW_CHANGED,
     VIOLET_RECEIVER_IQ_RECORDING_STARTED,
     VIOLET_RECEIVER_IQ_RECORDING_STOPPED,
+    VIOLET_RECEIVER_INPUT_EOF,
 
     // vfo events
     VIOLET_VFO_SYNC_START,
@@ -60,10 +61,13 @@ enum VioletEvent {
     VIOLET_VFO_AM_SYNC_PLL_BW_CHANGED,
     VIOLET_VFO_RECORDING_STARTED,
     VIOLET_VFO_RECORDING_STOPPED,
+    VIOLET_VFO_AUDIO_SEGMENT_RECORDED,
     VIOLET_VFO_SNIFFER_STARTED,
     VIOLET_VFO_SNIFFER_STOPPED,
     VIOLET_VFO_UDP_STREAMING_STARTED,
     VIOLET_VFO_UDP_STREAMING_STOPPED,
+    VIOLET_VFO_IQ_STREAM_STARTED,
+    VIOLET_VFO_IQ_STREAM_STOPPED,
     VIOLET_VFO_RDS_DECODER_STARTED,
     VIOLET_VFO_RDS_DECODER_STOPPED,
     VIOLET_VFO_RDS_PARSER_RESET,
@@ -188,6 +192,10 @@ typedef struct {
     VioletEventCommon base;
 } VioletIqRecordingStopped;
 
+typedef struct {
+    VioletEventCommon base;
+} VioletInputEof;
+
 typedef struct {
     VioletVfoEventCommon base;
 } VioletVfoSyncStart;
@@ -312,6 +320,13 @@ typedef struct {
     VioletVfoEventCommon base;
 } VioletRecordingStopped;
 
+typedef struct {
+    VioletVfoEventCommon base;
+    const char* path;
+    VioletTimestamp start;
+    double duration;
+} VioletAudioSegmentRecorded;
+
 typedef struct {
     VioletVfoEventCommon base;
     int32_t sample_rate;
@@ -339,12 +354,26 @@ typedef struct {
     const char* host;
     int32_t port;
     bool stereo;
+    bool rtp;
 } VioletUdpStreamingStarted;
 
 typedef struct {
     VioletVfoEventCommon base;
 } VioletUdpStreamingStopped;
 
+typedef struct {
+    VioletVfoEventCommon base;
+    int32_t sample_rate;
+    VioletIqFormat format;
+    VioletIqTransport transport;
+    const char* host;
+    int32_t port;
+} VioletIqStreamStarted;
+
+typedef struct {
+    VioletVfoEventCommon base;
+} VioletIqStreamStopped;
+
 typedef struct {
     VioletVfoEventCommon base;
     float gain;
@@ -210,6 +210,12 @@ VioletEventGeneric event_cpp_to_c(const IqRecordingStopped& event)
         .base = to_event_base(event, VIOLET_RECEIVER_IQ_RECORDING_STOPPED)});
 }
 
+VioletEventGeneric event_cpp_to_c(const InputEof& event)
+{
+    return to_generic_event(
+        VioletInputEof{.base = to_event_base(event, VIOLET_RECEIVER_INPUT_EOF)});
+}
+
 VioletEventGeneric event_cpp_to_c(const VfoSyncStart& event)
 {
     return to_generic_event(VioletVfoSyncStart{
@@ -403,6 +409,16 @@ VioletEventGeneric event_cpp_to_c(const RecordingStopped& event)
     });
 }
 
+VioletEventGeneric event_cpp_to_c(const AudioSegmentRecorded& event)
+{
+    return to_generic_event(VioletAudioSegmentRecorded{
+        .base = to_vfo_event_base(event, VIOLET_VFO_AUDIO_SEGMENT_RECORDED),
+        .path = event.path.c_str(),
+        .start = {.seconds = event.start.seconds, .nanos = event.start.nanos},
+        .duration = event.duration,
+    });
+}
+
 VioletEventGeneric event_cpp_to_c(const SnifferStarted& event)
 {
     return to_generic_event(VioletSnifferStarted{
@@ -447,6 +463,7 @@ VioletEventGeneric event_cpp_to_c(const UdpStreamingStarted& event)
         .host = event.host.c_str(),
         .port = event.port,
         .stereo = event.stereo,
+        .rtp = event.rtp,
     });
 }
 
@@ -457,6 +474,25 @@ VioletEventGeneric event_cpp_to_c(const UdpStreamingStopped& event)
     });
 }
 
+VioletEventGeneric event_cpp_to_c(const IqStreamStarted& event)
+{
+    return to_generic_event(VioletIqStreamStarted{
+        .base = to_vfo_event_base(event, VIOLET_VFO_IQ_STREAM_STARTED),
+        .sample_rate = event.sample_rate,
+        .format = (VioletIqFormat)event.format,
+        .transport = (VioletIqTransport)event.transport,
+        .host = event.host.c_str(),
+        .port = event.port,
+    });
+}
+
+VioletEventGeneric event_cpp_to_c(const IqStreamStopped& event)
+{
+    return to_generic_event(VioletIqStreamStopped{
+        .base = to_vfo_event_base(event, VIOLET_VFO_IQ_STREAM_STOPPED),
+    });
+}
+
 VioletEventGeneric event_cpp_to_c(const AudioGainChanged& event)
 {
     return to_generic_event(VioletAudioGainChanged{
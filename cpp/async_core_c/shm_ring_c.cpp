@@ -0,0 +1,55 @@
+#include "shm_ring_c.h"
+#include "dsp/shm_ring.h"
+
+#include <stdexcept>
+
+VioletShmRing* violet_shm_open(const char* name)
+{
+    try {
+        return new shm_ring_reader(name);
+    } catch (std::runtime_error&) {
+        return nullptr;
+    }
+}
+
+void violet_shm_close(VioletShmRing* ring_erased)
+{
+    delete static_cast<shm_ring_reader*>(ring_erased);
+}
+
+VioletShmKind violet_shm_get_kind(VioletShmRing* ring_erased)
+{
+    auto ring = static_cast<shm_ring_reader*>(ring_erased);
+    return (VioletShmKind)ring->get_kind();
+}
+
+VioletShmStatus violet_shm_next(VioletShmRing* ring_erased,
+                                VioletShmFrame* frame, int timeout_ms)
+{
+    auto ring = static_cast<shm_ring_reader*>(ring_erased);
+
+    shm_ring::frame f;
+    shm_ring::status status = ring->next(f, timeout_ms);
+    if (status == shm_ring::STATUS_OK) {
+        *frame = VioletShmFrame{
+            .data = f.data,
+            .size = f.size,
+            .offset = f.offset,
+            .timestamp_ns = f.timestamp_ns,
+            .sample_rate = f.sample_rate,
+            .seq = f.seq,
+        };
+    }
+
+    return (VioletShmStatus)status;
+}
+
+bool violet_shm_validate(VioletShmRing* ring_erased,
+                         const VioletShmFrame* frame)
+{
+    auto ring = static_cast<shm_ring_reader*>(ring_erased);
+
+    shm_ring::frame f{};
+    f.seq = frame->seq;
+    return ring->validate(f);
+}
@@ -0,0 +1,66 @@
+#ifndef C_SHM_RING_H
+#define C_SHM_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Readers of the shared memory output of a receiver on the same host, see
+ * violet_rx_start_shm_output. With a prefix of "violet", the rings are:
+ *
+ *   violet-iq                 wideband I/Q, at the decimated input rate
+ *   violet-fft                FFT frames of the wideband I/Q, 25 per second
+ *   violet-vfo<handle>-iq     I/Q of a VFO channel, at its quadrature rate
+ *   violet-vfo<handle>-audio  audio of a VFO channel, interleaved stereo
+ *
+ * Frames point straight into shared memory, and the writer never waits for
+ * readers. Once done with a frame, check it with violet_shm_validate and
+ * discard whatever was read from it if the writer overwrote it meanwhile.
+ */
+
+typedef void VioletShmRing;
+
+enum VioletShmKind {
+    VIOLET_SHM_IQ_CF32 = 0,
+    VIOLET_SHM_AUDIO_F32_STEREO = 1,
+    VIOLET_SHM_FFT_F32 = 2
+};
+
+enum VioletShmStatus {
+    VIOLET_SHM_OK = 0,
+    VIOLET_SHM_TIMEOUT = 1,
+    VIOLET_SHM_LAGGED = 2,
+    VIOLET_SHM_CLOSED = 3
+};
+
+typedef struct VioletShmFrame {
+    const void* data;
+    size_t size;
+    uint64_t offset;       /* index of the first item, or of the FFT frame */
+    uint64_t timestamp_ns; /* wall clock time the frame was published */
+    double sample_rate;    /* items per second, or the FFT bandwidth */
+    uint64_t seq;
+} VioletShmFrame;
+
+/* Returns NULL if the ring doesn't exist */
+VioletShmRing* violet_shm_open(const char* name);
+void violet_shm_close(VioletShmRing* ring);
+
+VioletShmKind violet_shm_get_kind(VioletShmRing* ring);
+
+/* timeout_ms < 0 waits forever. On VIOLET_SHM_LAGGED frames were lost and
+ * the next call returns the latest one. */
+VioletShmStatus violet_shm_next(VioletShmRing* ring, VioletShmFrame* frame,
+                                int timeout_ms);
+bool violet_shm_validate(VioletShmRing* ring, const VioletShmFrame* frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -62,6 +62,18 @@ enum VioletDemod {
     VIOLET_DEMOD_LAST = 12
 };
 
+enum VioletIqFormat {
+    VIOLET_IQ_FORMAT_CF32 = 0,
+    VIOLET_IQ_FORMAT_CS16 = 1,
+    VIOLET_IQ_FORMAT_CS8 = 2
+};
+
+enum VioletIqTransport {
+    VIOLET_IQ_TRANSPORT_NONE = 0,
+    VIOLET_IQ_TRANSPORT_UDP = 1,
+    VIOLET_IQ_TRANSPORT_TCP = 2
+};
+
 struct VioletFilter {
     VioletFilterShape shape;
     int64_t low;
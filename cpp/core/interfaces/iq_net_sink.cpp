@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+#include "iq_net_sink.h"
+#include "udp_socket.h"
+
+/* Send flags that never block and never raise SIGPIPE. */
+static constexpr int SEND_FLAGS = MSG_DONTWAIT | MSG_NOSIGNAL;
+
+static bool would_block(int err)
+{
+    return err == EAGAIN || err == EWOULDBLOCK || err == EINTR;
+}
+
+iq_net_sink::iq_net_sink(transport proto, const std::string& host, int port,
+                         size_t sample_size) :
+    d_proto(proto),
+    d_sample_size(sample_size),
+    d_payload((udp_socket::MAX_PAYLOAD - HEADER_SIZE) / sample_size *
+              sample_size),
+    d_addr{},
+    d_addr_len(0),
+    d_fd(-1),
+    d_dropped(0)
+{
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = proto == TRANSPORT_TCP ? SOCK_STREAM : SOCK_DGRAM;
+    hints.ai_flags = proto == TRANSPORT_TCP ? AI_PASSIVE : 0;
+
+    addrinfo* result = nullptr;
+    int err = getaddrinfo(host.empty() ? nullptr : host.c_str(),
+                          std::to_string(port).c_str(), &hints, &result);
+    if (err != 0 || !result)
+        throw std::runtime_error("can not resolve " + host + ": " +
+                                 gai_strerror(err));
+
+    // UDP shares the unconnected socket of the audio sinks
+    if (proto != TRANSPORT_TCP) {
+        d_socket = udp_socket::get(result->ai_family);
+        if (!d_socket) {
+            std::string error = std::strerror(errno);
+            freeaddrinfo(result);
+            throw std::runtime_error("can not create socket: " + error);
+        }
+
+        std::memcpy(&d_addr, result->ai_addr, result->ai_addrlen);
+        d_addr_len = result->ai_addrlen;
+        freeaddrinfo(result);
+        return;
+    }
+
+    d_fd = ::socket(result->ai_family, result->ai_socktype, 0);
+    if (d_fd < 0) {
+        freeaddrinfo(result);
+        throw std::runtime_error(std::string("can not create socket: ") +
+                                 std::strerror(errno));
+    }
+
+    int reuse = 1;
+    setsockopt(d_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    bool ok = ::bind(d_fd, result->ai_addr, result->ai_addrlen) == 0 &&
+              ::listen(d_fd, 8) == 0;
+    freeaddrinfo(result);
+
+    if (!ok) {
+        std::string error = std::strerror(errno);
+        ::close(d_fd);
+        throw std::runtime_error("can not listen on " + host + ":" +
+                                 std::to_string(port) + ": " + error);
+    }
+
+    d_acceptor = std::thread(&iq_net_sink::accept_loop, this);
+}
+iq_net_sink::~iq_net_sink()
+{
+    if (d_acceptor.joinable()) {
+        // wakes up accept() with an error
+        ::shutdown(d_fd, SHUT_RDWR);
+        d_acceptor.join();
+    }
+
+    for (const auto& c : d_clients)
+        ::close(c.fd);
+
+    if (d_fd >= 0)
+        ::close(d_fd);
+}
+
+void iq_net_sink::send(const void* data, size_t size, uint64_t offset)
+{
+    if (d_proto == TRANSPORT_TCP)
+        send_tcp((const char*)data, size);
+    else
+        send_udp((const char*)data, size, offset);
+}
+
+uint64_t iq_net_sink::dropped_packets()
+{
+    std::lock_guard lock{d_mutex};
+    return d_dropped;
+}
+
+size_t iq_net_sink::num_clients()
+{
+    std::lock_guard lock{d_mutex};
+    return d_clients.size();
+}
+
+void iq_net_sink::send_udp(const char* data, size_t size, uint64_t offset)
+{
+    const size_t npackets = (size + d_payload - 1) / d_payload;
+    size_t sent = 0;
+
+    uint8_t headers[udp_socket::MAX_BATCH][HEADER_SIZE];
+    iovec iov[2 * udp_socket::MAX_BATCH];
+
+    while (sent < npackets) {
+        size_t batch = std::min(npackets - sent, udp_socket::MAX_BATCH);
+
+        for (size_t k = 0; k < batch; k++) {
+            size_t pos = (sent + k) * d_payload;
+            uint64_t first = offset + pos / d_sample_size;
+
+            for (size_t i = 0; i < HEADER_SIZE; i++)
+                headers[k][i] = first >> (8 * i);
+
+            iov[2 * k].iov_base = headers[k];
+            iov[2 * k].iov_len = HEADER_SIZE;
+            iov[2 * k + 1].iov_base = (void*)(data + pos);
+            iov[2 * k + 1].iov_len = std::min(d_payload, size - pos);
+        }
+
+        size_t n = d_socket->send(iov, 2, batch, (const sockaddr*)&d_addr,
+                                  d_addr_len);
+        sent += n;
+        if (n < batch)
+            break;
+    }
+
+    if (sent < npackets) {
+        std::lock_guard lock{d_mutex};
+        if (d_dropped == 0)
+            spdlog::warn("Dropping UDP I/Q: {}", std::strerror(errno));
+        d_dropped += npackets - sent;
+    }
+}
+
+void iq_net_sink::send_tcp(const char* data, size_t size)
+{
+    std::lock_guard lock{d_mutex};
+
+    for (auto it = d_clients.begin(); it != d_clients.end();) {
+        if (send_client(*it, data, size)) {
+            ++it;
+        } else {
+            spdlog::info("I/Q stream client disconnected");
+            ::close(it->fd);
+            it = d_clients.erase(it);
+        }
+    }
+}
+
+/* Returns false if the client is gone, or too far behind. */
+bool iq_net_sink::send_client(client& c, const char* data, size_t size)
+{
+    // the backlog goes out first, to keep the stream in order
+    if (!c.backlog.empty()) {
+        ssize_t n =
+            ::send(c.fd, c.backlog.data(), c.backlog.size(), SEND_FLAGS);
+        if (n < 0 && !would_block(errno))
+            return false;
+        if (n > 0)
+            c.backlog.erase(c.backlog.begin(), c.backlog.begin() + n);
+    }
+
+    size_t sent = 0;
+    if (c.backlog.empty()) {
+        ssize_t n = ::send(c.fd, data, size, SEND_FLAGS);
+        if (n < 0 && !would_block(errno))
+            return false;
+        if (n > 0)
+            sent = n;
+    }
+
+    if (c.backlog.size() + size - sent > MAX_BACKLOG)
+        return false;
+
+    c.backlog.insert(c.backlog.end(), data + sent, data + size);
+    return true;
+}
+
+void iq_net_sink::accept_loop()
+{
+    for (;;) {
+        int fd = ::accept(d_fd, nullptr, nullptr);
+        if (fd < 0 && (errno == EINTR || errno == ECONNABORTED))
+            continue;
+        // including after the socket is shut down
+        if (fd < 0)
+            break;
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        spdlog::info("I/Q stream client connected");
+
+        std::lock_guard lock{d_mutex};
+        d_clients.push_back(client{fd, {}});
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef IQ_NET_SINK_H
+#define IQ_NET_SINK_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+
+class udp_socket;
+
+/*! \brief Sends raw I/Q packets over UDP, or to any number of TCP clients.
+ *  \ingroup IO
+ *
+ * Packets come from the scheduler thread, so nothing here blocks. Over UDP,
+ * packets are cut into datagrams of at most udp_socket::MAX_PAYLOAD bytes,
+ * and datagrams that don't fit in the send buffer are dropped. Every
+ * datagram starts with a HEADER_SIZE byte header holding the stream offset of
+ * its first sample, in samples, as a little endian 64 bit integer, followed
+ * by whole samples; so a client can tell lost and reordered datagrams apart
+ * and keep the stream aligned. Over TCP, a listening socket accepts clients on a background thread, and
+ * every client gets the stream from the moment it connects. Data a client
+ * can't take right away is kept in a backlog, and clients whose backlog grows
+ * beyond MAX_BACKLOG are disconnected, rather than dropping data and breaking
+ * the sample alignment of the stream.
+ */
+class iq_net_sink
+{
+public:
+    enum transport {
+        TRANSPORT_NONE = 0, /*!< No network output. */
+        TRANSPORT_UDP = 1,  /*!< Datagrams to a host and port. */
+        TRANSPORT_TCP = 2,  /*!< Listen for clients on a host and port. */
+    };
+
+    /*! \brief Size of the sample offset at the start of a UDP datagram. */
+    static constexpr size_t HEADER_SIZE = sizeof(uint64_t);
+
+    /*! \brief Most bytes queued for a slow TCP client. */
+    static constexpr size_t MAX_BACKLOG = 4 * 1024 * 1024;
+
+    /*! \brief Start streaming.
+     *  \param proto The transport.
+     *  \param host Destination for UDP, or the address to listen on for TCP,
+     *              where an empty host means all addresses.
+     *  \param port Destination or listening port.
+     *  \param sample_size Size of a sample, so datagrams hold whole samples.
+     *  \throws std::runtime_error if the socket can't be set up.
+     */
+    iq_net_sink(transport proto, const std::string& host, int port,
+                size_t sample_size);
+    ~iq_net_sink();
+
+    iq_net_sink(const iq_net_sink&) = delete;
+    iq_net_sink& operator=(const iq_net_sink&) = delete;
+
+    /*! \brief Send a packet, never blocking.
+     *  \param offset Stream offset of the first sample in the packet.
+     */
+    void send(const void* data, size_t size, uint64_t offset);
+
+    /*! \brief Number of UDP datagrams that couldn't be sent. */
+    uint64_t dropped_packets();
+
+    /*! \brief Number of connected TCP clients. */
+    size_t num_clients();
+
+private:
+    struct client {
+        int fd;
+        std::vector<char> backlog;
+    };
+
+    void send_udp(const char* data, size_t size, uint64_t offset);
+    void send_tcp(const char* data, size_t size);
+    bool send_client(client& c, const char* data, size_t size);
+    void accept_loop();
+
+private:
+    const transport d_proto;
+    const size_t d_sample_size;
+    const size_t d_payload; /*!< Datagram payload, in whole samples. */
+
+    std::shared_ptr<udp_socket> d_socket;
+    sockaddr_storage d_addr; /*!< UDP destination. */
+    socklen_t d_addr_len;
+
+    int d_fd; /*!< TCP listening socket. */
+
+    std::mutex d_mutex; /*!< Protects the state below. */
+    std::vector<client> d_clients;
+    uint64_t d_dropped;
+
+    std::thread d_acceptor;
+};
+
+#endif // IQ_NET_SINK_H
@@ -21,13 +21,21 @@
  * Boston, MA 02110-1301, USA.
  */
 
-#include <gnuradio/blocks/float_to_short.h>
-#include <gnuradio/hier_block2.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
 #include <gnuradio/io_signature.h>
-#include <gnuradio/network/udp_header_types.h>
-#include <gnuradio/network/udp_sink.h>
+#include <volk/volk.h>
 
 #include "udp_sink_f.h"
+#include "udp_socket.h"
 
 /*
  * Create a new instance of udp_sink_f and return an
@@ -45,18 +53,27 @@ static const int MIN_OUT = 0; /*!< Minimum number of output streams. */
 static const int MAX_OUT = 0; /*!< Maximum number of output streams. */
 
 udp_sink_f::udp_sink_f() :
-    gr::hier_block2("udp_sink_f",
-                    gr::io_signature::make(MIN_IN, MAX_IN, sizeof(float)),
-                    gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof(float)))
+    gr::sync_block("udp_sink_f",
+                   gr::io_signature::make(MIN_IN, MAX_IN, sizeof(float)),
+                   gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof(float))),
+    d_streaming(false),
+    d_stereo(false),
+    d_rtp(false),
+    d_addr{},
+    d_addr_len(0),
+    d_header_size(0),
+    d_packet_frames(0),
+    d_npackets(0),
+    d_nframes(0),
+    d_ssrc(std::random_device{}()),
+    d_marker(false),
+    d_dropped(0)
 {
-
-    d_f2s = gr::blocks::float_to_short::make(1, 32767);
-    d_inter = gr::blocks::interleave::make(sizeof(float));
-    d_null0 = gr::blocks::null_sink::make(sizeof(float));
-    d_null1 = gr::blocks::null_sink::make(sizeof(float));
-
-    connect(self(), 0, d_null0, 0);
-    connect(self(), 1, d_null1, 0);
+    // RFC 3550 wants random initial values, so that known plaintext attacks
+    // on encrypted streams are harder
+    std::random_device rd;
+    d_seq = (uint16_t)rd();
+    d_rtp_time = rd();
 }
 
 udp_sink_f::~udp_sink_f() {}
@@ -65,40 +82,184 @@ udp_sink_f::~udp_sink_f() {}
  *  \param host The hostname or IP address of the client.
  *  \param port The port used for the UDP stream
  *  \param stereo Select mono or stereo streaming
+ *  \param rtp Frame the samples as RTP
+ *  \returns false if the host couldn't be resolved.
  */
-void udp_sink_f::start_streaming(const std::string& host, int port, bool stereo)
+bool udp_sink_f::start_streaming(const std::string& host, int port,
+                                 bool stereo, bool rtp)
 {
-    lock();
-    disconnect_all();
-
-    d_logger->info("Starting UDP streaming, Host: {}, Port: {}, {}", host, port,
-                   stereo ? "Stereo" : "Mono");
-
-    d_sink = gr::network::udp_sink::make(sizeof(short), 1, host, port,
-                                         HEADERTYPE_NONE, 1448, true);
-
-    if (stereo) {
-        connect(self(), 0, d_inter, 0);
-        connect(self(), 1, d_inter, 1);
-        connect(d_inter, 0, d_f2s, 0);
-        connect(d_f2s, 0, d_sink, 0);
-    } else {
-        connect(self(), 0, d_f2s, 0);
-        connect(d_f2s, 0, d_sink, 0);
-        connect(self(), 1, d_null0, 0);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo* result = nullptr;
+    int err = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints,
+                          &result);
+    if (err != 0 || !result) {
+        d_logger->error("Can not resolve {}: {}", host, gai_strerror(err));
+        return false;
+    }
+
+    auto socket = udp_socket::get(result->ai_family);
+    if (!socket) {
+        d_logger->error("Can not create UDP socket: {}", std::strerror(errno));
+        freeaddrinfo(result);
+        return false;
     }
-    unlock();
+
+    std::lock_guard lock{d_mutex};
+
+    std::memcpy(&d_addr, result->ai_addr, result->ai_addrlen);
+    d_addr_len = result->ai_addrlen;
+    freeaddrinfo(result);
+
+    d_socket = socket;
+    d_stereo = stereo;
+    d_rtp = rtp;
+    d_header_size = rtp ? RTP_HEADER_SIZE : 0;
+    d_packet_frames = (udp_socket::MAX_PAYLOAD - d_header_size) /
+                      (sizeof(int16_t) * (stereo ? 2 : 1));
+    d_packets.assign(udp_socket::MAX_BATCH * udp_socket::MAX_PAYLOAD, 0);
+    d_interleaved.resize(2 * d_packet_frames);
+    d_npackets = 0;
+    d_nframes = 0;
+    d_marker = true;
+    d_streaming = true;
+
+    d_logger->info("Starting UDP streaming, Host: {}, Port: {}, {}, {}", host,
+                   port, stereo ? "Stereo" : "Mono", rtp ? "RTP" : "Raw");
+
+    return true;
 }
 
 void udp_sink_f::stop_streaming(void)
 {
-    lock();
-    disconnect_all();
-    connect(self(), 0, d_null0, 0);
-    connect(self(), 1, d_null1, 0);
-    unlock();
+    std::lock_guard lock{d_mutex};
+
+    d_streaming = false;
+    d_socket.reset();
+    d_packets = std::vector<uint8_t>();
+    d_npackets = 0;
+    d_nframes = 0;
 
     d_logger->info("Disconnected UDP streaming");
+}
+
+uint64_t udp_sink_f::dropped_packets()
+{
+    std::lock_guard lock{d_mutex};
+    return d_dropped;
+}
+
+int udp_sink_f::work(int noutput_items, gr_vector_const_void_star& input_items,
+                     gr_vector_void_star& /* output_items */)
+{
+    std::lock_guard lock{d_mutex};
+
+    if (!d_streaming)
+        return noutput_items;
+
+    queue_frames((const float*)input_items[0], (const float*)input_items[1],
+                 noutput_items);
+
+    // an incomplete datagram waits for the next call
+    flush();
+
+    return noutput_items;
+}
 
-    d_sink = nullptr;
+/* Convert frames into the datagram slots, flushing whenever they are full. */
+void udp_sink_f::queue_frames(const float* left, const float* right,
+                              int nframes)
+{
+    const size_t channels = d_stereo ? 2 : 1;
+
+    for (int i = 0; i < nframes;) {
+        int n = std::min<size_t>(nframes - i, d_packet_frames - d_nframes);
+
+        uint8_t* packet =
+            d_packets.data() + d_npackets * udp_socket::MAX_PAYLOAD;
+        int16_t* out =
+            (int16_t*)(packet + d_header_size) + d_nframes * channels;
+
+        // volk saturates instead of wrapping around on loud audio
+        if (d_stereo) {
+            volk_32f_x2_interleave_32fc((lv_32fc_t*)d_interleaved.data(),
+                                        left + i, right + i, n);
+            volk_32f_s32f_convert_16i(out, d_interleaved.data(), INT16_MAX,
+                                      2 * n);
+        } else {
+            volk_32f_s32f_convert_16i(out, left + i, INT16_MAX, n);
+        }
+
+        // L16 is big endian
+        if (d_rtp)
+            volk_16u_byteswap((uint16_t*)out, n * channels);
+
+        i += n;
+        d_nframes += n;
+
+        if (d_nframes < d_packet_frames)
+            continue;
+
+        if (d_rtp) {
+            packet[0] = 0x80; // version 2, no padding, extensions or CSRCs
+            packet[1] = (d_marker ? 0x80 : 0) | RTP_PAYLOAD_TYPE;
+            packet[2] = d_seq >> 8;
+            packet[3] = d_seq;
+            packet[4] = d_rtp_time >> 24;
+            packet[5] = d_rtp_time >> 16;
+            packet[6] = d_rtp_time >> 8;
+            packet[7] = d_rtp_time;
+            packet[8] = d_ssrc >> 24;
+            packet[9] = d_ssrc >> 16;
+            packet[10] = d_ssrc >> 8;
+            packet[11] = d_ssrc;
+
+            d_seq++;
+            d_rtp_time += d_packet_frames;
+            d_marker = false;
+        }
+
+        d_npackets++;
+        d_nframes = 0;
+
+        if (d_npackets == udp_socket::MAX_BATCH)
+            flush();
+    }
+}
+
+/* Send the complete datagrams, and move the incomplete one to the front. */
+void udp_sink_f::flush()
+{
+    if (d_npackets == 0)
+        return;
+
+    const size_t frame_size = sizeof(int16_t) * (d_stereo ? 2 : 1);
+    const size_t packet_size = d_header_size + d_packet_frames * frame_size;
+
+    iovec iov[udp_socket::MAX_BATCH];
+    for (size_t k = 0; k < d_npackets; k++) {
+        iov[k].iov_base = d_packets.data() + k * udp_socket::MAX_PAYLOAD;
+        iov[k].iov_len = packet_size;
+    }
+
+    size_t sent = d_socket->send(iov, 1, d_npackets,
+                                 (const sockaddr*)&d_addr, d_addr_len);
+
+    // the socket is shared by all channels and must never block the flow
+    // graph; UDP is lossy anyway, so a full send buffer just drops audio
+    if (sent < d_npackets) {
+        if (d_dropped == 0)
+            d_logger->warn("Dropping UDP audio: {}", std::strerror(errno));
+        d_dropped += d_npackets - sent;
+    }
+
+    if (d_nframes > 0) {
+        std::memmove(d_packets.data() + d_header_size,
+                     d_packets.data() +
+                         d_npackets * udp_socket::MAX_PAYLOAD + d_header_size,
+                     d_nframes * frame_size);
+    }
+    d_npackets = 0;
 }
@@ -23,12 +23,15 @@
 #ifndef UDP_SINK_F_H
 #define UDP_SINK_F_H
 
-#include <gnuradio/network/udp_sink.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
-#include <gnuradio/blocks/float_to_short.h>
-#include <gnuradio/blocks/interleave.h>
-#include <gnuradio/blocks/null_sink.h>
-#include <gnuradio/hier_block2.h>
+#include <sys/socket.h>
+
+#include <gnuradio/sync_block.h>
 
 class udp_sink_f;
 
@@ -36,21 +39,73 @@ typedef std::shared_ptr<udp_sink_f> udp_sink_f_sptr;
 
 udp_sink_f_sptr make_udp_sink_f(void);
 
-class udp_sink_f : public gr::hier_block2
+class udp_socket;
+
+/*! \brief Streams audio as 16 bit PCM over UDP.
+ *  \ingroup IO
+ *
+ * The two float inputs are interleaved (stereo) or the second one is dropped
+ * (mono), converted to 16 bit integers and cut into datagrams of at most
+ * udp_socket::MAX_PAYLOAD bytes. Without RTP the datagrams carry raw little
+ * endian samples, as before. With RTP every datagram starts with an RTP
+ * header (RFC 3550) and carries big endian L16 samples (RFC 3551) with
+ * dynamic payload type RTP_PAYLOAD_TYPE.
+ *
+ * All the datagrams completed in one call to work() are handed to the kernel
+ * at once, and all the sinks share one udp_socket per address family, so
+ * that a receiver can tell the channels of one server apart by their SSRC.
+ */
+class udp_sink_f : public gr::sync_block
 {
 public:
+    /*! \brief Size of an RTP header without CSRCs or extensions. */
+    static constexpr size_t RTP_HEADER_SIZE = 12;
+
+    static constexpr uint8_t RTP_PAYLOAD_TYPE = 96;
+
     udp_sink_f(void);
     ~udp_sink_f();
 
-    void start_streaming(const std::string& host, int port, bool stereo);
+    int work(int noutput_items, gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override;
+
+    bool start_streaming(const std::string& host, int port, bool stereo,
+                         bool rtp = false);
     void stop_streaming(void);
 
+    /*! \brief RTP synchronization source of this sink. */
+    uint32_t ssrc() const { return d_ssrc; }
+
+    /*! \brief Number of datagrams that couldn't be sent. */
+    uint64_t dropped_packets();
+
+private:
+    void queue_frames(const float* left, const float* right, int nframes);
+    void flush();
+
 private:
-    gr::network::udp_sink::sptr d_sink;     /*!< The gnuradio UDP sink. */
-    gr::blocks::float_to_short::sptr d_f2s; /*!< Converts float to short. */
-    gr::blocks::interleave::sptr d_inter;   /*!< Stereo interleaver. */
-    gr::blocks::null_sink::sptr d_null0;    /*!< Null sink for mono. */
-    gr::blocks::null_sink::sptr d_null1;    /*!< Null sink for mono. */
+    std::mutex d_mutex; /*!< Protects the streaming state. */
+    bool d_streaming;
+    bool d_stereo;
+    bool d_rtp;
+
+    std::shared_ptr<udp_socket> d_socket;
+    sockaddr_storage d_addr;
+    socklen_t d_addr_len;
+
+    size_t d_header_size;             /*!< 0, or RTP_HEADER_SIZE. */
+    size_t d_packet_frames;           /*!< Frames in a full datagram. */
+    std::vector<uint8_t> d_packets;   /*!< udp_socket::MAX_BATCH slots. */
+    size_t d_npackets;                /*!< Complete datagrams in d_packets. */
+    size_t d_nframes;                 /*!< Frames in the next datagram. */
+    std::vector<float> d_interleaved; /*!< Conversion scratch buffer. */
+
+    const uint32_t d_ssrc;
+    uint16_t d_seq;
+    uint32_t d_rtp_time;
+    bool d_marker; /*!< Next datagram starts a talkspurt. */
+
+    uint64_t d_dropped;
 };
 
 #endif // UDP_SINK_F_H
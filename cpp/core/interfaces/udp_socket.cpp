@@ -0,0 +1,78 @@
+#include <cerrno>
+#include <map>
+#include <mutex>
+
+#include <unistd.h>
+
+#include "udp_socket.h"
+
+udp_socket::~udp_socket() { ::close(d_fd); }
+
+std::shared_ptr<udp_socket> udp_socket::get(int family)
+{
+    static std::mutex mutex;
+    static std::map<int, std::weak_ptr<udp_socket>> sockets;
+
+    std::lock_guard lock{mutex};
+
+    auto socket = sockets[family].lock();
+    if (socket)
+        return socket;
+
+    int fd = ::socket(family, SOCK_DGRAM, 0);
+    if (fd < 0)
+        return nullptr;
+
+    // many channels streaming at once send bursts of datagrams
+    int sndbuf = 1 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+    // allow streaming to a broadcast address
+    int broadcast = 1;
+    setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast));
+
+    socket = std::make_shared<udp_socket>(fd);
+    sockets[family] = socket;
+
+    return socket;
+}
+
+size_t udp_socket::send(iovec* iov, size_t iovlen, size_t ndatagrams,
+                        const sockaddr* addr, socklen_t addr_len)
+{
+    size_t sent = 0;
+
+#ifdef __linux__
+    mmsghdr msgs[MAX_BATCH];
+
+    for (size_t k = 0; k < ndatagrams; k++) {
+        msgs[k] = mmsghdr{};
+        msgs[k].msg_hdr.msg_name = (void*)addr;
+        msgs[k].msg_hdr.msg_namelen = addr_len;
+        msgs[k].msg_hdr.msg_iov = iov + k * iovlen;
+        msgs[k].msg_hdr.msg_iovlen = iovlen;
+    }
+
+    while (sent < ndatagrams) {
+        int ret = sendmmsg(d_fd, msgs + sent, ndatagrams - sent, MSG_DONTWAIT);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            break;
+        sent += ret;
+    }
+#else
+    for (; sent < ndatagrams; sent++) {
+        msghdr msg{};
+        msg.msg_name = (void*)addr;
+        msg.msg_namelen = addr_len;
+        msg.msg_iov = iov + sent * iovlen;
+        msg.msg_iovlen = iovlen;
+
+        if (sendmsg(d_fd, &msg, MSG_DONTWAIT) < 0)
+            break;
+    }
+#endif
+
+    return sent;
+}
@@ -0,0 +1,52 @@
+#ifndef UDP_SOCKET_H
+#define UDP_SOCKET_H
+
+#include <cstddef>
+#include <memory>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+/*! \brief A UDP socket shared by all the senders of one address family.
+ *  \ingroup IO
+ *
+ * The socket is never connected, every datagram carries its destination, so
+ * senders streaming to different hosts can use the same socket concurrently.
+ * Sending never blocks: the senders run in the scheduler thread, and UDP is
+ * lossy anyway, so datagrams that don't fit in the send buffer are dropped.
+ */
+class udp_socket
+{
+public:
+    /*! \brief Largest datagram payload, which fits a 1500 byte MTU. */
+    static constexpr size_t MAX_PAYLOAD = 1448;
+
+    /*! \brief Most datagrams sent with one system call. */
+    static constexpr size_t MAX_BATCH = 64;
+
+    explicit udp_socket(int fd) : d_fd(fd) {}
+    ~udp_socket();
+
+    udp_socket(const udp_socket&) = delete;
+    udp_socket& operator=(const udp_socket&) = delete;
+
+    /*! \brief Get the socket for \p family, creating it if needed.
+     *  \returns nullptr if the socket couldn't be created.
+     */
+    static std::shared_ptr<udp_socket> get(int family);
+
+    /*! \brief Send datagrams to one destination, without blocking.
+     *  \param iov The buffers, \p iovlen consecutive ones per datagram.
+     *  \param iovlen Number of buffers in a datagram.
+     *  \param ndatagrams Number of datagrams, at most MAX_BATCH.
+     *  \returns The number of datagrams sent. If it is short, errno tells
+     *           why the rest was dropped.
+     */
+    size_t send(iovec* iov, size_t iovlen, size_t ndatagrams,
+                const sockaddr* addr, socklen_t addr_len);
+
+private:
+    const int d_fd;
+};
+
+#endif // UDP_SOCKET_H
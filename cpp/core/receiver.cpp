@@ -24,7 +24,9 @@
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <ctime>
 #include <filesystem>
+#include <fstream>
 #include <iomanip>
 #include <sstream>
 
@@ -35,7 +37,11 @@
 
 #include "dsp/correct_iq_cc.h"
 #include "dsp/filter/fir_decim.h"
+#include "dsp/iq_file_sink.h"
+#include "dsp/iq_file_source.h"
+#include "dsp/iq_ring_buffer.h"
 #include "dsp/multichannel_downconverter.h"
+#include "dsp/perf_counters.h"
 #include "dsp/rx_fft.h"
 #include "receiver.h"
 
@@ -45,6 +51,11 @@
 static constexpr float TARGET_QUAD_RATE = 280e3;
 static constexpr float MAX_NUM_VFO_CHANNELS = -1;
 
+/* The I/Q ring holds 4M samples, a fraction of a second at high rates. */
+static constexpr size_t SHM_IQ_SLOT_SIZE = 65536;
+static constexpr size_t SHM_IQ_NUM_SLOTS = 512;
+static constexpr size_t SHM_FFT_NUM_SLOTS = 4;
+
 receiver::sptr receiver::make(const std::string& input_device,
                               const std::string& audio_device, int decimation)
 {
@@ -67,8 +78,12 @@ receiver::receiver(const std::string& input_device,
     d_recording_iq(false),
     d_iq_rev(false),
     d_dc_cancel(false),
-    d_iq_balance(false)
+    d_iq_balance(false),
+    d_iq_history(0),
+    d_shm_fft_frames(0)
 {
+    // cheap enough to always keep, and must be on before the blocks start
+    enable_perf_counters();
 
     tb = gr::make_top_block("gqrx");
 
@@ -78,7 +93,15 @@ receiver::receiver(const std::string& input_device,
             ",freq=428e6,rate=96000,repeat=true,throttle=true");
     } else {
         input_devstr = input_device;
-        src = osmosdr::source::make(input_device);
+        make_input(input_device);
+    }
+
+    if (file_src) {
+        d_input_rate = file_src->sample_rate();
+        d_rf_freq = file_src->center_freq();
+    } else if (test_src) {
+        d_input_rate = test_src->sample_rate();
+        d_rf_freq = test_src->center_freq();
     }
 
     // input decimator
@@ -138,6 +161,21 @@ void receiver::stop()
     }
 }
 
+/**
+ * @brief Wait until the flow graph finishes by itself.
+ *
+ * Once a file input reaches its end, every block processes what is still
+ * buffered before the graph finishes, whereas stop() interrupts them right
+ * away.
+ */
+void receiver::wait_done()
+{
+    if (d_running) {
+        tb->wait();
+        d_running = false;
+    }
+}
+
 /**
  * @brief Select new input device.
  * @param device
@@ -162,31 +200,45 @@ void receiver::set_input_device(const std::string& device)
     }
 
     if (d_decim >= 2) {
-        tb->disconnect(src, 0, input_decim, 0);
+        tb->disconnect(input_block(), 0, input_decim, 0);
         tb->disconnect(input_decim, 0, iq_swap, 0);
     } else {
-        tb->disconnect(src, 0, iq_swap, 0);
+        tb->disconnect(input_block(), 0, iq_swap, 0);
     }
 
     src.reset();
+    file_src.reset();
+    test_src.reset();
 
     try {
-        src = osmosdr::source::make(device);
+        make_input(device);
     } catch (std::exception& x) {
         error = x.what();
+        file_src.reset();
+        test_src.reset();
         src = osmosdr::source::make(
             "file=" + escape_filename(get_zero_file()) +
             ",freq=428e6,rate=96000,repeat=true,throttle=true");
     }
 
-    if (src->get_sample_rate() != 0)
+    if (file_src) {
+        set_input_rate(file_src->sample_rate());
+        d_rf_freq = file_src->center_freq();
+    } else if (test_src) {
+        set_input_rate(test_src->sample_rate());
+        d_rf_freq = test_src->center_freq();
+    } else if (src->get_sample_rate() != 0) {
         set_input_rate(src->get_sample_rate());
+    }
+
+    for (auto& vfo : vfo_channels)
+        vfo->set_audio_output(!is_unthrottled_input());
 
     if (d_decim >= 2) {
-        tb->connect(src, 0, input_decim, 0);
+        tb->connect(input_block(), 0, input_decim, 0);
         tb->connect(input_decim, 0, iq_swap, 0);
     } else {
-        tb->connect(src, 0, iq_swap, 0);
+        tb->connect(input_block(), 0, iq_swap, 0);
     }
 
     if (d_running)
@@ -233,7 +285,14 @@ double receiver::set_input_rate(double rate)
     double current_rate;
     bool rate_has_changed;
 
-    current_rate = src->get_sample_rate();
+    // file playback runs at the rate of the recording, and the test signal
+    // at the rate it was generated for
+    if (file_src)
+        rate = file_src->sample_rate();
+    else if (test_src)
+        rate = test_src->sample_rate();
+
+    current_rate = input_block() != src ? rate : src->get_sample_rate();
     rate_has_changed = !(rate == current_rate ||
                          std::abs(rate - current_rate) <
                              std::abs(std::min(rate, current_rate)) *
@@ -241,7 +300,8 @@ double receiver::set_input_rate(double rate)
 
     tb->lock();
     try {
-        d_input_rate = src->set_sample_rate(rate);
+        d_input_rate =
+            input_block() != src ? rate : src->set_sample_rate(rate);
     } catch (std::runtime_error& e) {
         d_input_rate = 0;
     }
@@ -270,6 +330,12 @@ double receiver::set_input_rate(double rate)
         vfo->set_quad_rate(d_quad_rate);
 
     iq_fft->set_quad_rate(d_decim_rate);
+    if (iq_shm)
+        iq_shm->set_sample_rate(d_decim_rate);
+
+    // the history can't mix sample rates
+    if (iq_history)
+        iq_history->set_capacity(d_iq_history * d_decim_rate);
     tb->unlock();
 
     return d_input_rate;
@@ -287,10 +353,10 @@ int receiver::set_input_decim(int decim)
     }
 
     if (d_decim >= 2) {
-        tb->disconnect(src, 0, input_decim, 0);
+        tb->disconnect(input_block(), 0, input_decim, 0);
         tb->disconnect(input_decim, 0, iq_swap, 0);
     } else {
-        tb->disconnect(src, 0, iq_swap, 0);
+        tb->disconnect(input_block(), 0, iq_swap, 0);
     }
 
     input_decim.reset();
@@ -320,12 +386,18 @@ int receiver::set_input_decim(int decim)
         vfo->set_quad_rate(d_quad_rate);
 
     iq_fft->set_quad_rate(d_decim_rate);
+    if (iq_shm)
+        iq_shm->set_sample_rate(d_decim_rate);
+
+    // the history can't mix sample rates
+    if (iq_history)
+        iq_history->set_capacity(d_iq_history * d_decim_rate);
 
     if (d_decim >= 2) {
-        tb->connect(src, 0, input_decim, 0);
+        tb->connect(input_block(), 0, input_decim, 0);
         tb->connect(input_decim, 0, iq_swap, 0);
     } else {
-        tb->connect(src, 0, iq_swap, 0);
+        tb->connect(input_block(), 0, iq_swap, 0);
     }
 
 #ifdef CUSTOM_AIRSPY_KERNELS
@@ -425,6 +497,10 @@ bool receiver::get_iq_balance(void) const { return d_iq_balance; }
  */
 double receiver::set_rf_freq(double freq_hz)
 {
+    // can't retune a recording or the test signal
+    if (input_block() != src)
+        return d_rf_freq;
+
     src->set_center_freq(freq_hz);
     d_rf_freq = src->get_center_freq();
 
@@ -438,6 +514,9 @@ double receiver::set_rf_freq(double freq_hz)
  */
 double receiver::get_rf_freq(void)
 {
+    if (input_block() != src)
+        return d_rf_freq;
+
     d_rf_freq = src->get_center_freq();
 
     return d_rf_freq;
@@ -549,8 +628,13 @@ void receiver::get_iq_fft_data(float* fftPoints)
 /**
  * @brief Start I/Q data recorder.
  * @param filename The filename where to record.
+ * @param fmt The sample format of the recording.
+ *
+ * A SigMF metadata file (.sigmf-meta) describing the sample format, sample
+ * rate, center frequency and gains is written next to the recording.
  */
-bool receiver::start_iq_recording(std::string filename)
+bool receiver::start_iq_recording(std::string filename,
+                                  iq_file_sink::format fmt)
 {
     if (d_recording_iq) {
         spdlog::info("{}: already recording", __func__);
@@ -558,20 +642,25 @@ bool receiver::start_iq_recording(std::string filename)
     }
 
     try {
-        iq_sink = gr::blocks::file_sink::make(sizeof(gr_complex),
-                                              filename.c_str(), true);
+        iq_sink = iq_file_sink::make(filename, fmt);
     } catch (std::runtime_error& e) {
         spdlog::error("{}: couldn't open I/Q file ({})", __func__, filename);
         return false;
     }
 
+    // not fatal, the recording is still usable without it
+    if (!write_sigmf_meta(filename, fmt)) {
+        spdlog::warn("{}: couldn't write SigMF metadata for {}", __func__,
+                     filename);
+    }
+
     iq_filename = std::move(filename);
 
     tb->lock();
     if (d_decim >= 2)
         tb->connect(input_decim, 0, iq_sink, 0);
     else
-        tb->connect(src, 0, iq_sink, 0);
+        tb->connect(input_block(), 0, iq_sink, 0);
     d_recording_iq = true;
     tb->unlock();
 
@@ -587,26 +676,259 @@ bool receiver::stop_iq_recording()
     }
 
     tb->lock();
-    iq_sink->close();
-
     if (d_decim >= 2)
         tb->disconnect(input_decim, 0, iq_sink, 0);
     else
-        tb->disconnect(src, 0, iq_sink, 0);
-
+        tb->disconnect(input_block(), 0, iq_sink, 0);
     tb->unlock();
+
+    // joins the writer thread, which may take a while with a slow disk, so
+    // not while the flow graph is stopped
+    iq_sink->close();
+
+    auto stats = iq_sink->get_stats();
+    if (stats.buffers_dropped > 0 || stats.write_errors > 0) {
+        spdlog::warn("{}: {} buffers dropped, {} write errors while "
+                     "recording {}",
+                     __func__, stats.buffers_dropped, stats.write_errors,
+                     iq_filename);
+    }
+
     iq_sink.reset();
     d_recording_iq = false;
 
     return true;
 }
 
+/**
+ * @brief Get the statistics of the I/Q recorder.
+ *
+ * The queue depth tells how far the disk is lagging behind, the dropped
+ * buffer count how much was lost because it couldn't keep up.
+ */
+iq_file_sink::stats receiver::get_iq_recording_stats() const
+{
+    if (!iq_sink)
+        return iq_file_sink::stats{};
+
+    return iq_sink->get_stats();
+}
+
+/**
+ * @brief Keep a history of recent I/Q samples.
+ * @param seconds Length of the history, 0 to disable.
+ *
+ * The history is stored as 16-bit integers, so it takes 4 bytes per sample
+ * at the decimated input rate.
+ */
+void receiver::set_iq_history(double seconds)
+{
+    seconds = std::max(seconds, 0.0);
+    size_t capacity = seconds * d_decim_rate;
+
+    tb->lock();
+
+    if (capacity == 0) {
+        if (iq_history) {
+            tb->disconnect(iq_swap, 0, iq_history, 0);
+            iq_history.reset();
+        }
+    } else if (!iq_history) {
+        iq_history = iq_ring_buffer::make(capacity, iq_file_sink::FORMAT_CS16);
+        tb->connect(iq_swap, 0, iq_history, 0);
+    } else {
+        iq_history->set_capacity(capacity);
+    }
+
+    tb->unlock();
+
+    d_iq_history = capacity > 0 ? seconds : 0;
+}
+
+/**
+ * @brief Start writing the wideband I/Q and the FFT to shared memory.
+ * @param prefix Name prefix of the rings, which are named prefix-iq and
+ *               prefix-fft.
+ *
+ * The I/Q is written by the flow graph, while FFT frames are only published
+ * when publish_shm_fft() is called.
+ */
+bool receiver::start_shm_output(const std::string& prefix)
+{
+    if (iq_shm) {
+        spdlog::warn("Shared memory output is already active");
+        return false;
+    }
+
+    shm_ring_writer::sptr iq_ring;
+    try {
+        iq_ring = shm_ring_writer::make(prefix + "-iq", shm_ring::KIND_IQ_CF32,
+                                        SHM_IQ_SLOT_SIZE, SHM_IQ_NUM_SLOTS);
+        fft_shm = shm_ring_writer::make(prefix + "-fft", shm_ring::KIND_FFT_F32,
+                                        MAX_FFT_SIZE * sizeof(float),
+                                        SHM_FFT_NUM_SLOTS);
+    } catch (std::runtime_error& e) {
+        spdlog::error("Can not start shared memory output: {}", e.what());
+        return false;
+    }
+
+    d_shm_fft_frames = 0;
+
+    tb->lock();
+    iq_shm = shm_ring_sink::make(iq_ring, sizeof(gr_complex), 1, d_decim_rate);
+    tb->connect(iq_swap, 0, iq_shm, 0);
+    tb->unlock();
+
+    spdlog::info("Writing I/Q and FFT to shared memory {}-*", prefix);
+
+    return true;
+}
+
+/** Stop the shared memory output, which removes the rings. */
+bool receiver::stop_shm_output()
+{
+    if (!iq_shm)
+        return false;
+
+    tb->lock();
+    tb->disconnect(iq_swap, 0, iq_shm, 0);
+    tb->unlock();
+
+    iq_shm.reset();
+    fft_shm.reset();
+
+    return true;
+}
+
+/** Compute an FFT frame right into the shared memory ring. */
+void receiver::publish_shm_fft()
+{
+    if (!fft_shm)
+        return;
+
+    float* frame = (float*)fft_shm->begin_write();
+    iq_fft->get_fft_data(frame);
+    fft_shm->commit(iq_fft->fft_size() * sizeof(float), d_shm_fft_frames++,
+                    d_decim_rate);
+}
+
+/**
+ * @brief Save the I/Q history plus upcoming samples to a file.
+ * @param filename The filename where to save.
+ * @param seconds_before How much of the history to include.
+ * @param seconds_after How long to keep recording after the history.
+ * @return false if the history is disabled or the file can't be created.
+ *
+ * The history is written in the background while streaming continues. A
+ * SigMF metadata file is written next to it, like for I/Q recordings. Samples
+ * lost because the writer fell behind are logged once the snapshot is done.
+ */
+bool receiver::save_iq_snapshot(std::string filename, double seconds_before,
+                                double seconds_after)
+{
+    if (!iq_history)
+        return false;
+
+    auto done = [filename](const iq_ring_buffer::snapshot_result& result) {
+        if (result.aborted) {
+            spdlog::warn("save_iq_snapshot: {} cut short after {} samples",
+                         filename, result.nwritten);
+        }
+        if (result.nskipped > 0) {
+            spdlog::warn("save_iq_snapshot: {} is missing {} samples, the "
+                         "writer fell behind", filename, result.nskipped);
+        }
+    };
+
+    int64_t nbefore = iq_history->snapshot(
+        filename, std::max(seconds_before, 0.0) * d_decim_rate,
+        std::max(seconds_after, 0.0) * d_decim_rate, std::move(done));
+    if (nbefore < 0) {
+        spdlog::error("{}: couldn't open I/Q file ({})", __func__, filename);
+        return false;
+    }
+
+    if (!write_sigmf_meta(filename, iq_history->get_format(),
+                          nbefore / d_decim_rate)) {
+        spdlog::warn("{}: couldn't write SigMF metadata for {}", __func__,
+                     filename);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Write SigMF metadata for an I/Q recording.
+ * @param data_filename The name of the recording.
+ * @param fmt The sample format of the recording.
+ *
+ * @param time_offset How many seconds before now the recording starts.
+ *
+ * The metadata file has the same name as the recording, with the
+ * .sigmf-data extension (if any) replaced by .sigmf-meta.
+ */
+bool receiver::write_sigmf_meta(const std::string& data_filename,
+                                iq_file_sink::format fmt, double time_offset)
+{
+    static const std::string data_ext = ".sigmf-data";
+
+    std::string meta_filename = data_filename;
+    if (meta_filename.size() > data_ext.size() &&
+        meta_filename.compare(meta_filename.size() - data_ext.size(),
+                              data_ext.size(), data_ext) == 0) {
+        meta_filename.resize(meta_filename.size() - data_ext.size());
+    }
+    meta_filename += ".sigmf-meta";
+
+    std::time_t now = std::time(nullptr) - (std::time_t)time_offset;
+    std::tm utc{};
+    gmtime_r(&now, &utc);
+
+    std::ostringstream gains;
+    bool first = true;
+    for (const auto& name : get_gain_names()) {
+        gains << (first ? "" : ", ") << "\"" << name
+              << "\": " << get_gain(name);
+        first = false;
+    }
+
+    std::ofstream meta(meta_filename);
+    if (!meta)
+        return false;
+
+    meta << std::setprecision(15);
+    meta << "{\n"
+         << "    \"global\": {\n"
+         << "        \"core:datatype\": \""
+         << iq_file_sink::sigmf_datatype(fmt) << "\",\n"
+         << "        \"core:sample_rate\": " << d_decim_rate << ",\n"
+         << "        \"core:version\": \"1.0.0\",\n"
+         << "        \"core:recorder\": \"violetrx\"\n"
+         << "    },\n"
+         << "    \"captures\": [\n"
+         << "        {\n"
+         << "            \"core:sample_start\": 0,\n"
+         << "            \"core:frequency\": " << get_rf_freq() << ",\n"
+         << "            \"core:datetime\": \""
+         << std::put_time(&utc, "%Y-%m-%dT%H:%M:%SZ") << "\",\n"
+         << "            \"violetrx:gain\": {" << gains.str() << "}\n"
+         << "        }\n"
+         << "    ],\n"
+         << "    \"annotations\": []\n"
+         << "}\n";
+
+    return meta.good();
+}
+
 /**
  * @brief Seek to position in IQ file source.
  * @param pos Byte offset from the beginning of the file.
  */
 bool receiver::seek_iq_file(long pos)
 {
+    if (file_src)
+        return file_src->seek(pos);
+
     tb->lock();
     bool status = src->seek(pos, SEEK_SET);
     tb->unlock();
@@ -614,13 +936,83 @@ bool receiver::seek_iq_file(long pos)
     return status;
 }
 
+/**
+ * @brief Create the input source for a device string.
+ * @param device osmosdr device string, iqfile=... for file playback, or
+ *               testsig... for the synthetic test signal.
+ * @throws std::exception if the source can't be created.
+ *
+ * For file playback and the test signal, src is still created (over the zero
+ * file) so that the hardware controls keep working, but it isn't connected to
+ * anything.
+ */
+void receiver::make_input(const std::string& device)
+{
+    if (iq_file_source::is_device_string(device)) {
+        file_src =
+            iq_file_source::make(iq_file_source::parse_device_string(device));
+        file_src->set_eof_callback(d_eof_callback);
+
+        src = osmosdr::source::make(
+            "file=" + escape_filename(get_zero_file()) +
+            ",freq=428e6,rate=96000,repeat=true,throttle=true");
+    } else if (iq_test_source::is_device_string(device)) {
+        test_src =
+            iq_test_source::make(iq_test_source::parse_device_string(device));
+
+        src = osmosdr::source::make(
+            "file=" + escape_filename(get_zero_file()) +
+            ",freq=428e6,rate=96000,repeat=true,throttle=true");
+    } else {
+        src = osmosdr::source::make(device);
+    }
+}
+
+/** The block feeding the flow graph: the file or test signal source, or the
+ * device. */
+gr::basic_block_sptr receiver::input_block() const
+{
+    if (file_src)
+        return file_src;
+    if (test_src)
+        return test_src;
+    return src;
+}
+
+/**
+ * @brief Whether the input is a file or test signal produced as fast as
+ *        possible.
+ *
+ * The sound card would pace such an input down to real time, so the VFO
+ * channels don't output audio in this case.
+ */
+bool receiver::is_unthrottled_input() const
+{
+    return (file_src && !file_src->throttled()) ||
+           (test_src && !test_src->throttled());
+}
+
+/**
+ * @brief Set the function called when file playback reaches the end.
+ *
+ * The callback is invoked from a GNU Radio scheduler thread, after which the
+ * flow graph winds down on its own.
+ */
+void receiver::set_input_eof_callback(std::function<void()> callback)
+{
+    d_eof_callback = std::move(callback);
+
+    if (file_src)
+        file_src->set_eof_callback(d_eof_callback);
+}
+
 /** Convenience function to connect all blocks. */
 void receiver::connect_all()
 {
     gr::basic_block_sptr b;
 
     // Setup source
-    b = src;
+    b = input_block();
 
     // Pre-processing
     if (d_decim >= 2) {
@@ -636,6 +1028,10 @@ void receiver::connect_all()
     tb->connect(b, 0, iq_swap, 0);
     b = iq_swap;
 
+    // iq_swap is never replaced, unlike the source and the decimator
+    if (iq_history)
+        tb->connect(b, 0, iq_history, 0);
+
     if (d_dc_cancel) {
         tb->connect(b, 0, dc_corr, 0);
         b = dc_corr;
@@ -668,7 +1064,8 @@ vfo_channel::sptr receiver::add_vfo_channel()
     if (MAX_NUM_VFO_CHANNELS > 0 && vfo_channels.size() >= MAX_NUM_VFO_CHANNELS)
         return nullptr;
 
-    vfo_channel::sptr vfo = vfo_channel::make(ddc, vfo_channels.size());
+    vfo_channel::sptr vfo = vfo_channel::make(ddc, vfo_channels.size(),
+                                              !is_unthrottled_input());
 
     vfo->set_parent_receiver(weak_from_this());
     vfo->set_quad_rate(d_quad_rate);
@@ -734,6 +1131,20 @@ const std::vector<vfo_channel::sptr>& receiver::get_vfo_channels()
     return vfo_channels;
 }
 
+void receiver::get_perf_counters(
+    std::vector<block_perf_counters>& counters) const
+{
+    // osmosdr sources are hier blocks, so only file and test sources count
+    const gr::basic_block_sptr blocks[] = {input_block(), input_decim,
+                                           dc_corr,       iq_swap,
+                                           iq_fft,        ddc,
+                                           iq_sink,       iq_history,
+                                           iq_shm};
+
+    for (const auto& block : blocks)
+        read_perf_counters(block, counters);
+}
+
 osmosdr::devices_t receiver::get_devices() const
 {
     return osmosdr::device::find();
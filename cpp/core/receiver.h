@@ -28,6 +28,7 @@
 #include <gnuradio/blocks/null_sink.h>
 #include <gnuradio/blocks/wavfile_sink.h>
 #include <gnuradio/blocks/wavfile_source.h>
+#include <functional>
 #include <gnuradio/top_block.h>
 #include <memory>
 #include <osmosdr/device.h>
@@ -38,8 +39,14 @@
 #include "core/vfo_channel.h"
 #include "dsp/correct_iq_cc.h"
 #include "dsp/filter/fir_decim.h"
+#include "dsp/iq_file_sink.h"
+#include "dsp/iq_file_source.h"
+#include "dsp/iq_ring_buffer.h"
+#include "dsp/iq_test_source.h"
 #include "dsp/multichannel_downconverter.h"
+#include "dsp/perf_counters.h"
 #include "dsp/rx_fft.h"
+#include "dsp/shm_ring_sink.h"
 
 /**
  * @defgroup DSP Digital signal processing library based on GNU Radio
@@ -70,8 +77,11 @@ public:
 
     void start();
     void stop();
+    void wait_done();
     bool is_running();
     void set_input_device(const std::string& device);
+    void set_input_eof_callback(std::function<void()> callback);
+    bool is_file_input() const { return file_src != nullptr; }
     void set_output_device(const std::string& device);
 
     osmosdr::devices_t get_devices() const;
@@ -123,12 +133,30 @@ public:
     void get_iq_fft_data(float* fftPoints);
 
     /* I/Q recording and playback */
-    bool start_iq_recording(std::string filename);
+    bool start_iq_recording(
+        std::string filename,
+        iq_file_sink::format fmt = iq_file_sink::FORMAT_CF32);
     bool stop_iq_recording();
     bool is_iq_recording() const { return d_recording_iq; }
     const std::string& get_iq_filename() const { return iq_filename; }
+    iq_file_sink::stats get_iq_recording_stats() const;
     bool seek_iq_file(long pos);
 
+    /* I/Q history */
+    void set_iq_history(double seconds);
+    double get_iq_history() const { return d_iq_history; }
+    bool save_iq_snapshot(std::string filename, double seconds_before,
+                          double seconds_after);
+
+    /* Shared memory output */
+    bool start_shm_output(const std::string& prefix);
+    bool stop_shm_output();
+    bool is_shm_output() const { return iq_shm != nullptr; }
+    void publish_shm_fft();
+
+    /* Performance counters of the blocks outside of the VFO channels */
+    void get_perf_counters(std::vector<block_perf_counters>& counters) const;
+
     vfo_channel::sptr add_vfo_channel();
     void remove_vfo_channel(vfo_channel::sptr);
     const std::vector<vfo_channel::sptr>& get_vfo_channels();
@@ -137,10 +165,17 @@ public:
     static std::string escape_filename(std::string filename);
 
 private:
+    void make_input(const std::string& device);
+    gr::basic_block_sptr input_block() const;
+    bool is_unthrottled_input() const;
     void connect_all();
     void disconnect_vfo_channels();
     void connect_vfo_channels();
 
+    //! Write the SigMF metadata file describing the current I/Q recording
+    bool write_sigmf_meta(const std::string& data_filename,
+                          iq_file_sink::format fmt, double time_offset = 0);
+
     //! Get a path to a file containing random bytes
     static std::string get_zero_file(void);
 
@@ -157,6 +192,9 @@ private:
     bool d_iq_rev;       /*!< Whether I/Q is reversed or not. */
     bool d_dc_cancel;    /*!< Enable automatic DC removal. */
     bool d_iq_balance;   /*!< Enable automatic IQ balance. */
+    double d_iq_history; /*!< I/Q history length (s), 0 if off. */
+
+    uint64_t d_shm_fft_frames; /*!< FFT frames in shared memory so far. */
 
     std::string input_devstr;  /*!< Current input device string. */
     std::string output_devstr; /*!< Current output device string. */
@@ -165,6 +203,8 @@ private:
     gr::top_block_sptr tb; /*!< The GNU Radio top block. */
 
     osmosdr::source::sptr src;     /*!< Real time I/Q source. */
+    iq_file_source::sptr file_src; /*!< I/Q file playback source. */
+    iq_test_source::sptr test_src; /*!< Synthetic test signal source. */
     fir_decim_cc_sptr input_decim; /*!< Input decimator. */
 
     dc_corr_cc_sptr dc_corr; /*!< DC corrector block. */
@@ -174,9 +214,14 @@ private:
 
     multichannel_downconverter_cc::sptr
         ddc; /*!< Digital down-converter for demod chain. */
-    gr::blocks::file_sink::sptr iq_sink; /*!< I/Q file sink. */
+    iq_file_sink::sptr iq_sink;      /*!< I/Q file sink. */
+    iq_ring_buffer::sptr iq_history; /*!< Recent I/Q for snapshots. */
+    shm_ring_sink::sptr iq_shm;      /*!< Shared memory I/Q output. */
+    shm_ring_writer::sptr fft_shm;   /*!< Shared memory FFT frames. */
 
     std::vector<vfo_channel::sptr> vfo_channels;
+
+    std::function<void()> d_eof_callback; /*!< Called at the end of file. */
 };
 
 #endif // RECEIVER_H
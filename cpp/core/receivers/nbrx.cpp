@@ -45,6 +45,7 @@ nbrx::nbrx(float quad_rate, float audio_rate)
     filter = make_rx_filter(PREF_QUAD_RATE, -5000.0, 5000.0, 1000.0);
     agc = make_rx_agc_cc(PREF_QUAD_RATE, true, -100, 0, 0, 500, false);
     sql = gr::analog::simple_squelch_cc::make(-150.0, 0.001);
+    sql_tagger = squelch_tagger_cc::make();
     meter = make_rx_meter_c(PREF_QUAD_RATE);
     demod_raw = gr::blocks::complex_to_float::make(1);
     demod_ssb = gr::blocks::complex_to_real::make(1);
@@ -67,7 +68,9 @@ nbrx::nbrx(float quad_rate, float audio_rate)
     connect(nb, 0, filter, 0);
     connect(filter, 0, meter, 0);
     connect(filter, 0, sql, 0);
-    connect(sql, 0, agc, 0);
+    connect(sql, 0, meter, 1);
+    connect(sql, 0, sql_tagger, 0);
+    connect(sql_tagger, 0, agc, 0);
     connect(agc, 0, demod, 0);
 
     if (audio_rr0)
@@ -104,9 +107,7 @@ void nbrx::set_quad_rate(float quad_rate)
     {
         d_logger->debug("Changing NB_RX quad rate: {} -> {}", d_quad_rate, quad_rate);
         d_quad_rate = quad_rate;
-        lock();
         iq_resamp->set_rate(PREF_QUAD_RATE/d_quad_rate);
-        unlock();
     }
 }
 
@@ -125,6 +126,11 @@ float nbrx::get_signal_level()
     return meter->get_level_db();
 }
 
+void nbrx::set_signal_stats(std::shared_ptr<rx_meter_stats> stats)
+{
+    meter->set_stats(std::move(stats));
+}
+
 void nbrx::set_nb_on(int nbid, bool on)
 {
     if (nbid == 1)
@@ -151,6 +157,17 @@ void nbrx::set_sql_alpha(double alpha)
     sql->set_alpha(alpha);
 }
 
+bool nbrx::is_sql_open()
+{
+    return sql->unmuted();
+}
+
+/* Raw I/Q outputs I and Q separately, every demodulator duplicates its audio */
+bool nbrx::is_stereo()
+{
+    return d_demod == NBRX_DEMOD_NONE;
+}
+
 void nbrx::set_agc_on(bool agc_on)
 {
     agc->set_agc_on(agc_on);
@@ -314,3 +331,11 @@ void nbrx::set_amsync_pll_bw(float pll_bw)
 {
     demod_amsync->set_pll_bw(pll_bw);
 }
+
+void nbrx::get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(),
+                  {iq_resamp, filter, nb, meter, agc, sql, sql_tagger,
+                   demod_raw, demod_ssb, demod_fm, demod_am, demod_amsync,
+                   audio_rr0, audio_rr1});
+}
@@ -33,6 +33,7 @@
 #include "dsp/rx_filter.h"
 #include "dsp/rx_meter.h"
 #include "dsp/rx_agc_xx.h"
+#include "dsp/squelch_tagger_cc.h"
 #include "dsp/rx_demod_fm.h"
 #include "dsp/rx_demod_am.h"
 #include "dsp/resampler_xx.h"
@@ -65,6 +66,8 @@ public:
 public:
     nbrx(float quad_rate, float audio_rate);
     virtual ~nbrx() { };
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
 
     bool start();
     bool stop();
@@ -75,6 +78,7 @@ public:
     void set_cw_offset(double offset);
 
     float get_signal_level();
+    void set_signal_stats(std::shared_ptr<rx_meter_stats> stats);
 
     /* Noise blanker */
     bool has_nb() { return true; }
@@ -85,6 +89,9 @@ public:
     bool has_sql() { return true; }
     void set_sql_level(double level_db);
     void set_sql_alpha(double alpha);
+    bool is_sql_open();
+
+    bool is_stereo();
 
     /* AGC */
     bool has_agc() { return true; }
@@ -125,6 +132,7 @@ private:
     rx_meter_c_sptr           meter;      /*!< Signal strength. */
     rx_agc_cc_sptr            agc;        /*!< Receiver AGC. */
     gr::analog::simple_squelch_cc::sptr sql;        /*!< Squelch. */
+    squelch_tagger_cc::sptr   sql_tagger; /*!< Squelch state tags. */
     gr::blocks::complex_to_float::sptr  demod_raw;  /*!< Raw I/Q passthrough. */
     gr::blocks::complex_to_real::sptr   demod_ssb;  /*!< SSB demodulator. */
     rx_demod_fm_sptr          demod_fm;   /*!< FM demodulator. */
@@ -59,6 +59,11 @@ void receiver_base_cf::set_nb_threshold(int nbid, float threshold)
     (void) threshold;
 }
 
+void receiver_base_cf::set_signal_stats(std::shared_ptr<rx_meter_stats> stats)
+{
+    (void) stats;
+}
+
 bool receiver_base_cf::has_sql()
 {
     return false;
@@ -74,6 +79,16 @@ void receiver_base_cf::set_sql_alpha(double alpha)
     (void) alpha;
 }
 
+bool receiver_base_cf::is_sql_open()
+{
+    return true;
+}
+
+bool receiver_base_cf::is_stereo()
+{
+    return false;
+}
+
 bool receiver_base_cf::has_agc()
 {
     return false;
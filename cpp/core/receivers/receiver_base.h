@@ -25,6 +25,9 @@
 
 #include <gnuradio/hier_block2.h>
 
+#include "dsp/perf_counters.h"
+#include "dsp/rx_meter.h"
+
 class receiver_base_cf;
 
 typedef std::shared_ptr<receiver_base_cf> receiver_base_cf_sptr;
@@ -36,7 +39,8 @@ typedef std::shared_ptr<receiver_base_cf> receiver_base_cf_sptr;
  * output audio (or other kind of float data).
  *
  */
-class receiver_base_cf : public gr::hier_block2
+class receiver_base_cf : public gr::hier_block2,
+                         public perf_counters_container
 {
 
 public:
@@ -55,6 +59,8 @@ public:
     virtual void set_cw_offset(double offset) = 0;
 
     virtual float get_signal_level() = 0;
+    /* Statistics outlive the receiver, so they are owned by the caller */
+    virtual void set_signal_stats(std::shared_ptr<rx_meter_stats> stats);
 
     virtual void set_demod(int demod) = 0;
 
@@ -69,6 +75,10 @@ public:
     virtual bool has_sql();
     virtual void set_sql_level(double level_db);
     virtual void set_sql_alpha(double alpha);
+    virtual bool is_sql_open();
+
+    /* Whether the two audio outputs carry different signals */
+    virtual bool is_stereo();
 
     /* AGC */
     virtual bool has_agc();
@@ -44,6 +44,7 @@ wfmrx::wfmrx(float quad_rate, float audio_rate)
 
     filter = make_rx_filter(PREF_QUAD_RATE, -80000.0, 80000.0, 20000.0);
     sql = gr::analog::simple_squelch_cc::make(-150.0, 0.001);
+    sql_tagger = squelch_tagger_cc::make();
     meter = make_rx_meter_c(PREF_QUAD_RATE);
     demod_fm = make_rx_demod_fm(PREF_QUAD_RATE, 75000.0, 0.0);
     stereo = make_stereo_demod(PREF_QUAD_RATE, d_audio_rate, true);
@@ -61,7 +62,9 @@ wfmrx::wfmrx(float quad_rate, float audio_rate)
     connect(iq_resamp, 0, filter, 0);
     connect(filter, 0, meter, 0);
     connect(filter, 0, sql, 0);
-    connect(sql, 0, demod_fm, 0);
+    connect(sql, 0, meter, 1);
+    connect(sql, 0, sql_tagger, 0);
+    connect(sql_tagger, 0, demod_fm, 0);
     connect(demod_fm, 0, mono, 0);
     connect(mono, 0, self(), 0); // left  channel
     connect(mono, 1, self(), 1); // right channel
@@ -72,6 +75,13 @@ wfmrx::~wfmrx()
 
 }
 
+void wfmrx::get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(),
+                  {iq_resamp, filter, meter, sql, sql_tagger, demod_fm, stereo,
+                   stereo_oirt, mono, rds, rds_store, rds_decoder, rds_parser});
+}
+
 bool wfmrx::start()
 {
     d_running = true;
@@ -92,9 +102,7 @@ void wfmrx::set_quad_rate(float quad_rate)
     {
         d_logger->debug("Changing WFM RX quad rate: {} -> {}", d_quad_rate, quad_rate);
         d_quad_rate = quad_rate;
-        lock();
         iq_resamp->set_rate(PREF_QUAD_RATE/d_quad_rate);
-        unlock();
     }
 }
 
@@ -108,6 +116,11 @@ float wfmrx::get_signal_level()
     return meter->get_level_db();
 }
 
+void wfmrx::set_signal_stats(std::shared_ptr<rx_meter_stats> stats)
+{
+    meter->set_stats(std::move(stats));
+}
+
 /*
 void nbrx::set_nb_on(int nbid, bool on)
 {
@@ -136,6 +149,16 @@ void wfmrx::set_sql_alpha(double alpha)
     sql->set_alpha(alpha);
 }
 
+bool wfmrx::is_sql_open()
+{
+    return sql->unmuted();
+}
+
+bool wfmrx::is_stereo()
+{
+    return d_demod != WFMRX_DEMOD_MONO;
+}
+
 /*
 void nbrx::set_agc_on(bool agc_on)
 {
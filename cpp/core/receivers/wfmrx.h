@@ -32,6 +32,7 @@
 #include "dsp/stereo_demod.h"
 #include "dsp/resampler_xx.h"
 #include "dsp/rx_rds.h"
+#include "dsp/squelch_tagger_cc.h"
 #include "dsp/rds/decoder.h"
 #include "dsp/rds/parser.h"
 
@@ -60,6 +61,8 @@ public:
     };
     wfmrx(float quad_rate, float audio_rate);
     ~wfmrx();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
 
     bool start();
     bool stop();
@@ -70,6 +73,7 @@ public:
     void set_cw_offset(double offset) { (void)offset; }
 
     float get_signal_level();
+    void set_signal_stats(std::shared_ptr<rx_meter_stats> stats);
 
     /* Noise blanker */
     bool has_nb() { return false; }
@@ -80,6 +84,9 @@ public:
     bool has_sql() { return true; }
     void set_sql_level(double level_db);
     void set_sql_alpha(double alpha);
+    bool is_sql_open();
+
+    bool is_stereo();
 
     /* AGC */
     bool has_agc() { return false; }
@@ -115,6 +122,7 @@ private:
 
     rx_meter_c_sptr           meter;     /*!< Signal strength. */
     gr::analog::simple_squelch_cc::sptr sql;       /*!< Squelch. */
+    squelch_tagger_cc::sptr   sql_tagger; /*!< Squelch state tags. */
     rx_demod_fm_sptr          demod_fm;  /*!< FM demodulator. */
     stereo_demod_sptr         stereo;    /*!< FM stereo demodulator. */
     stereo_demod_sptr         stereo_oirt;    /*!< FM stereo oirt demodulator. */
@@ -9,15 +9,21 @@
 
 static constexpr double DEFAULT_AUDIO_GAIN = -6.0;
 
+/* Shared memory rings hold about a second at the usual rates. */
+static constexpr size_t SHM_IQ_SLOT_SIZE = 16384;
+static constexpr size_t SHM_AUDIO_SLOT_SIZE = 4096;
+static constexpr size_t SHM_NUM_SLOTS = 128;
+
 vfo_channel::sptr
 vfo_channel::make(multichannel_downconverter_cc::sptr downconverter,
-                  int ddc_idx)
+                  int ddc_idx, bool audio_output)
 {
-    return gnuradio::make_block_sptr<vfo_channel>(downconverter, ddc_idx);
+    return gnuradio::make_block_sptr<vfo_channel>(downconverter, ddc_idx,
+                                                  audio_output);
 }
 
 vfo_channel::vfo_channel(multichannel_downconverter_cc::sptr downconverter,
-                         int ddc_idx) :
+                         int ddc_idx, bool audio_output) :
     gr::hier_block2("vfo_channel",
                     gr::io_signature::make(1, 1, sizeof(gr_complex)),
                     gr::io_signature::make(0, 0, 0)),
@@ -33,18 +39,27 @@ vfo_channel::vfo_channel(multichannel_downconverter_cc::sptr downconverter,
     d_recording_wav(false),
     d_sniffer_active(false),
     d_udp_streaming(false),
-    ddc(downconverter)
+    d_audio_output(audio_output),
+    d_iq_params{},
+    d_iq_rate(0),
+    ddc(downconverter),
+    d_signal_stats(std::make_shared<rx_meter_stats>())
 {
     rx = make_nbrx(d_quad_rate, d_audio_rate);
+    rx->set_signal_stats(d_signal_stats);
     audio_gain0 = gr::blocks::multiply_const_ff::make(0);
     audio_gain1 = gr::blocks::multiply_const_ff::make(0);
     set_af_gain(DEFAULT_AUDIO_GAIN);
 
     audio_udp_sink = make_udp_sink_f();
 
-    // FIXME: customize audio device!!
-    std::string audio_device = "";
-    audio_snk = gr::audio::sink::make(d_audio_rate, audio_device, true);
+    // the sound card is opened lazily, so that channels without audio output
+    // work on machines without one
+    if (d_audio_output) {
+        // FIXME: customize audio device!!
+        std::string audio_device = "";
+        audio_snk = gr::audio::sink::make(d_audio_rate, audio_device, true);
+    }
 
     sniffer = make_sniffer_f();
 
@@ -70,6 +85,13 @@ void vfo_channel::set_quad_rate(double quad_rate)
 
     lock();
     rx->set_quad_rate(d_quad_rate);
+    if (iq_shm)
+        iq_shm->set_sample_rate(d_quad_rate);
+    if (iq_stream) {
+        disconnect_iq_stream();
+        update_iq_stream_rate();
+        connect_iq_stream();
+    }
     unlock();
 }
 
@@ -297,6 +319,10 @@ bool vfo_channel::set_demod(rx_demod demod, bool force)
     }
 
     d_demod = demod;
+
+    if (sql_recorder)
+        sql_recorder->set_stereo(rx->is_stereo());
+
     unlock();
 
     return ret;
@@ -310,6 +336,7 @@ void vfo_channel::connect_all(rx_chain type)
         if (rx->name() != "NBRX") {
             rx.reset();
             rx = make_nbrx(d_quad_rate, d_audio_rate);
+            rx->set_signal_stats(d_signal_stats);
         }
         break;
 
@@ -317,6 +344,7 @@ void vfo_channel::connect_all(rx_chain type)
         if (rx->name() != "WFMRX") {
             rx.reset();
             rx = make_wfmrx(d_quad_rate, d_audio_rate);
+            rx->set_signal_stats(d_signal_stats);
         }
         break;
 
@@ -329,22 +357,37 @@ void vfo_channel::connect_all(rx_chain type)
         connect(self(), 0, rx, 0);
         connect(rx, 0, audio_udp_sink, 0);
         connect(rx, 1, audio_udp_sink, 1);
-        connect(rx, 0, audio_gain0, 0);
-        connect(rx, 1, audio_gain1, 0);
-        connect(audio_gain0, 0, audio_snk, 0);
-        connect(audio_gain1, 0, audio_snk, 1);
+        if (d_audio_output) {
+            connect(rx, 0, audio_gain0, 0);
+            connect(rx, 1, audio_gain1, 0);
+            connect(audio_gain0, 0, audio_snk, 0);
+            connect(audio_gain1, 0, audio_snk, 1);
+        }
 
         if (d_recording_wav) {
             connect(rx, 0, wav_sink, 0);
             connect(rx, 1, wav_sink, 1);
         }
+        if (sql_recorder) {
+            connect(rx, 0, sql_recorder, 0);
+            connect(rx, 1, sql_recorder, 1);
+        }
         if (d_sniffer_active) {
             connect(rx, 0, sniffer_rr, 0);
             connect(sniffer_rr, 0, sniffer, 0);
         }
+        if (audio_shm) {
+            connect(rx, 0, audio_shm, 0);
+            connect(rx, 1, audio_shm, 1);
+        }
     } else {
         connect(self(), 0, null_sink, 0);
     }
+
+    if (iq_stream)
+        connect_iq_stream();
+    if (iq_shm)
+        connect(self(), 0, iq_shm, 0);
 }
 
 bool vfo_channel::set_af_gain(float gain_db)
@@ -359,6 +402,28 @@ bool vfo_channel::set_af_gain(float gain_db)
     return true;
 }
 
+/**
+ * @brief Enable or disable the sound card output.
+ *
+ * The sound card consumes samples in real time, and so paces the whole flow
+ * graph. Without it, the channel runs as fast as its input, while recording,
+ * UDP streaming and the sniffer keep working.
+ */
+void vfo_channel::set_audio_output(bool enabled)
+{
+    if (enabled == d_audio_output)
+        return;
+
+    if (enabled && !audio_snk) {
+        // FIXME: customize audio device!!
+        std::string audio_device = "";
+        audio_snk = gr::audio::sink::make(d_audio_rate, audio_device, true);
+    }
+
+    d_audio_output = enabled;
+    set_demod(d_demod, true);
+}
+
 bool vfo_channel::start_audio_recording(std::string filename)
 {
     if (d_recording_wav) {
@@ -372,11 +437,6 @@ bool vfo_channel::start_audio_recording(std::string filename)
         return false;
     }
 
-    if (!is_running()) {
-        d_logger->warn("Can not start audio recorder (receiver not running)");
-        return false;
-    }
-
     // if this fails, we don't want to go and crash now, do we
     try {
         wav_sink = gr::blocks::wavfile_sink::make(
@@ -423,6 +483,65 @@ bool vfo_channel::stop_audio_recording()
     return true;
 }
 
+/**
+ * @brief Start recording every transmission to its own FLAC file.
+ * @param prefix Path prefix of the files, followed by the UTC start time.
+ * @param hang_time Seconds to keep recording after the squelch closes.
+ * @param callback Called from the writer thread for every finished file.
+ */
+bool vfo_channel::start_sql_recording(
+    const std::string& prefix, double hang_time,
+    squelch_recorder::segment_callback callback)
+{
+    if (sql_recorder) {
+        d_logger->warn("Can not start squelch recorder (already recording)");
+        return false;
+    }
+
+    if (d_demod == RX_DEMOD_OFF) {
+        d_logger->warn("Can not start squelch recorder (channel is off)");
+        return false;
+    }
+
+    // the squelch state comes from the tags in the audio stream
+    auto recorder = squelch_recorder::make(prefix, (int)d_audio_rate,
+                                           hang_time, std::move(callback));
+    recorder->set_stereo(rx->is_stereo());
+
+    lock();
+    connect(rx, 0, recorder, 0);
+    connect(rx, 1, recorder, 1);
+    sql_recorder = recorder;
+    unlock();
+
+    d_logger->info("Recording transmissions to {}_*.flac", prefix);
+
+    return true;
+}
+
+/** Stop the squelch gated recorder, finishing the current file. */
+bool vfo_channel::stop_sql_recording()
+{
+    if (!sql_recorder) {
+        d_logger->error("Can not stop squelch recorder (not recording)");
+        return false;
+    }
+
+    // the recorder is left disconnected while the channel is off
+    if (d_demod != RX_DEMOD_OFF) {
+        lock();
+        disconnect(rx, 0, sql_recorder, 0);
+        disconnect(rx, 1, sql_recorder, 1);
+        unlock();
+    }
+
+    sql_recorder->close();
+    sql_recorder.reset();
+
+    d_logger->info("Squelch recorder stopped");
+    return true;
+}
+
 void vfo_channel::set_parent_receiver(std::weak_ptr<receiver> rx_)
 {
     parent_rx = rx_;
@@ -449,6 +568,13 @@ std::shared_ptr<receiver> vfo_channel::get_parent_receiver()
  */
 float vfo_channel::get_signal_pwr() const { return rx->get_signal_level(); }
 
+/**
+ * @brief Whether the squelch lets the signal through.
+ *
+ * Always true for demodulators without a squelch.
+ */
+bool vfo_channel::is_sql_open() const { return rx->is_sql_open(); }
+
 void vfo_channel::get_rds_data(std::string& outbuff, int& num)
 {
     rx->get_rds_data(outbuff, num);
@@ -484,11 +610,13 @@ bool vfo_channel::is_rds_decoder_active(void) const
 void vfo_channel::reset_rds_parser(void) { rx->reset_rds_parser(); }
 
 bool vfo_channel::start_udp_streaming(const std::string& host, int port,
-                                      bool stereo)
+                                      bool stereo, bool rtp)
 {
-    audio_udp_sink->start_streaming(host, port, stereo);
+    if (!audio_udp_sink->start_streaming(host, port, stereo, rtp))
+        return false;
+
     d_udp_streaming = true;
-    d_udp_params = {host, port, stereo};
+    d_udp_params = {host, port, stereo, rtp};
     return true;
 }
 bool vfo_channel::stop_udp_streaming()
@@ -498,13 +626,192 @@ bool vfo_channel::stop_udp_streaming()
     return true;
 }
 
+/**
+ * @brief Start streaming the I/Q of the channel, as it comes out of the
+ * downconverter.
+ * @param params Output rate, sample format and network output.
+ * @param callback Called from the scheduler thread with every packet.
+ * @return false if already streaming, or if the network output can't be set
+ * up.
+ */
+bool vfo_channel::start_iq_stream(const iq_stream_params& params,
+                                  iq_stream_sink::packet_callback callback)
+{
+    if (iq_stream) {
+        d_logger->warn("Can not start I/Q stream (already streaming)");
+        return false;
+    }
+
+    std::unique_ptr<iq_net_sink> net;
+    if (params.transport != iq_net_sink::TRANSPORT_NONE) {
+        try {
+            net = std::make_unique<iq_net_sink>(
+                params.transport, params.host, params.port,
+                iq_file_sink::sample_size(params.format));
+        } catch (std::runtime_error& e) {
+            d_logger->error("Can not start I/Q stream: {}", e.what());
+            return false;
+        }
+    }
+
+    // the network output is only destroyed once the tap is disconnected, so
+    // a raw pointer is enough
+    iq_net_sink* net_ptr = net.get();
+    auto on_packet = [net_ptr, callback = std::move(callback)](
+                         const void* data, size_t size, uint64_t offset,
+                         int rate) {
+        if (net_ptr)
+            net_ptr->send(data, size, offset);
+        if (callback)
+            callback(data, size, offset, rate);
+    };
+
+    d_iq_params = params;
+    iq_net = std::move(net);
+
+    lock();
+    iq_stream = iq_stream_sink::make(params.format, std::move(on_packet));
+    update_iq_stream_rate();
+    connect_iq_stream();
+    unlock();
+
+    d_logger->info("Started I/Q stream at {} sps", (int)d_iq_rate);
+
+    return true;
+}
+
+/** Stop streaming I/Q, disconnecting any network clients. */
+bool vfo_channel::stop_iq_stream()
+{
+    if (!iq_stream) {
+        d_logger->error("Can not stop I/Q stream (not streaming)");
+        return false;
+    }
+
+    lock();
+    disconnect_iq_stream();
+    unlock();
+
+    iq_stream.reset();
+    iq_stream_rr.reset();
+    iq_net.reset();
+
+    d_logger->info("I/Q stream stopped");
+    return true;
+}
+
+/**
+ * @brief Start writing the channel I/Q and audio to shared memory.
+ * @param prefix Name prefix of the rings, which are named prefix-iq and
+ *               prefix-audio.
+ */
+bool vfo_channel::start_shm_output(const std::string& prefix)
+{
+    if (iq_shm) {
+        d_logger->warn("Can not start shared memory output (already active)");
+        return false;
+    }
+
+    shm_ring_writer::sptr iq_ring;
+    shm_ring_writer::sptr audio_ring;
+    try {
+        iq_ring = shm_ring_writer::make(prefix + "-iq", shm_ring::KIND_IQ_CF32,
+                                        SHM_IQ_SLOT_SIZE, SHM_NUM_SLOTS);
+        audio_ring = shm_ring_writer::make(prefix + "-audio",
+                                           shm_ring::KIND_AUDIO_F32_STEREO,
+                                           SHM_AUDIO_SLOT_SIZE, SHM_NUM_SLOTS);
+    } catch (std::runtime_error& e) {
+        d_logger->error("Can not start shared memory output: {}", e.what());
+        return false;
+    }
+
+    lock();
+    iq_shm = shm_ring_sink::make(iq_ring, sizeof(gr_complex), 1, d_quad_rate);
+    connect(self(), 0, iq_shm, 0);
+
+    // the audio ring stays empty while the channel is off
+    audio_shm =
+        shm_ring_sink::make(audio_ring, sizeof(float), 2, d_audio_rate);
+    if (d_demod != RX_DEMOD_OFF) {
+        connect(rx, 0, audio_shm, 0);
+        connect(rx, 1, audio_shm, 1);
+    }
+    unlock();
+
+    d_logger->info("Writing I/Q and audio to shared memory {}-*", prefix);
+
+    return true;
+}
+
+/** Stop the shared memory output, which removes the rings. */
+bool vfo_channel::stop_shm_output()
+{
+    if (!iq_shm) {
+        d_logger->error("Can not stop shared memory output (not active)");
+        return false;
+    }
+
+    lock();
+    disconnect(self(), 0, iq_shm, 0);
+    if (d_demod != RX_DEMOD_OFF) {
+        disconnect(rx, 0, audio_shm, 0);
+        disconnect(rx, 1, audio_shm, 1);
+    }
+    unlock();
+
+    iq_shm.reset();
+    audio_shm.reset();
+
+    d_logger->info("Shared memory output stopped");
+    return true;
+}
+
+void vfo_channel::connect_iq_stream()
+{
+    if (iq_stream_rr) {
+        connect(self(), 0, iq_stream_rr, 0);
+        connect(iq_stream_rr, 0, iq_stream, 0);
+    } else {
+        connect(self(), 0, iq_stream, 0);
+    }
+}
+
+void vfo_channel::disconnect_iq_stream()
+{
+    if (iq_stream_rr) {
+        disconnect(self(), 0, iq_stream_rr, 0);
+        disconnect(iq_stream_rr, 0, iq_stream, 0);
+    } else {
+        disconnect(self(), 0, iq_stream, 0);
+    }
+}
+
+/* Resample only if the requested rate differs from the quadrature rate. */
+void vfo_channel::update_iq_stream_rate()
+{
+    const int rate =
+        d_iq_params.rate > 0 ? d_iq_params.rate : (int)d_quad_rate;
+
+    if (rate == (int)d_quad_rate)
+        iq_stream_rr.reset();
+    else if (iq_stream_rr)
+        iq_stream_rr->set_rate((float)rate / (float)d_quad_rate);
+    else
+        iq_stream_rr = make_resampler_cc((float)rate / (float)d_quad_rate);
+
+    d_iq_rate = rate;
+    iq_stream->set_rate(rate);
+}
+
 /**
  * @brief Start data sniffer.
  * @param buffsize The buffer that should be used in the sniffer.
+ * @param blocking Stall the channel instead of dropping samples when the
+ * buffer is full.
  * @return STATUS_OK if the sniffer was started, STATUS_ERROR if the sniffer is
  * already in use.
  */
-bool vfo_channel::start_sniffer(int samprate, int buffsize)
+bool vfo_channel::start_sniffer(int samprate, int buffsize, bool blocking)
 {
     if (d_sniffer_active) {
         /* sniffer already in use */
@@ -512,6 +819,7 @@ bool vfo_channel::start_sniffer(int samprate, int buffsize)
     }
 
     sniffer->set_buffer_size(buffsize);
+    sniffer->set_blocking(blocking);
     sniffer_rr = make_resampler_ff((float)samprate / (float)d_audio_rate);
     lock();
     connect(rx, 0, sniffer_rr, 0);
@@ -564,3 +872,12 @@ vfo_channel::~vfo_channel()
 {
     d_logger->debug("~vfo_channel ({})", fmt::ptr(this));
 }
+
+void vfo_channel::get_perf_blocks(
+    std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(),
+                  {null_sink, rx, iq_sink, wav_sink, sql_recorder,
+                   audio_udp_sink, sniffer, sniffer_rr, iq_stream, iq_stream_rr,
+                   iq_shm, audio_shm, audio_gain0, audio_gain1, audio_snk});
+}
@@ -7,23 +7,32 @@
 #include <gnuradio/blocks/wavfile_sink.h>
 #include <gnuradio/sync_block.h>
 
+#include "core/interfaces/iq_net_sink.h"
 #include "core/interfaces/udp_sink_f.h"
+#include "dsp/iq_stream_sink.h"
 #include "dsp/multichannel_downconverter.h"
 #include "dsp/resampler_xx.h"
+#include "dsp/shm_ring_sink.h"
 #include "dsp/sniffer_f.h"
+#include "dsp/squelch_recorder.h"
 
 #include "receivers/receiver_base.h"
 
 #include <gnuradio/audio/sink.h>
 
+#include <atomic>
+#include "dsp/perf_counters.h"
+
 class receiver;
 
-class vfo_channel : public gr::hier_block2
+class vfo_channel : public gr::hier_block2,
+                    public perf_counters_container
 {
 public:
     using sptr = std::shared_ptr<vfo_channel>;
     static vfo_channel::sptr
-    make(multichannel_downconverter_cc::sptr downconverter, int idx);
+    make(multichannel_downconverter_cc::sptr downconverter, int idx,
+         bool audio_output = true);
 
     /** Supported receiver types */
     enum rx_chain {
@@ -56,6 +65,15 @@ public:
         std::string host;
         int port;
         bool stereo;
+        bool rtp;
+    };
+
+    struct iq_stream_params {
+        int rate; /*!< Output rate, 0 for the quadrature rate. */
+        iq_file_sink::format format;
+        iq_net_sink::transport transport;
+        std::string host;
+        int port;
     };
 
     struct sniffer_params {
@@ -63,8 +81,11 @@ public:
         int buffsize;
     };
 
-    vfo_channel(multichannel_downconverter_cc::sptr downconverter, int idx);
+    vfo_channel(multichannel_downconverter_cc::sptr downconverter, int idx,
+                bool audio_output = true);
     ~vfo_channel();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
 
     void set_ddc_idx(int idx);
     int get_ddc_idx();
@@ -73,6 +94,12 @@ public:
     bool set_filter(double low, double high, filter_shape shape);
     bool set_cw_offset(double offset_hz);
     float get_signal_pwr() const;
+    bool is_sql_open() const;
+    /* Accumulated since the channel was created, readable from any thread */
+    std::shared_ptr<const rx_meter_stats> get_signal_stats() const
+    {
+        return d_signal_stats;
+    }
 
     void set_quad_rate(double quad_rate);
     int get_quad_rate();
@@ -107,6 +134,10 @@ public:
     bool set_demod(rx_demod demod, bool force = false);
     rx_demod get_demod() { return d_demod; }
 
+    /* Sound card output */
+    void set_audio_output(bool enabled);
+    bool get_audio_output() const { return d_audio_output; }
+
     /* Audio recording */
     bool set_af_gain(float gain_db);
     float get_af_gain() const { return d_af_gain; }
@@ -115,14 +146,34 @@ public:
     bool is_recording_audio() const { return d_recording_wav; }
     std::string get_recording_filename() const { return recording_filename; }
 
+    /* Squelch gated recording */
+    bool start_sql_recording(const std::string& prefix, double hang_time,
+                             squelch_recorder::segment_callback callback);
+    bool stop_sql_recording();
+    bool is_sql_recording() const { return sql_recorder != nullptr; }
+
     /* UDP streaming */
-    bool start_udp_streaming(const std::string& host, int port, bool stereo);
+    bool start_udp_streaming(const std::string& host, int port, bool stereo,
+                             bool rtp = false);
     bool stop_udp_streaming();
     bool is_udp_streaming() const { return d_udp_streaming; }
     udp_stream_params get_udp_stream_params() const { return d_udp_params; }
 
+    /* I/Q streaming */
+    bool start_iq_stream(const iq_stream_params& params,
+                         iq_stream_sink::packet_callback callback);
+    bool stop_iq_stream();
+    bool is_iq_streaming() const { return iq_stream != nullptr; }
+    iq_stream_params get_iq_stream_params() const { return d_iq_params; }
+    int get_iq_stream_rate() const { return d_iq_rate; }
+
+    /* Shared memory output */
+    bool start_shm_output(const std::string& prefix);
+    bool stop_shm_output();
+    bool is_shm_output() const { return iq_shm != nullptr; }
+
     /* sample sniffer */
-    bool start_sniffer(int samplrate, int buffsize);
+    bool start_sniffer(int samplrate, int buffsize, bool blocking = false);
     bool stop_sniffer();
     int get_sniffer_buffsize();
     void get_sniffer_data(float* outbuff, int& num);
@@ -148,6 +199,9 @@ public:
 
 protected:
     void connect_all(rx_chain type);
+    void connect_iq_stream();
+    void disconnect_iq_stream();
+    void update_iq_stream_rate();
     bool is_running();
 
 protected:
@@ -166,26 +220,39 @@ protected:
     bool d_recording_wav;
     bool d_sniffer_active;
     bool d_udp_streaming;
+    bool d_audio_output;
 
     float d_af_gain;
 
     std::string recording_filename;
     udp_stream_params d_udp_params;
+    iq_stream_params d_iq_params;
+    std::atomic<int> d_iq_rate; /*!< Actual I/Q stream rate */
     sniffer_params d_sniffer_params;
 
     gr::blocks::null_sink::sptr null_sink;
     multichannel_downconverter_cc::sptr ddc;
     receiver_base_cf_sptr rx; /*!< receiver */
+    const std::shared_ptr<rx_meter_stats>
+        d_signal_stats; /*!< Kept across receiver changes */
 
     // recording
     gr::blocks::file_sink::sptr iq_sink;     /*!< I/Q file sink */
     gr::blocks::wavfile_sink::sptr wav_sink; /*!< WAV file sink for recording */
+    squelch_recorder::sptr sql_recorder;     /*!< Squelch gated FLAC recorder */
 
     udp_sink_f_sptr
         audio_udp_sink;           /*!< UDP sink to stream audio over network */
     sniffer_f_sptr sniffer;       /*!< Sample sniffer for data decoders */
     resampler_ff_sptr sniffer_rr; /*!< Sniffer resampler */
 
+    iq_stream_sink::sptr iq_stream;      /*!< I/Q stream tap */
+    resampler_cc_sptr iq_stream_rr;      /*!< I/Q stream resampler */
+    std::unique_ptr<iq_net_sink> iq_net; /*!< Raw I/Q network output */
+
+    shm_ring_sink::sptr iq_shm;    /*!< Shared memory I/Q output */
+    shm_ring_sink::sptr audio_shm; /*!< Shared memory audio output */
+
     gr::blocks::multiply_const_ff::sptr audio_gain0; /*!< Audio gain block */
     gr::blocks::multiply_const_ff::sptr audio_gain1; /*!< Audio gain block */
 
@@ -61,6 +61,12 @@ dc_corr_cc::~dc_corr_cc()
 
 }
 
+void dc_corr_cc::get_perf_blocks(
+    std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(), {d_iir, d_sub});
+}
+
 /*! \brief Set new sample rate. */
 void dc_corr_cc::set_sample_rate(double sample_rate)
 {
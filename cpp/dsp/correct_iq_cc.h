@@ -29,6 +29,7 @@
 #include <gnuradio/filter/single_pole_iir_filter_cc.h>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/hier_block2.h>
+#include "dsp/perf_counters.h"
 
 class dc_corr_cc;
 class iq_swap_cc;
@@ -48,11 +49,14 @@ dc_corr_cc_sptr make_dc_corr_cc(double sample_rate, double tau = 1.0);
  * This block performs automatic DC offset removal using a single pole IIR
  * filter
  */
-class dc_corr_cc : public gr::hier_block2
+class dc_corr_cc : public gr::hier_block2,
+                   public perf_counters_container
 {
 public:
     dc_corr_cc(double sample_rate, double tau);
     ~dc_corr_cc();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
     void set_sample_rate(double sample_rate);
     void set_tau(double tau);
 
@@ -51,6 +51,12 @@ downconverter_cc::~downconverter_cc()
 
 }
 
+void downconverter_cc::get_perf_blocks(
+    std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(), {filt, rot});
+}
+
 void downconverter_cc::set_decim_and_samp_rate(unsigned int decim, double samp_rate)
 {
     d_samp_rate = samp_rate;
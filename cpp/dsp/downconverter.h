@@ -25,6 +25,7 @@
 #include <gnuradio/blocks/rotator_cc.h>
 #include <gnuradio/filter/freq_xlating_fir_filter.h>
 #include <gnuradio/hier_block2.h>
+#include "dsp/perf_counters.h"
 
 class downconverter_cc;
 
@@ -33,11 +34,14 @@ typedef std::shared_ptr<downconverter_cc> downconverter_cc_sptr;
 downconverter_cc_sptr
 make_downconverter_cc(unsigned int decim, double center_freq, double samp_rate);
 
-class downconverter_cc : public gr::hier_block2
+class downconverter_cc : public gr::hier_block2,
+                         public perf_counters_container
 {
 public:
     downconverter_cc(unsigned int decim, double center_freq, double samp_rate);
     ~downconverter_cc();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
     void set_decim_and_samp_rate(unsigned int decim, double samp_rate);
     void set_center_freq(double center_freq);
 
@@ -0,0 +1,386 @@
+// Microbenchmarks of the DSP blocks, fed with synthetic buffers.
+//
+// Sync blocks are driven by calling work() directly, outside of the GNU Radio
+// scheduler, so only the block itself is measured. Hierarchical blocks, and
+// blocks that consume their input through the scheduler, can't be called that
+// way: they run in a minimal flow graph (vector source -> head -> block -> null
+// sinks), and their numbers include the scheduler and the source and sinks.
+//
+// Every benchmark reports items_per_second and ns_per_sample, both counted in
+// input samples.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <gnuradio/blocks/head.h>
+#include <gnuradio/blocks/null_sink.h>
+#include <gnuradio/blocks/vector_source.h>
+#include <gnuradio/filter/fft_filter_ccc.h>
+#include <gnuradio/filter/fir_filter_blk.h>
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/top_block.h>
+
+#include "dsp/filter/fir_decim.h"
+#include "dsp/multichannel_downconverter.h"
+#include "dsp/rds/decoder.h"
+#include "dsp/rx_agc_xx.h"
+#include "dsp/rx_filter.h"
+#include "dsp/rx_meter.h"
+#include "dsp/rx_noise_blanker_cc.h"
+#include "dsp/rx_rds.h"
+#include "dsp/stereo_demod.h"
+
+/* Same rates as the narrow band and the wide band FM receivers. */
+static constexpr double NB_QUAD_RATE = 96000.0;
+static constexpr double WFM_QUAD_RATE = 240000.0;
+static constexpr double AUDIO_RATE = 48000.0;
+
+/* Samples per work() call, about what the scheduler hands out. */
+static constexpr int WORK_SIZE = 8192;
+
+/* Samples per run of a flow graph, large enough to hide its start up. */
+static constexpr int GRAPH_SIZE = 1 << 20;
+
+/* Transition width relative to the bandwidth of the soft, normal and sharp
+ * filter shapes, as vfo_channel::set_filter() sets them. */
+static constexpr std::array<double, 3> TRANS_WIDTH = {0.5, 0.2, 0.1};
+static constexpr std::array<const char*, 3> SHAPE_NAMES = {"soft", "normal",
+                                                           "sharp"};
+
+static void setThroughput(benchmark::State& state, int64_t samples)
+{
+    state.SetItemsProcessed(state.iterations() * samples);
+    // time / (samples * 1e-9) is the time per sample in ns
+    state.counters["ns_per_sample"] = benchmark::Counter(
+        samples * 1e-9, benchmark::Counter::kIsIterationInvariantRate |
+                            benchmark::Counter::kInvert);
+}
+
+/* A few tones and some noise, so that no block takes a shortcut on silence. */
+static std::vector<gr_complex> makeIq(size_t n, double samp_rate)
+{
+    static constexpr std::array<double, 3> tones = {1.5e3, -12e3, 31e3};
+
+    std::mt19937 gen{1};
+    std::normal_distribution<float> noise{0.0f, 0.05f};
+
+    std::vector<gr_complex> iq(n);
+    for (size_t i = 0; i < n; i++) {
+        gr_complex sample{noise(gen), noise(gen)};
+        for (double tone : tones) {
+            sample += 0.2f * std::polar(1.0f, float(2 * M_PI * tone * i /
+                                                    samp_rate));
+        }
+        iq[i] = sample;
+    }
+
+    return iq;
+}
+
+/* FM multiplex: L+R, the 19 kHz pilot, L-R on 38 kHz and a 57 kHz BPSK
+ * subcarrier standing in for RDS. */
+static std::vector<float> makeMpx(size_t n, double samp_rate)
+{
+    std::vector<float> mpx(n);
+    for (size_t i = 0; i < n; i++) {
+        double t = i / samp_rate;
+        double left = std::sin(2 * M_PI * 440.0 * t);
+        double right = std::sin(2 * M_PI * 1000.0 * t);
+        double rds_bit = (int(t * 1187.5) & 1) ? 1.0 : -1.0;
+
+        mpx[i] = float(0.45 * (left + right) / 2 +
+                       0.1 * std::sin(2 * M_PI * 19e3 * t) +
+                       0.45 * (left - right) / 2 *
+                           std::sin(2 * M_PI * 38e3 * t) +
+                       0.05 * rds_bit * std::sin(2 * M_PI * 57e3 * t));
+    }
+
+    return mpx;
+}
+
+/* Block of 16 information bits and its 10 bit checkword, see Annex B of the
+ * RDS standard. */
+static uint32_t rdsBlock(uint16_t info, uint16_t offset)
+{
+    static constexpr uint32_t poly = 0x5B9;
+
+    uint32_t reg = uint32_t(info) << 10;
+    for (int bit = 25; bit >= 10; bit--) {
+        if (reg & (1u << bit))
+            reg ^= poly << (bit - 10);
+    }
+
+    return (uint32_t(info) << 10) | ((reg ^ offset) & 0x3FF);
+}
+
+/* Valid 0A groups (PI and program service name), one bit per byte. */
+static std::vector<char> makeRdsBits(size_t ngroups)
+{
+    static constexpr std::array<uint16_t, 4> offsets = {0x0FC, 0x198, 0x168,
+                                                        0x1B4};
+    static constexpr char ps[] = "VIOLETRX";
+
+    std::vector<char> bits;
+    bits.reserve(ngroups * 104);
+    for (size_t g = 0; g < ngroups; g++) {
+        uint16_t segment = g % 4;
+        std::array<uint16_t, 4> group = {
+            0x1234,
+            uint16_t(0x0000 | (10 << 5) | segment),
+            0xE0CD,
+            uint16_t((ps[2 * segment] << 8) | ps[2 * segment + 1]),
+        };
+
+        for (size_t b = 0; b < group.size(); b++) {
+            uint32_t block = rdsBlock(group[b], offsets[b]);
+            for (int bit = 25; bit >= 0; bit--)
+                bits.push_back((block >> bit) & 1);
+        }
+    }
+
+    return bits;
+}
+
+/* Random bits: the decoder never syncs and searches for an offset word at
+ * every bit. */
+static std::vector<char> makeNoiseBits(size_t n)
+{
+    std::mt19937 gen{1};
+    std::bernoulli_distribution bit;
+
+    std::vector<char> bits(n);
+    for (auto& b : bits)
+        b = bit(gen);
+
+    return bits;
+}
+
+/* Calls work() of a sync block over the same input, \p decim input samples
+ * per output sample. */
+template <typename In, typename Out>
+static void benchWork(benchmark::State& state, gr::sync_block& block,
+                      const std::vector<In>& input, int noutput, int decim,
+                      int nstreams)
+{
+    std::vector<std::vector<Out>> outputs(nstreams,
+                                          std::vector<Out>(noutput));
+
+    gr_vector_const_void_star input_items{input.data()};
+    gr_vector_void_star output_items;
+    for (auto& output : outputs)
+        output_items.push_back(output.data());
+
+    for (auto _ : state) {
+        int produced = block.work(noutput, input_items, output_items);
+        benchmark::DoNotOptimize(produced);
+        benchmark::ClobberMemory();
+    }
+
+    setThroughput(state, int64_t(noutput) * decim);
+}
+
+/* Runs \p block in a flow graph, once per iteration, over the same input. */
+template <typename In>
+static void benchGraph(benchmark::State& state, gr::basic_block_sptr block,
+                       const std::vector<In>& input,
+                       const std::vector<size_t>& output_sizes)
+{
+    auto tb = gr::make_top_block("dsp_bench");
+    auto source = gr::blocks::vector_source<In>::make(input, true);
+    auto head = gr::blocks::head::make(sizeof(In), input.size());
+
+    tb->connect(source, 0, head, 0);
+    tb->connect(head, 0, block, 0);
+    for (size_t i = 0; i < output_sizes.size(); i++)
+        tb->connect(block, i, gr::blocks::null_sink::make(output_sizes[i]), 0);
+
+    for (auto _ : state) {
+        head->reset();
+        tb->run();
+    }
+
+    setThroughput(state, input.size());
+}
+
+/* Args: channels, decimation, input rate */
+static void BM_MultichannelDownconverter(benchmark::State& state)
+{
+    const int channels = state.range(0);
+    const int decim = state.range(1);
+    const double samp_rate = state.range(2);
+
+    auto ddc = multichannel_downconverter_cc::make(decim, samp_rate, channels);
+    for (int i = 0; i < channels; i++)
+        ddc->set_offset(samp_rate / 2 * (i + 1) / (channels + 1), i);
+
+    // work() filters whole FFT blocks at a time
+    int noutput = WORK_SIZE / decim;
+    noutput -= noutput % ddc->output_multiple();
+    noutput = std::max(noutput, ddc->output_multiple());
+
+    auto input = makeIq(noutput * decim, samp_rate);
+    benchWork<gr_complex, gr_complex>(state, *ddc, input, noutput, decim,
+                                      channels);
+}
+BENCHMARK(BM_MultichannelDownconverter)
+    ->ArgNames({"channels", "decim", "rate"})
+    ->ArgsProduct({{1, 4, 16}, {1}, {2400000}})
+    ->ArgsProduct({{1, 4, 16}, {8}, {2400000}})
+    ->ArgsProduct({{1, 4, 16}, {32}, {9600000}});
+
+static void BM_FirDecim(benchmark::State& state)
+{
+    auto decim = make_fir_decim_cc(state.range(0));
+    auto input = makeIq(GRAPH_SIZE, 9.6e6);
+
+    benchGraph(state, decim, input, {sizeof(gr_complex)});
+}
+BENCHMARK(BM_FirDecim)
+    ->ArgName("decim")
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(64)
+    ->Unit(benchmark::kMillisecond);
+
+/* Args: filter shape, bandwidth */
+static void BM_RxFilter(benchmark::State& state)
+{
+    const int shape = state.range(0);
+    const double width = state.range(1);
+
+    auto filter = make_rx_filter(NB_QUAD_RATE, -width / 2, width / 2,
+                                 width * TRANS_WIDTH[shape]);
+    auto input = makeIq(GRAPH_SIZE, NB_QUAD_RATE);
+
+    state.SetLabel(std::string(SHAPE_NAMES[shape]) +
+                   (filter->is_fft_filter() ? ", fft" : ", fir"));
+    benchGraph(state, filter, input, {sizeof(gr_complex)});
+}
+BENCHMARK(BM_RxFilter)
+    ->ArgNames({"shape", "width"})
+    ->ArgsProduct({{0, 1, 2}, {2800, 10000}})
+    ->Unit(benchmark::kMillisecond);
+
+/* The same taps through the FIR and the FFT filter, to check where the FFT
+ * filter starts to pay off against RX_FILTER_FFT_THRESHOLD, above which
+ * rx_filter switches to it. Args: filter shape, approximate number of taps,
+ * 0 for the FIR and 1 for the FFT filter. */
+static void BM_RxFilterCrossover(benchmark::State& state)
+{
+    const int shape = state.range(0);
+    const bool use_fft = state.range(2);
+
+    // firdes designs 53 dB * fs / (22 dB * tw) taps with its default Hamming
+    // window, pick the bandwidth of the shape that gives the wanted count
+    const double tw = 53.0 * NB_QUAD_RATE / (22.0 * state.range(1));
+    const double width = tw / TRANS_WIDTH[shape];
+    const auto taps = gr::filter::firdes::complex_band_pass(
+        1.0, NB_QUAD_RATE, -width / 2, width / 2, tw);
+
+    std::shared_ptr<gr::sync_block> filter;
+    if (use_fft)
+        filter = gr::filter::fft_filter_ccc::make(1, taps);
+    else
+        filter = gr::filter::fir_filter_ccc::make(1, taps);
+
+    // the FFT filter works on whole FFT blocks, the FIR filter reads its
+    // history before the first input sample
+    int noutput = std::max(WORK_SIZE - WORK_SIZE % filter->output_multiple(),
+                           filter->output_multiple());
+    auto input = makeIq(noutput + taps.size(), NB_QUAD_RATE);
+
+    state.SetLabel(std::string(SHAPE_NAMES[shape]) + ", " +
+                   std::to_string(taps.size()) + " taps, " +
+                   (use_fft ? "fft" : "fir"));
+    benchWork<gr_complex, gr_complex>(state, *filter, input, noutput, 1, 1);
+}
+BENCHMARK(BM_RxFilterCrossover)
+    ->ArgNames({"shape", "taps", "fft"})
+    ->ArgsProduct({{0, 1, 2},
+                   {32, 64, 128, 192, 256, 320, 384, 512, 1024},
+                   {0, 1}});
+
+/* Arg: whether the AGC is on, or the manual gain is applied. */
+static void BM_RxAgc(benchmark::State& state)
+{
+    auto agc = make_rx_agc_cc(NB_QUAD_RATE, state.range(0), -100, 0, 0, 500,
+                              false);
+    auto input = makeIq(WORK_SIZE, NB_QUAD_RATE);
+
+    benchWork<gr_complex, gr_complex>(state, *agc, input, WORK_SIZE, 1, 1);
+}
+BENCHMARK(BM_RxAgc)->ArgName("agc_on")->Arg(0)->Arg(1);
+
+/* Args: noise blanker 1, noise blanker 2 */
+static void BM_RxNoiseBlanker(benchmark::State& state)
+{
+    auto nb = make_rx_nb_cc(NB_QUAD_RATE, 3.3, 2.5);
+    nb->set_nb1_on(state.range(0));
+    nb->set_nb2_on(state.range(1));
+
+    auto input = makeIq(WORK_SIZE, NB_QUAD_RATE);
+    benchWork<gr_complex, gr_complex>(state, *nb, input, WORK_SIZE, 1, 1);
+}
+BENCHMARK(BM_RxNoiseBlanker)
+    ->ArgNames({"nb1", "nb2"})
+    ->ArgsProduct({{0, 1}, {0, 1}});
+
+static void BM_RxMeter(benchmark::State& state)
+{
+    auto meter = make_rx_meter_c(NB_QUAD_RATE);
+    auto input = makeIq(WORK_SIZE, NB_QUAD_RATE);
+
+    benchWork<gr_complex, gr_complex>(state, *meter, input, WORK_SIZE, 1, 0);
+}
+BENCHMARK(BM_RxMeter);
+
+/* Args: stereo, OIRT pilot */
+static void BM_StereoDemod(benchmark::State& state)
+{
+    auto demod = make_stereo_demod(WFM_QUAD_RATE, AUDIO_RATE, state.range(0),
+                                   state.range(1));
+    auto input = makeMpx(GRAPH_SIZE, WFM_QUAD_RATE);
+
+    benchGraph(state, demod, input, {sizeof(float), sizeof(float)});
+}
+BENCHMARK(BM_StereoDemod)
+    ->ArgNames({"stereo", "oirt"})
+    ->Args({0, 0})
+    ->Args({1, 0})
+    ->Args({1, 1})
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_RxRds(benchmark::State& state)
+{
+    auto rds = make_rx_rds(WFM_QUAD_RATE);
+    auto input = makeMpx(GRAPH_SIZE, WFM_QUAD_RATE);
+
+    benchGraph(state, rds, input, {sizeof(char)});
+}
+BENCHMARK(BM_RxRds)->Unit(benchmark::kMillisecond);
+
+/* Input samples are bits here, ns_per_sample is per bit.
+ * Args: valid groups or random bits */
+static void BM_RdsDecoder(benchmark::State& state)
+{
+    auto decoder = gr::rds::decoder::make(false, false);
+    auto input = state.range(0) ? makeRdsBits(WORK_SIZE / 104)
+                                : makeNoiseBits(WORK_SIZE / 104 * 104);
+    const int noutput = input.size();
+
+    // work() is private in decoder_impl
+    gr::sync_block& block = *decoder;
+    benchWork<char, char>(state, block, input, noutput, 1, 0);
+}
+BENCHMARK(BM_RdsDecoder)->ArgName("synced")->Arg(1)->Arg(0);
+
+BENCHMARK_MAIN();
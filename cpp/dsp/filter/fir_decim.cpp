@@ -158,3 +158,9 @@ fir_decim_cc::~fir_decim_cc()
 {
 
 }
+
+void fir_decim_cc::get_perf_blocks(
+    std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(), {fir1, fir2, fir3});
+}
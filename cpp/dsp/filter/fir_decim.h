@@ -24,6 +24,7 @@
 
 #include <gnuradio/filter/fir_filter_blk.h>
 #include <gnuradio/hier_block2.h>
+#include "dsp/perf_counters.h"
 
 class fir_decim_cc;
 
@@ -31,13 +32,16 @@ typedef std::shared_ptr<fir_decim_cc> fir_decim_cc_sptr;
 
 fir_decim_cc_sptr make_fir_decim_cc(unsigned int decim);
 
-class fir_decim_cc : public gr::hier_block2
+class fir_decim_cc : public gr::hier_block2,
+                     public perf_counters_container
 {
 public:
     fir_decim_cc(unsigned int decim);
 
 public:
     ~fir_decim_cc();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
 
 private:
     gr::filter::fir_filter_ccf::sptr fir1;
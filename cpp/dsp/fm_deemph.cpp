@@ -102,3 +102,8 @@ void fm_deemph::calculate_iir_taps(double tau)
         d_fbtaps[1] = 0.0;
     }
 }
+
+void fm_deemph::get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(), {d_deemph});
+}
@@ -25,6 +25,7 @@
 #include <gnuradio/filter/iir_filter_ffd.h>
 #include <gnuradio/hier_block2.h>
 #include <vector>
+#include "dsp/perf_counters.h"
 
 class fm_deemph;
 typedef std::shared_ptr<fm_deemph> fm_deemph_sptr;
@@ -46,12 +47,15 @@ fm_deemph_sptr make_fm_deemph(float quad_rate, double tau=50.0e-6);
  * It also provides de-emphasis with variable time constant (use 0.0 to disable).
  *
  */
-class fm_deemph : public gr::hier_block2
+class fm_deemph : public gr::hier_block2,
+                  public perf_counters_container
 {
 
 public:
     fm_deemph(float quad_rate, double tau); // FIXME: should be private
     ~fm_deemph();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
 
     void set_tau(double tau);
 
@@ -0,0 +1,281 @@
+#include "iq_file_sink.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+
+/* O_DIRECT requires the buffer address, file offset and transfer size to be
+ * aligned to the logical block size of the device. 4096 covers everything
+ * in practice. */
+static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+static_assert(iq_file_sink::BUFFER_SIZE % DIRECT_IO_ALIGNMENT == 0);
+
+iq_file_sink::sptr iq_file_sink::make(const std::string& filename, format fmt)
+{
+    return gnuradio::make_block_sptr<iq_file_sink>(filename, fmt,
+                                                   private_construction_tag{});
+}
+
+iq_file_sink::iq_file_sink(const std::string& filename, format fmt,
+                           private_construction_tag) :
+    gr::sync_block("iq_file_sink",
+                   gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                   gr::io_signature::make(0, 0, 0)),
+    d_format(fmt),
+    d_fd(-1),
+    d_direct(true),
+    d_current(nullptr),
+    d_fill(0),
+    d_discard(0),
+    d_closed(false),
+    d_stop(false),
+    d_queue_depth(0),
+    d_buffers_written(0),
+    d_buffers_dropped(0),
+    d_bytes_written(0),
+    d_write_errors(0)
+{
+    // truncated rather than appended to: the SigMF metadata written next to
+    // it only describes this recording, and O_DIRECT needs aligned offsets
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+
+    // not every file system supports O_DIRECT (tmpfs, some FUSE mounts)
+    d_fd = ::open(filename.c_str(), flags | O_DIRECT, 0644);
+    if (d_fd < 0 && errno == EINVAL) {
+        d_direct = false;
+        d_fd = ::open(filename.c_str(), flags, 0644);
+    }
+    if (d_fd < 0) {
+        throw std::runtime_error("can't open file " + filename + ": " +
+                                 std::strerror(errno));
+    }
+
+    d_pool.reserve(NUM_BUFFERS);
+    d_free.reserve(NUM_BUFFERS);
+    for (size_t i = 0; i < NUM_BUFFERS; i++) {
+        char* buf = (char*)std::aligned_alloc(DIRECT_IO_ALIGNMENT, BUFFER_SIZE);
+        if (!buf) {
+            ::close(d_fd);
+            throw std::bad_alloc();
+        }
+        d_pool.emplace_back(buf);
+        d_free.push_back(buf);
+    }
+
+    d_writer = std::thread(&iq_file_sink::writer_loop, this);
+}
+
+iq_file_sink::~iq_file_sink() { close(); }
+
+void iq_file_sink::close()
+{
+    std::lock_guard lock{d_work_mutex};
+
+    if (d_closed)
+        return;
+    d_closed = true;
+
+    if (d_current && d_fill > 0)
+        submit_current();
+
+    {
+        std::lock_guard queue_lock{d_queue_mutex};
+        d_stop = true;
+    }
+    d_queue_cond.notify_one();
+    d_writer.join();
+
+    ::close(d_fd);
+    d_fd = -1;
+}
+
+iq_file_sink::stats iq_file_sink::get_stats() const
+{
+    return stats{
+        .queue_depth = d_queue_depth,
+        .queue_capacity = NUM_BUFFERS,
+        .buffers_written = d_buffers_written,
+        .buffers_dropped = d_buffers_dropped,
+        .bytes_written = d_bytes_written,
+        .write_errors = d_write_errors,
+    };
+}
+
+size_t iq_file_sink::sample_size(format fmt)
+{
+    switch (fmt) {
+    case FORMAT_CS16:
+        return 2 * sizeof(int16_t);
+    case FORMAT_CS8:
+        return 2 * sizeof(int8_t);
+    case FORMAT_CF32:
+    default:
+        return sizeof(gr_complex);
+    }
+}
+
+const char* iq_file_sink::sigmf_datatype(format fmt)
+{
+    switch (fmt) {
+    case FORMAT_CS16:
+        return "ci16_le";
+    case FORMAT_CS8:
+        return "ci8";
+    case FORMAT_CF32:
+    default:
+        return "cf32_le";
+    }
+}
+
+void iq_file_sink::convert(format fmt, const gr_complex* in, void* out,
+                           size_t n)
+{
+    // I and Q are converted alike, so treat the input as 2n floats.
+    // The volk kernels saturate instead of wrapping around.
+    switch (fmt) {
+    case FORMAT_CS16:
+        volk_32f_s32f_convert_16i((int16_t*)out, (const float*)in, INT16_MAX,
+                                  2 * n);
+        break;
+    case FORMAT_CS8:
+        volk_32f_s32f_convert_8i((int8_t*)out, (const float*)in, INT8_MAX,
+                                 2 * n);
+        break;
+    case FORMAT_CF32:
+    default:
+        std::memcpy(out, in, n * sizeof(gr_complex));
+        break;
+    }
+}
+
+int iq_file_sink::work(int noutput_items,
+                       gr_vector_const_void_star& input_items,
+                       gr_vector_void_star& /* output_items */)
+{
+    const gr_complex* in = (const gr_complex*)input_items[0];
+    const size_t ssize = sample_size(d_format);
+
+    std::lock_guard lock{d_work_mutex};
+
+    // recording stopped, just drop the samples
+    if (d_closed)
+        return noutput_items;
+
+    int i = 0;
+    while (i < noutput_items) {
+        // skip the rest of a buffer lost to an overrun, this keeps the drops
+        // aligned to buffer boundaries
+        if (d_discard > 0) {
+            int n = std::min<size_t>(noutput_items - i, d_discard / ssize);
+            d_discard -= n * ssize;
+            i += n;
+            continue;
+        }
+
+        if (!d_current) {
+            std::unique_lock queue_lock{d_queue_mutex};
+
+            if (d_free.empty()) {
+                queue_lock.unlock();
+                d_buffers_dropped++;
+                d_discard = BUFFER_SIZE;
+                continue;
+            }
+
+            d_current = d_free.back();
+            d_free.pop_back();
+            d_fill = 0;
+        }
+
+        int n = std::min<size_t>(noutput_items - i,
+                                 (BUFFER_SIZE - d_fill) / ssize);
+        convert(d_format, in + i, d_current + d_fill, n);
+
+        d_fill += n * ssize;
+        i += n;
+
+        if (d_fill == BUFFER_SIZE)
+            submit_current();
+    }
+
+    return noutput_items;
+}
+
+/* Hand the buffer being filled over to the writer thread. */
+void iq_file_sink::submit_current()
+{
+    {
+        std::lock_guard lock{d_queue_mutex};
+        d_queue.push_back(pending{d_current, d_fill});
+        d_queue_depth = d_queue.size();
+    }
+    d_queue_cond.notify_one();
+
+    d_current = nullptr;
+    d_fill = 0;
+}
+
+void iq_file_sink::writer_loop()
+{
+    for (;;) {
+        pending buf;
+
+        {
+            std::unique_lock lock{d_queue_mutex};
+            d_queue_cond.wait(lock,
+                              [this] { return d_stop || !d_queue.empty(); });
+
+            // only exit once everything has been written
+            if (d_queue.empty())
+                return;
+
+            buf = d_queue.front();
+            d_queue.pop_front();
+            d_queue_depth = d_queue.size();
+        }
+
+        write_buffer(buf);
+
+        std::lock_guard lock{d_queue_mutex};
+        d_free.push_back(buf.data);
+    }
+}
+
+void iq_file_sink::write_buffer(const pending& buf)
+{
+    // the last buffer of a recording is usually partial, which O_DIRECT
+    // doesn't allow
+    if (d_direct && buf.size % DIRECT_IO_ALIGNMENT != 0) {
+        ::fcntl(d_fd, F_SETFL, ::fcntl(d_fd, F_GETFL) & ~O_DIRECT);
+        d_direct = false;
+    }
+
+    size_t done = 0;
+    while (done < buf.size) {
+        ssize_t ret = ::write(d_fd, buf.data + done, buf.size - done);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            // some file systems accept O_DIRECT in open() but not in write()
+            if (errno == EINVAL && d_direct) {
+                ::fcntl(d_fd, F_SETFL, ::fcntl(d_fd, F_GETFL) & ~O_DIRECT);
+                d_direct = false;
+                continue;
+            }
+            d_write_errors++;
+            return;
+        }
+        done += ret;
+    }
+
+    d_bytes_written += done;
+    d_buffers_written++;
+}
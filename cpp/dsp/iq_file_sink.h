@@ -0,0 +1,136 @@
+#ifndef VIOLETRX_DSP_IQ_FILE_SINK
+#define VIOLETRX_DSP_IQ_FILE_SINK
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+
+/*! \brief I/Q file sink with optional sample format conversion.
+ *  \ingroup DSP
+ *
+ * Writes the complex input stream as interleaved I/Q to a file, either as is
+ * (32-bit floats), or scaled and clipped to 16-bit or 8-bit signed integers,
+ * which is plenty for the 8 to 14 bit resolution of most SDRs and cuts the
+ * file size by a factor of 2 or 4. Full scale (+/-1.0) maps to the maximum
+ * integer value.
+ *
+ * The scheduler thread never touches the disk. Samples are packed into large
+ * page aligned buffers taken from a preallocated pool, and full buffers are
+ * handed to a writer thread which writes them with O_DIRECT where the file
+ * system supports it. If the disk can't keep up and the pool runs dry, whole
+ * buffers worth of samples are dropped (and counted) instead of blocking the
+ * flow graph.
+ */
+class iq_file_sink : public gr::sync_block
+{
+public:
+    using sptr = std::shared_ptr<iq_file_sink>;
+
+    enum format {
+        FORMAT_CF32 = 0, /*!< Interleaved 32-bit float. */
+        FORMAT_CS16 = 1, /*!< Interleaved 16-bit signed integer. */
+        FORMAT_CS8 = 2,  /*!< Interleaved 8-bit signed integer. */
+    };
+
+    struct stats {
+        size_t queue_depth;       /*!< Buffers waiting for the writer. */
+        size_t queue_capacity;    /*!< Number of buffers in the pool. */
+        uint64_t buffers_written; /*!< Buffers written to disk. */
+        uint64_t buffers_dropped; /*!< Buffers dropped because of overrun. */
+        uint64_t bytes_written;   /*!< Bytes written to disk. */
+        uint64_t write_errors;    /*!< Failed writes. */
+    };
+
+    static constexpr size_t BUFFER_SIZE = 4 * 1024 * 1024;
+    static constexpr size_t NUM_BUFFERS = 8;
+
+private:
+    struct private_construction_tag {
+    };
+
+public:
+    /*! \brief Create a new sink, replacing the file if it exists.
+     *  \throws std::runtime_error if the file can't be opened.
+     */
+    static sptr make(const std::string& filename, format fmt);
+
+    iq_file_sink(const std::string& filename, format fmt,
+                 private_construction_tag);
+    ~iq_file_sink() override;
+
+    int work(int noutput_items, gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override;
+
+    /*! \brief Flush the pending buffers and close the file.
+     *
+     * Blocks until the writer thread has written everything.
+     */
+    void close();
+
+    format get_format() const { return d_format; }
+    /*! \brief Read the statistics, without taking any lock. */
+    stats get_stats() const;
+
+    /*! \brief Size of one complex sample on disk. */
+    static size_t sample_size(format fmt);
+
+    /*! \brief SigMF core:datatype of the format. */
+    static const char* sigmf_datatype(format fmt);
+
+    /*! \brief Convert \p n complex samples to \p fmt. */
+    static void convert(format fmt, const gr_complex* in, void* out, size_t n);
+
+private:
+    struct pending {
+        char* data;
+        size_t size;
+    };
+
+    struct free_deleter {
+        void operator()(char* p) const { std::free(p); }
+    };
+
+    void writer_loop();
+    void write_buffer(const pending& buf);
+    void submit_current();
+
+private:
+    format d_format;
+    int d_fd;
+    bool d_direct; /*!< File was opened with O_DIRECT. */
+
+    std::vector<std::unique_ptr<char, free_deleter>> d_pool;
+
+    // scheduler thread state, guarded by d_work_mutex
+    std::mutex d_work_mutex;
+    char* d_current;  /*!< Buffer being filled, or nullptr. */
+    size_t d_fill;    /*!< Bytes used in d_current. */
+    size_t d_discard; /*!< Bytes left to drop after an overrun. */
+    bool d_closed;
+
+    // shared with the writer thread, guarded by d_queue_mutex
+    mutable std::mutex d_queue_mutex;
+    std::condition_variable d_queue_cond;
+    std::vector<char*> d_free;
+    std::deque<pending> d_queue;
+    bool d_stop;
+
+    std::atomic<size_t> d_queue_depth; /*!< d_queue.size(), for get_stats */
+    std::atomic<uint64_t> d_buffers_written;
+    std::atomic<uint64_t> d_buffers_dropped;
+    std::atomic<uint64_t> d_bytes_written;
+    std::atomic<uint64_t> d_write_errors;
+
+    std::thread d_writer;
+};
+
+#endif // VIOLETRX_DSP_IQ_FILE_SINK
@@ -0,0 +1,292 @@
+#include "iq_file_source.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+
+static iq_file_sink::format parse_format(const std::string& str)
+{
+    if (str == "cf32" || str == "cf32_le")
+        return iq_file_sink::FORMAT_CF32;
+    if (str == "cs16" || str == "ci16_le")
+        return iq_file_sink::FORMAT_CS16;
+    if (str == "cs8" || str == "ci8" || str == "ci8_le")
+        return iq_file_sink::FORMAT_CS8;
+
+    throw std::runtime_error("unsupported I/Q format " + str);
+}
+
+static bool parse_bool(const std::string& str)
+{
+    return str == "1" || str == "true" || str == "yes";
+}
+
+/* Fill in the format, rate and frequency from a SigMF metadata file. */
+static void read_sigmf_meta(const std::string& meta_filename,
+                            iq_file_source::config& conf)
+{
+    namespace pt = boost::property_tree;
+
+    pt::ptree meta;
+    try {
+        pt::read_json(meta_filename, meta);
+    } catch (const pt::json_parser_error& e) {
+        throw std::runtime_error("invalid SigMF metadata: " +
+                                 std::string(e.what()));
+    }
+
+    // SigMF keys contain ':', so use '/' as the path separator
+    using path = pt::ptree::path_type;
+
+    conf.format =
+        parse_format(meta.get<std::string>(path("global/core:datatype", '/')));
+    conf.sample_rate =
+        meta.get<double>(path("global/core:sample_rate", '/'), 0.0);
+
+    if (auto captures = meta.get_child_optional("captures")) {
+        if (!captures->empty()) {
+            conf.center_freq = captures->front().second.get<double>(
+                path("core:frequency", '/'), 0.0);
+        }
+    }
+}
+
+/* Split a device string into key=value pairs, unquoting the values. */
+static std::vector<std::pair<std::string, std::string>>
+split_device_string(const std::string& device)
+{
+    std::vector<std::pair<std::string, std::string>> args;
+    std::stringstream ss(device);
+    char c = 0;
+
+    while (ss.peek() != std::char_traits<char>::eof()) {
+        std::string key;
+        std::string value;
+
+        while (ss.get(c) && c != '=' && c != ',')
+            key += c;
+
+        if (ss && c == '=' && ss.peek() == '\'') {
+            ss.get();
+            while (ss.get(c) && c != '\'') {
+                if (c == '\\' && !ss.get(c))
+                    break;
+                value += c;
+            }
+            if (!ss)
+                throw std::runtime_error("unterminated quote in " + device);
+            if (ss.get(c) && c != ',')
+                throw std::runtime_error("unexpected text after quote in " +
+                                         device);
+        } else if (ss && c == '=') {
+            while (ss.get(c) && c != ',')
+                value += c;
+        }
+
+        args.emplace_back(std::move(key), std::move(value));
+    }
+
+    return args;
+}
+
+iq_file_source::config
+iq_file_source::parse_device_string(const std::string& device)
+{
+    if (!is_device_string(device))
+        throw std::runtime_error("not an I/Q file device string: " + device);
+
+    const auto args = split_device_string(device);
+
+    config conf;
+    conf.filename = args.front().second;
+
+    // pick up the metadata of SigMF recordings, including the ones written by
+    // receiver::start_iq_recording()
+    std::string meta_filename;
+    if (conf.filename.ends_with(".sigmf-meta")) {
+        meta_filename = conf.filename;
+        conf.filename.resize(conf.filename.size() - 11);
+        conf.filename += ".sigmf-data";
+    } else if (conf.filename.ends_with(".sigmf-data")) {
+        meta_filename = conf.filename.substr(0, conf.filename.size() - 11) +
+                        ".sigmf-meta";
+    } else {
+        meta_filename = conf.filename + ".sigmf-meta";
+    }
+
+    if (std::filesystem::exists(meta_filename))
+        read_sigmf_meta(meta_filename, conf);
+
+    for (size_t i = 1; i < args.size(); i++) {
+        const auto& [key, value] = args[i];
+
+        try {
+            if (key == "rate")
+                conf.sample_rate = std::stod(value);
+            else if (key == "freq")
+                conf.center_freq = std::stod(value);
+            else if (key == "format")
+                conf.format = parse_format(value);
+            else if (key == "throttle")
+                conf.throttle = parse_bool(value);
+            else if (key == "repeat")
+                conf.repeat = parse_bool(value);
+            else
+                throw std::runtime_error("unknown key " + key);
+        } catch (const std::logic_error&) {
+            // std::stod
+            throw std::runtime_error("invalid value for " + key + ": " +
+                                     value);
+        }
+    }
+
+    if (conf.sample_rate <= 0)
+        throw std::runtime_error("unknown sample rate for " + conf.filename);
+
+    return conf;
+}
+
+bool iq_file_source::is_device_string(const std::string& device)
+{
+    return device.starts_with(DEVICE_PREFIX);
+}
+
+std::string iq_file_source::make_device_string(const std::string& filename)
+{
+    std::stringstream ss;
+    ss << DEVICE_PREFIX << std::quoted(filename, '\'', '\\');
+    return ss.str();
+}
+
+iq_file_source::sptr iq_file_source::make(const config& conf)
+{
+    return gnuradio::make_block_sptr<iq_file_source>(
+        conf, private_construction_tag{});
+}
+
+iq_file_source::iq_file_source(const config& conf, private_construction_tag) :
+    gr::sync_block("iq_file_source", gr::io_signature::make(0, 0, 0),
+                   gr::io_signature::make(1, 1, sizeof(gr_complex))),
+    d_conf(conf),
+    d_sample_size(iq_file_sink::sample_size(conf.format)),
+    d_fd(-1),
+    d_data(nullptr),
+    d_map_size(0),
+    d_nsamples(0),
+    d_pos(0),
+    d_throttle(d_conf.sample_rate)
+{
+    d_fd = ::open(conf.filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (d_fd < 0) {
+        throw std::runtime_error("can't open file " + conf.filename + ": " +
+                                 std::strerror(errno));
+    }
+
+    struct stat st;
+    if (::fstat(d_fd, &st) < 0 || st.st_size < (off_t)d_sample_size) {
+        ::close(d_fd);
+        throw std::runtime_error("empty or unreadable file " + conf.filename);
+    }
+
+    d_map_size = st.st_size;
+    d_nsamples = d_map_size / d_sample_size;
+
+    void* data = ::mmap(nullptr, d_map_size, PROT_READ, MAP_PRIVATE, d_fd, 0);
+    if (data == MAP_FAILED) {
+        ::close(d_fd);
+        throw std::runtime_error("can't map file " + conf.filename + ": " +
+                                 std::strerror(errno));
+    }
+
+    // aggressive read ahead, and pages behind us can be dropped early
+    ::madvise(data, d_map_size, MADV_SEQUENTIAL);
+
+    d_data = (const char*)data;
+}
+
+iq_file_source::~iq_file_source()
+{
+    ::munmap((void*)d_data, d_map_size);
+    ::close(d_fd);
+}
+
+bool iq_file_source::seek(long pos)
+{
+    std::lock_guard lock{d_mutex};
+
+    if (pos < 0 || (size_t)pos / d_sample_size >= d_nsamples)
+        return false;
+
+    d_pos = pos / d_sample_size;
+    d_throttle.reset();
+
+    return true;
+}
+
+void iq_file_source::set_eof_callback(std::function<void()> callback)
+{
+    std::lock_guard lock{d_mutex};
+    d_eof_callback = std::move(callback);
+}
+
+/* The throttle starts over after the flow graph was stopped. */
+bool iq_file_source::start()
+{
+    d_throttle.reset();
+    return true;
+}
+
+int iq_file_source::work(int noutput_items,
+                         gr_vector_const_void_star& /* input_items */,
+                         gr_vector_void_star& output_items)
+{
+    float* out = (float*)output_items[0];
+
+    std::unique_lock lock{d_mutex};
+
+    if (d_pos >= d_nsamples) {
+        if (!d_conf.repeat) {
+            if (d_eof_callback)
+                d_eof_callback();
+            return WORK_DONE;
+        }
+        d_pos = 0;
+    }
+
+    int n = std::min<size_t>(noutput_items, d_nsamples - d_pos);
+    const char* in = d_data + d_pos * d_sample_size;
+
+    switch (d_conf.format) {
+    case iq_file_sink::FORMAT_CS16:
+        volk_16i_s32f_convert_32f(out, (const int16_t*)in, INT16_MAX, 2 * n);
+        break;
+    case iq_file_sink::FORMAT_CS8:
+        volk_8i_s32f_convert_32f(out, (const int8_t*)in, INT8_MAX, 2 * n);
+        break;
+    case iq_file_sink::FORMAT_CF32:
+    default:
+        std::memcpy(out, in, n * sizeof(gr_complex));
+        break;
+    }
+
+    d_pos += n;
+    lock.unlock();
+
+    if (d_conf.throttle)
+        d_throttle.wait(n);
+
+    return n;
+}
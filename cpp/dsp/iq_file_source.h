@@ -0,0 +1,105 @@
+#ifndef VIOLETRX_DSP_IQ_FILE_SOURCE
+#define VIOLETRX_DSP_IQ_FILE_SOURCE
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <gnuradio/sync_block.h>
+
+#include "iq_file_sink.h"
+#include "rate_throttle.h"
+
+/*! \brief Memory mapped I/Q file source.
+ *  \ingroup DSP
+ *
+ * Plays back raw or SigMF I/Q recordings in any of the iq_file_sink formats.
+ * The file is mapped into memory and read straight from the page cache, and
+ * by default it isn't throttled, so the flow graph runs as fast as the CPU
+ * allows, which makes it possible to process archived captures much faster
+ * than real time.
+ *
+ * At the end of the file the source either wraps around, or calls the EOF
+ * callback (from the scheduler thread) and tells the scheduler it's done.
+ */
+class iq_file_source : public gr::sync_block
+{
+public:
+    using sptr = std::shared_ptr<iq_file_source>;
+
+    struct config {
+        std::string filename;
+        iq_file_sink::format format = iq_file_sink::FORMAT_CF32;
+        double sample_rate = 0;
+        double center_freq = 0;
+        bool throttle = false;
+        bool repeat = false;
+    };
+
+    /*! \brief Prefix of the device strings handled by this source. */
+    static constexpr const char* DEVICE_PREFIX = "iqfile=";
+
+private:
+    struct private_construction_tag {
+    };
+
+public:
+    /*! \brief Create a new source.
+     *  \throws std::runtime_error if the file can't be opened or mapped.
+     */
+    static sptr make(const config& conf);
+
+    iq_file_source(const config& conf, private_construction_tag);
+    ~iq_file_source() override;
+
+    bool start() override;
+    int work(int noutput_items, gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override;
+
+    /*! \brief Whether \p device is a device string for this source. */
+    static bool is_device_string(const std::string& device);
+
+    /*! \brief Parse a device string.
+     *
+     * The format is iqfile=<path>[,key=value...], with keys rate, freq,
+     * format (cf32, cs16 or cs8), throttle and repeat. Values, such as paths
+     * with commas, can be put in single quotes, where a backslash escapes the
+     * next character. For .sigmf-meta and .sigmf-data files, the format, rate
+     * and frequency are read from the metadata, and the keys override them.
+     *
+     * \throws std::runtime_error on invalid strings or metadata.
+     */
+    static config parse_device_string(const std::string& device);
+
+    /*! \brief Device string of \p filename, quoted as needed. */
+    static std::string make_device_string(const std::string& filename);
+
+    double sample_rate() const { return d_conf.sample_rate; }
+    double center_freq() const { return d_conf.center_freq; }
+    const std::string& filename() const { return d_conf.filename; }
+    bool throttled() const { return d_conf.throttle; }
+
+    /*! \brief Seek to a byte offset from the beginning of the file. */
+    bool seek(long pos);
+
+    /*! \brief Set the function called when playback reaches the end. */
+    void set_eof_callback(std::function<void()> callback);
+
+private:
+    const config d_conf;
+    const size_t d_sample_size;
+
+    int d_fd;
+    const char* d_data; /*!< Mapped file. */
+    size_t d_map_size;  /*!< Size of the mapping, the whole file. */
+    size_t d_nsamples;  /*!< Number of samples in the file. */
+
+    std::mutex d_mutex;
+    size_t d_pos; /*!< Next sample to read. */
+    std::function<void()> d_eof_callback;
+
+    rate_throttle d_throttle;
+};
+
+#endif // VIOLETRX_DSP_IQ_FILE_SOURCE
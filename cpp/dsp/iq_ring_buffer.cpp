@@ -0,0 +1,234 @@
+#include "iq_ring_buffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include <gnuradio/io_signature.h>
+
+/* Largest number of samples copied out of the ring while holding the lock. */
+static constexpr size_t SNAPSHOT_CHUNK = 65536;
+
+/* How often the snapshot thread picks up new samples from the ring. */
+static constexpr auto SNAPSHOT_POLL_INTERVAL = std::chrono::milliseconds(100);
+
+iq_ring_buffer::sptr iq_ring_buffer::make(size_t capacity,
+                                          iq_file_sink::format fmt)
+{
+    return gnuradio::make_block_sptr<iq_ring_buffer>(
+        capacity, fmt, private_construction_tag{});
+}
+
+iq_ring_buffer::iq_ring_buffer(size_t capacity, iq_file_sink::format fmt,
+                               private_construction_tag) :
+    gr::sync_block("iq_ring_buffer",
+                   gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                   gr::io_signature::make(0, 0, 0)),
+    d_format(fmt),
+    d_sample_size(iq_file_sink::sample_size(fmt)),
+    d_ring(capacity * d_sample_size),
+    d_capacity(capacity),
+    d_written(0),
+    d_scratch(SNAPSHOT_CHUNK * d_sample_size),
+    d_stop(false)
+{
+    d_thread = std::thread(&iq_ring_buffer::snapshot_loop, this);
+}
+
+iq_ring_buffer::~iq_ring_buffer()
+{
+    {
+        std::lock_guard lock{d_mutex};
+        d_stop = true;
+    }
+    d_cond.notify_one();
+    d_thread.join();
+}
+
+void iq_ring_buffer::set_capacity(size_t capacity)
+{
+    std::lock_guard lock{d_mutex};
+
+    // the old contents are useless anyway, don't keep both rings around
+    d_ring.clear();
+    d_ring.shrink_to_fit();
+    d_ring.resize(capacity * d_sample_size);
+    d_capacity = capacity;
+    d_written = 0;
+
+    for (auto& j : d_jobs)
+        j.aborted = true;
+}
+
+size_t iq_ring_buffer::capacity() const
+{
+    std::lock_guard lock{d_mutex};
+    return d_capacity;
+}
+
+size_t iq_ring_buffer::available() const
+{
+    std::lock_guard lock{d_mutex};
+    return std::min<uint64_t>(d_written, d_capacity);
+}
+
+size_t iq_ring_buffer::active_snapshots() const
+{
+    std::lock_guard lock{d_mutex};
+    return d_jobs.size();
+}
+
+int64_t iq_ring_buffer::snapshot(const std::string& filename, size_t nbefore,
+                                 size_t nafter, snapshot_callback done)
+{
+    FILE* fp = std::fopen(filename.c_str(), "wb");
+    if (!fp)
+        return -1;
+
+    std::unique_lock lock{d_mutex};
+
+    uint64_t nhistory =
+        std::min<uint64_t>(nbefore, std::min<uint64_t>(d_written, d_capacity));
+
+    d_jobs.push_back(job{
+        .fp = fp,
+        .next = d_written - nhistory,
+        .end = d_written + nafter,
+        .nwritten = 0,
+        .nskipped = 0,
+        .aborted = false,
+        .done = std::move(done),
+    });
+
+    lock.unlock();
+    d_cond.notify_one();
+
+    return nhistory;
+}
+
+int iq_ring_buffer::work(int noutput_items,
+                         gr_vector_const_void_star& input_items,
+                         gr_vector_void_star& /* output_items */)
+{
+    const gr_complex* in = (const gr_complex*)input_items[0];
+
+    std::lock_guard lock{d_mutex};
+
+    if (d_capacity == 0)
+        return noutput_items;
+
+    // only the tail of a large block survives anyway
+    size_t skip = noutput_items > (int)d_capacity
+                      ? noutput_items - d_capacity
+                      : 0;
+    size_t n = noutput_items - skip;
+    size_t pos = (d_written + skip) % d_capacity;
+    size_t n1 = std::min(n, d_capacity - pos);
+
+    iq_file_sink::convert(d_format, in + skip,
+                          d_ring.data() + pos * d_sample_size, n1);
+    if (n1 < n) {
+        iq_file_sink::convert(d_format, in + skip + n1, d_ring.data(),
+                              n - n1);
+    }
+
+    d_written += noutput_items;
+
+    return noutput_items;
+}
+
+void iq_ring_buffer::snapshot_loop()
+{
+    std::unique_lock lock{d_mutex};
+
+    while (!d_stop) {
+        if (d_jobs.empty()) {
+            d_cond.wait(lock, [this] { return d_stop || !d_jobs.empty(); });
+            continue;
+        }
+
+        // round robin, one chunk per snapshot, so that a long snapshot
+        // doesn't let the history of the others be overwritten
+        bool progress = false;
+        for (auto it = d_jobs.begin(); it != d_jobs.end();) {
+            progress |= service(*it, lock);
+
+            if (it->aborted || it->next >= it->end) {
+                job j = std::move(*it);
+                it = d_jobs.erase(it);
+                finish(j, lock);
+            } else {
+                ++it;
+            }
+        }
+
+        // woken up early by new snapshots and by the destructor
+        if (!progress && !d_jobs.empty())
+            d_cond.wait_for(lock, SNAPSHOT_POLL_INTERVAL);
+    }
+
+    // the block is going away, save whatever is there
+    for (auto& j : d_jobs) {
+        while (service(j, lock))
+            ;
+        finish(j, lock);
+    }
+    d_jobs.clear();
+}
+
+/*
+ * Write the next chunk of a snapshot, if the ring has it. Called with the lock
+ * held, which is released while writing to the file. Returns false if there
+ * was nothing to write.
+ */
+bool iq_ring_buffer::service(job& j, std::unique_lock<std::mutex>& lock)
+{
+    if (j.aborted)
+        return false;
+
+    // we fell behind and the samples have been overwritten already
+    uint64_t oldest = d_written - std::min<uint64_t>(d_written, d_capacity);
+    if (j.next < oldest) {
+        j.nskipped += std::min(oldest, j.end) - j.next;
+        j.next = oldest;
+    }
+
+    if (j.next >= std::min(j.end, d_written))
+        return false;
+
+    size_t pos = j.next % d_capacity;
+    size_t n = std::min<uint64_t>(
+        {j.end - j.next, d_written - j.next, d_capacity - pos,
+         SNAPSHOT_CHUNK});
+
+    std::memcpy(d_scratch.data(), d_ring.data() + pos * d_sample_size,
+                n * d_sample_size);
+    j.next += n;
+    j.nwritten += n;
+
+    lock.unlock();
+    std::fwrite(d_scratch.data(), d_sample_size, n, j.fp);
+    lock.lock();
+
+    return true;
+}
+
+/*
+ * Close the file of a finished snapshot and report the result. Called with the
+ * lock held, which is released while running the callback.
+ */
+void iq_ring_buffer::finish(job& j, std::unique_lock<std::mutex>& lock)
+{
+    std::fclose(j.fp);
+    if (!j.done)
+        return;
+
+    snapshot_result result{
+        .nwritten = j.nwritten,
+        .nskipped = j.nskipped,
+        .aborted = j.aborted,
+    };
+
+    lock.unlock();
+    j.done(result);
+    lock.lock();
+}
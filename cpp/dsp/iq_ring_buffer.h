@@ -0,0 +1,116 @@
+#ifndef VIOLETRX_DSP_IQ_RING_BUFFER
+#define VIOLETRX_DSP_IQ_RING_BUFFER
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+
+#include "iq_file_sink.h"
+
+/*! \brief In-memory history of recent I/Q samples.
+ *  \ingroup DSP
+ *
+ * Keeps the last \p capacity samples in a ring, stored in a compact integer
+ * format to bound memory use, so that a recording can start in the past.
+ * snapshot() saves the history plus the samples that keep coming in for a
+ * while to a file. Snapshots are written by a background thread which reads
+ * from the ring, so the flow graph is never blocked by the disk and multiple
+ * snapshots can be in progress at the same time.
+ */
+class iq_ring_buffer : public gr::sync_block
+{
+public:
+    using sptr = std::shared_ptr<iq_ring_buffer>;
+
+    /*! \brief Outcome of a finished snapshot. */
+    struct snapshot_result {
+        uint64_t nwritten; /*!< Samples written to the file. */
+        uint64_t nskipped; /*!< Samples overwritten before they were saved. */
+        bool aborted;      /*!< Cut short by set_capacity(). */
+    };
+
+    /*! \brief Called from the snapshot thread when a snapshot is done. */
+    using snapshot_callback = std::function<void(const snapshot_result&)>;
+
+private:
+    struct private_construction_tag {
+    };
+
+public:
+    static sptr make(size_t capacity, iq_file_sink::format fmt =
+                                          iq_file_sink::FORMAT_CS16);
+
+    iq_ring_buffer(size_t capacity, iq_file_sink::format fmt,
+                   private_construction_tag);
+    ~iq_ring_buffer() override;
+
+    int work(int noutput_items, gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override;
+
+    /*! \brief Resize the ring.
+     *
+     * The history is discarded and snapshots in progress are cut short.
+     */
+    void set_capacity(size_t capacity);
+    size_t capacity() const;
+
+    /*! \brief Number of samples of history currently available. */
+    size_t available() const;
+
+    iq_file_sink::format get_format() const { return d_format; }
+
+    /*! \brief Save recent and upcoming samples to a file.
+     *  \param filename The file to write, in the format of the ring.
+     *  \param nbefore Number of samples of history to include.
+     *  \param nafter Number of upcoming samples to include.
+     *  \param done Called once the file is complete.
+     *  \returns The number of samples of history actually included (limited
+     *           by what is available), or -1 if the file can't be opened.
+     */
+    int64_t snapshot(const std::string& filename, size_t nbefore,
+                     size_t nafter, snapshot_callback done = {});
+
+    /*! \brief Number of snapshots still being written. */
+    size_t active_snapshots() const;
+
+private:
+    struct job {
+        FILE* fp;
+        uint64_t next; /*!< Next sample to write. */
+        uint64_t end;  /*!< One past the last sample to write. */
+        uint64_t nwritten;
+        uint64_t nskipped; /*!< Samples lost because we fell behind. */
+        bool aborted;
+        snapshot_callback done;
+    };
+
+    void snapshot_loop();
+    bool service(job& j, std::unique_lock<std::mutex>& lock);
+    void finish(job& j, std::unique_lock<std::mutex>& lock);
+
+private:
+    const iq_file_sink::format d_format;
+    const size_t d_sample_size;
+
+    mutable std::mutex d_mutex;
+    std::condition_variable d_cond;
+    std::vector<char> d_ring;
+    size_t d_capacity;  /*!< Ring size in samples. */
+    uint64_t d_written; /*!< Total samples written to the ring. */
+
+    std::list<job> d_jobs;
+    std::vector<char> d_scratch; /*!< Snapshot thread copy buffer. */
+    bool d_stop;
+    std::thread d_thread;
+};
+
+#endif // VIOLETRX_DSP_IQ_RING_BUFFER
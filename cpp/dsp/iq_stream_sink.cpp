@@ -0,0 +1,47 @@
+#include "iq_stream_sink.h"
+#include <algorithm>
+
+#include <gnuradio/io_signature.h>
+
+iq_stream_sink::sptr iq_stream_sink::make(format fmt, packet_callback callback)
+{
+    return gnuradio::make_block_sptr<iq_stream_sink>(
+        fmt, std::move(callback), private_construction_tag{});
+}
+
+iq_stream_sink::iq_stream_sink(format fmt, packet_callback callback,
+                               private_construction_tag) :
+    gr::sync_block("iq_stream_sink",
+                   gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                   gr::io_signature::make(0, 0, 0)),
+    d_format(fmt),
+    d_callback(std::move(callback)),
+    d_rate(0),
+    d_offset(0),
+    d_buf(MAX_PACKET_SIZE)
+{
+}
+
+int iq_stream_sink::work(int noutput_items,
+                         gr_vector_const_void_star& input_items,
+                         gr_vector_void_star& /* output_items */)
+{
+    const gr_complex* in = (const gr_complex*)input_items[0];
+
+    const size_t sample_size = iq_file_sink::sample_size(d_format);
+    const size_t packet_samples = MAX_PACKET_SIZE / sample_size;
+    const int rate = d_rate;
+
+    for (int i = 0; i < noutput_items;) {
+        size_t n = std::min<size_t>(noutput_items - i, packet_samples);
+
+        iq_file_sink::convert(d_format, in + i, d_buf.data(), n);
+        if (d_callback)
+            d_callback(d_buf.data(), n * sample_size, d_offset, rate);
+
+        i += n;
+        d_offset += n;
+    }
+
+    return noutput_items;
+}
@@ -0,0 +1,73 @@
+#ifndef VIOLETRX_DSP_IQ_STREAM_SINK
+#define VIOLETRX_DSP_IQ_STREAM_SINK
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+
+#include "dsp/iq_file_sink.h"
+
+/*! \brief Cuts a complex stream into I/Q packets for network streaming.
+ *  \ingroup DSP
+ *
+ * The input is converted to one of the iq_file_sink formats and handed to the
+ * packet callback in packets of at most MAX_PACKET_SIZE bytes, always holding
+ * whole samples. Whatever a call to work() produces is passed on right away,
+ * instead of waiting for a full packet, so the latency stays at the
+ * granularity of the scheduler even at low sample rates and small formats.
+ *
+ * The callback runs in the scheduler thread and must not block.
+ */
+class iq_stream_sink : public gr::sync_block
+{
+public:
+    using sptr = std::shared_ptr<iq_stream_sink>;
+    using format = iq_file_sink::format;
+
+    /*! \brief Receives one packet.
+     *  \param data The converted samples.
+     *  \param size Size of the packet in bytes.
+     *  \param offset Index of the first sample of the packet in the stream.
+     *  \param rate Sample rate of the stream.
+     */
+    using packet_callback = std::function<void(const void* data, size_t size,
+                                               uint64_t offset, int rate)>;
+
+    /*! \brief Largest packet size in bytes. */
+    static constexpr size_t MAX_PACKET_SIZE = 16384;
+
+private:
+    struct private_construction_tag {
+    };
+
+public:
+    static sptr make(format fmt, packet_callback callback);
+
+    iq_stream_sink(format fmt, packet_callback callback,
+                   private_construction_tag);
+
+    int work(int noutput_items, gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override;
+
+    format get_format() const { return d_format; }
+
+    /*! \brief Set the sample rate reported with the packets. */
+    void set_rate(int rate) { d_rate = rate; }
+
+    /*! \brief Number of samples streamed so far. */
+    uint64_t nsamples() const { return d_offset; }
+
+private:
+    const format d_format;
+    const packet_callback d_callback;
+
+    std::atomic<int> d_rate; /*!< Sample rate of the input. */
+    uint64_t d_offset;       /*!< Index of the next sample. */
+    std::vector<char> d_buf; /*!< Conversion buffer of one packet. */
+};
+
+#endif // VIOLETRX_DSP_IQ_STREAM_SINK
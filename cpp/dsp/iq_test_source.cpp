@@ -0,0 +1,258 @@
+#include "iq_test_source.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#include <gnuradio/io_signature.h>
+
+/* Peak frequency deviation of the fm and wfm signals. */
+static constexpr double FM_DEVIATION = 5e3;
+static constexpr double WFM_DEVIATION = 75e3;
+
+/* Modulation index of the am signals. */
+static constexpr double AM_DEPTH = 0.5;
+
+/* The noise is the same on every run, so that results are comparable. */
+static constexpr unsigned NOISE_SEED = 1;
+
+static std::vector<std::string> split(const std::string& str, char sep)
+{
+    std::vector<std::string> tokens;
+    std::stringstream ss(str);
+    std::string token;
+
+    while (std::getline(ss, token, sep))
+        tokens.push_back(token);
+
+    return tokens;
+}
+
+static iq_test_source::modulation parse_modulation(const std::string& str)
+{
+    if (str == "cw")
+        return iq_test_source::MOD_CW;
+    if (str == "am")
+        return iq_test_source::MOD_AM;
+    if (str == "fm")
+        return iq_test_source::MOD_FM;
+    if (str == "wfm")
+        return iq_test_source::MOD_WFM;
+    if (str == "usb")
+        return iq_test_source::MOD_USB;
+    if (str == "lsb")
+        return iq_test_source::MOD_LSB;
+
+    throw std::runtime_error("unknown modulation " + str);
+}
+
+/* type:offset:level[:tone[:on/period]] */
+static iq_test_source::carrier parse_carrier(const std::string& str)
+{
+    auto fields = split(str, ':');
+    if (fields.size() < 3 || fields.size() > 5)
+        throw std::runtime_error("invalid signal " + str);
+
+    iq_test_source::carrier c;
+    c.mod = parse_modulation(fields[0]);
+    c.offset = std::stod(fields[1]);
+    c.level = std::stod(fields[2]);
+
+    if (fields.size() > 3)
+        c.tone = std::stod(fields[3]);
+
+    if (fields.size() > 4) {
+        auto burst = split(fields[4], '/');
+        if (burst.size() != 2)
+            throw std::runtime_error("invalid burst " + fields[4]);
+
+        c.burst_on = std::stod(burst[0]);
+        c.burst_period = std::stod(burst[1]);
+        if (c.burst_on <= 0 || c.burst_period < c.burst_on)
+            throw std::runtime_error("invalid burst " + fields[4]);
+    }
+
+    return c;
+}
+
+iq_test_source::config
+iq_test_source::parse_device_string(const std::string& device)
+{
+    if (!is_device_string(device))
+        throw std::runtime_error("not a test signal device string: " + device);
+
+    config conf;
+    auto args = split(device, ',');
+
+    for (size_t i = 1; i < args.size(); i++) {
+        auto eq = args[i].find('=');
+        std::string key = args[i].substr(0, eq);
+        std::string value =
+            eq == std::string::npos ? "" : args[i].substr(eq + 1);
+
+        try {
+            if (key == "rate")
+                conf.sample_rate = std::stod(value);
+            else if (key == "freq")
+                conf.center_freq = std::stod(value);
+            else if (key == "noise")
+                conf.noise = std::stod(value);
+            else if (key == "throttle")
+                conf.throttle = value == "1" || value == "true";
+            else if (key == "signal")
+                conf.carriers.push_back(parse_carrier(value));
+            else
+                throw std::runtime_error("unknown key " + key);
+        } catch (const std::logic_error&) {
+            // std::stod
+            throw std::runtime_error("invalid value for " + key + ": " +
+                                     value);
+        }
+    }
+
+    if (conf.sample_rate <= 0)
+        throw std::runtime_error("invalid sample rate");
+
+    return conf;
+}
+
+bool iq_test_source::is_device_string(const std::string& device)
+{
+    return device == DEVICE_PREFIX ||
+           device.starts_with(std::string(DEVICE_PREFIX) + ",");
+}
+
+iq_test_source::sptr iq_test_source::make(const config& conf)
+{
+    return gnuradio::make_block_sptr<iq_test_source>(
+        conf, private_construction_tag{});
+}
+
+iq_test_source::iq_test_source(const config& conf, private_construction_tag) :
+    gr::sync_block("iq_test_source", gr::io_signature::make(0, 0, 0),
+                   gr::io_signature::make(1, 1, sizeof(gr_complex))),
+    d_conf(conf),
+    d_pos(0),
+    d_throttle(d_conf.sample_rate)
+{
+    generate();
+}
+
+/* Compute one period of the signal into the table. */
+void iq_test_source::generate()
+{
+    const double rate = d_conf.sample_rate;
+
+    // long bursts need a long table to repeat correctly
+    size_t len = TABLE_SIZE;
+    for (const auto& c : d_conf.carriers) {
+        if (c.burst_period > 0)
+            len = std::max<size_t>(len, std::llround(c.burst_period * rate));
+    }
+    len = std::min(len, MAX_TABLE_SIZE);
+
+    d_table.assign(len, gr_complex(0, 0));
+
+    // frequencies become an integer number of cycles per table, and phases
+    // are computed exactly from that, so the table loops seamlessly
+    auto cycles = [&](double freq) {
+        int64_t k = std::llround(freq * len / rate) % (int64_t)len;
+        return (uint64_t)(k < 0 ? k + (int64_t)len : k);
+    };
+    auto phase = [len](uint64_t k, size_t n) {
+        return 2.0 * M_PI * (double)((k * n) % len) / (double)len;
+    };
+
+    for (const auto& c : d_conf.carriers) {
+        const double amp = std::pow(10.0, c.level / 20.0);
+        const uint64_t kc = cycles(c.offset);
+        const uint64_t km = cycles(c.tone);
+        const double tone = (double)km * rate / len;
+
+        double beta = 0;
+        if (km != 0 && c.mod == MOD_FM)
+            beta = FM_DEVIATION / tone;
+        else if (km != 0 && c.mod == MOD_WFM)
+            beta = WFM_DEVIATION / tone;
+
+        // bursts repeat a whole number of times per table
+        size_t period = 0;
+        size_t on = 0;
+        if (c.burst_period > 0) {
+            size_t nbursts = std::max<int64_t>(
+                1, std::llround(len / (c.burst_period * rate)));
+            period = len / nbursts;
+            on = std::llround(c.burst_on / c.burst_period * period);
+        }
+
+        for (size_t n = 0; n < len; n++) {
+            if (period > 0 && n % period >= on)
+                continue;
+
+            switch (c.mod) {
+            case MOD_AM:
+                d_table[n] += std::polar(
+                    (float)(amp * (1.0 + AM_DEPTH * std::cos(phase(km, n)))),
+                    (float)phase(kc, n));
+                break;
+            case MOD_FM:
+            case MOD_WFM:
+                d_table[n] += std::polar(
+                    (float)amp,
+                    (float)(phase(kc, n) + beta * std::sin(phase(km, n))));
+                break;
+            case MOD_USB:
+                d_table[n] += std::polar((float)amp, (float)phase(kc + km, n));
+                break;
+            case MOD_LSB:
+                d_table[n] +=
+                    std::polar((float)amp, (float)phase(kc + len - km, n));
+                break;
+            case MOD_CW:
+            default:
+                d_table[n] += std::polar((float)amp, (float)phase(kc, n));
+                break;
+            }
+        }
+    }
+
+    // the power is split between I and Q
+    std::mt19937 gen(NOISE_SEED);
+    std::normal_distribution<float> noise(
+        0.0f, (float)std::sqrt(std::pow(10.0, d_conf.noise / 10.0) / 2.0));
+
+    for (auto& s : d_table)
+        s += gr_complex(noise(gen), noise(gen));
+}
+
+/* The throttle starts over after the flow graph was stopped. */
+bool iq_test_source::start()
+{
+    d_throttle.reset();
+    return true;
+}
+
+int iq_test_source::work(int noutput_items,
+                         gr_vector_const_void_star& /* input_items */,
+                         gr_vector_void_star& output_items)
+{
+    gr_complex* out = (gr_complex*)output_items[0];
+
+    int i = 0;
+    while (i < noutput_items) {
+        size_t n = std::min<size_t>(noutput_items - i, d_table.size() - d_pos);
+        std::memcpy(out + i, d_table.data() + d_pos, n * sizeof(gr_complex));
+
+        i += n;
+        d_pos += n;
+        if (d_pos == d_table.size())
+            d_pos = 0;
+    }
+
+    if (d_conf.throttle)
+        d_throttle.wait(noutput_items);
+
+    return noutput_items;
+}
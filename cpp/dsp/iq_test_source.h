@@ -0,0 +1,98 @@
+#ifndef VIOLETRX_DSP_IQ_TEST_SOURCE
+#define VIOLETRX_DSP_IQ_TEST_SOURCE
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+
+#include "rate_throttle.h"
+
+/*! \brief Synthetic multi-signal I/Q source.
+ *  \ingroup DSP
+ *
+ * Generates a configurable mix of modulated carriers over a noise floor, for
+ * load testing without hardware. The whole signal is computed once into a
+ * table which is then played back in a loop, so the source costs little more
+ * than a memcpy at any sample rate. To make the loop seamless, frequencies
+ * are rounded to multiples of rate / table size, and burst periods to
+ * divisors of the table size.
+ */
+class iq_test_source : public gr::sync_block
+{
+public:
+    using sptr = std::shared_ptr<iq_test_source>;
+
+    enum modulation { MOD_CW, MOD_AM, MOD_FM, MOD_WFM, MOD_USB, MOD_LSB };
+
+    struct carrier {
+        modulation mod = MOD_CW;
+        double offset = 0;       /*!< Offset from the center in Hz. */
+        double level = -30;      /*!< Carrier level in dBFS. */
+        double tone = 1000;      /*!< Modulating tone in Hz. */
+        double burst_on = 0;     /*!< Burst length in s, 0 for continuous. */
+        double burst_period = 0; /*!< Burst repetition period in s. */
+    };
+
+    struct config {
+        double sample_rate = 2e6;
+        double center_freq = 100e6;
+        double noise = -80; /*!< Noise floor in dBFS. */
+        bool throttle = false;
+        std::vector<carrier> carriers;
+    };
+
+    /*! \brief Device string of this source, optionally followed by keys. */
+    static constexpr const char* DEVICE_PREFIX = "testsig";
+
+    /*! \brief Default table size in samples. */
+    static constexpr size_t TABLE_SIZE = 1 << 20;
+
+    /*! \brief Largest table size in samples, reached with long bursts. */
+    static constexpr size_t MAX_TABLE_SIZE = 1 << 24;
+
+private:
+    struct private_construction_tag {
+    };
+
+public:
+    static sptr make(const config& conf);
+
+    iq_test_source(const config& conf, private_construction_tag);
+
+    bool start() override;
+    int work(int noutput_items, gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override;
+
+    /*! \brief Whether \p device is a device string for this source. */
+    static bool is_device_string(const std::string& device);
+
+    /*! \brief Parse a device string.
+     *
+     * The format is testsig[,key=value...], with keys rate, freq, noise,
+     * throttle and signal. signal can be repeated, and its value is
+     * type:offset:level[:tone[:on/period]], where type is one of cw, am,
+     * fm, wfm, usb or lsb, and on/period describe bursts in seconds.
+     *
+     * \throws std::runtime_error on invalid strings.
+     */
+    static config parse_device_string(const std::string& device);
+
+    double sample_rate() const { return d_conf.sample_rate; }
+    double center_freq() const { return d_conf.center_freq; }
+    bool throttled() const { return d_conf.throttle; }
+
+private:
+    void generate();
+
+private:
+    const config d_conf;
+
+    std::vector<gr_complex> d_table; /*!< One period of the signal. */
+    size_t d_pos;                    /*!< Next sample to output. */
+
+    rate_throttle d_throttle;
+};
+
+#endif // VIOLETRX_DSP_IQ_TEST_SOURCE
@@ -24,6 +24,7 @@
 #include <gnuradio/io_signature.h>
 #include <gnuradio/filter/firdes.h>
 #include "dsp/lpf.h"
+#include "dsp/taps_cache.h"
 
 static const int MIN_IN  = 1; /* Minimum number of input streams. */
 static const int MAX_IN  = 1; /* Maximum number of input streams. */
@@ -53,8 +54,8 @@ lpf_ff::lpf_ff(double sample_rate, double cutoff_freq,
     d_gain(gain)
 {
     /* generate taps */
-    d_taps = gr::filter::firdes::low_pass(d_gain, d_sample_rate,
-                                 d_cutoff_freq, d_trans_width);
+    d_taps = *taps_cache::instance().low_pass(d_gain, d_sample_rate,
+                                              d_cutoff_freq, d_trans_width);
 
     /* create low-pass filter (decimation=1) */
     lpf = gr::filter::fir_filter_fff::make(1, d_taps);
@@ -70,6 +71,11 @@ lpf_ff::~lpf_ff()
 
 }
 
+void lpf_ff::get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(), {lpf});
+}
+
 
 void lpf_ff::set_param(double cutoff_freq, double trans_width)
 {
@@ -77,8 +83,8 @@ void lpf_ff::set_param(double cutoff_freq, double trans_width)
     d_trans_width = trans_width;
 
     /* generate new taps */
-    d_taps = gr::filter::firdes::low_pass(d_gain, d_sample_rate,
-                                 d_cutoff_freq, d_trans_width);
+    d_taps = *taps_cache::instance().low_pass(d_gain, d_sample_rate,
+                                              d_cutoff_freq, d_trans_width);
 
     lpf->set_taps(d_taps);
 }
@@ -26,6 +26,7 @@
 #include <gnuradio/hier_block2.h>
 #include <gnuradio/filter/firdes.h>
 #include <gnuradio/filter/fir_filter_blk.h>
+#include "dsp/perf_counters.h"
 
 
 class lpf_ff;
@@ -59,13 +60,16 @@ lpf_ff_sptr make_lpf_ff(double sample_rate=48000.,
  * performed by the accessors (though the taps generator from gr::filter::firdes does perform
  * some sanity checks and throws std::out_of_range in case of bad parameter).
  */
-class lpf_ff : public gr::hier_block2
+class lpf_ff : public gr::hier_block2,
+               public perf_counters_container
 {
 public:
     lpf_ff(double sample_rate, double cutoff_freq,
            double trans_width, double gain);
 
     ~lpf_ff();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
 
     void set_param(double cutoff_freq, double trans_width);
 
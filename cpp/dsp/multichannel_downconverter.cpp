@@ -4,6 +4,7 @@
 #include <gnuradio/sync_decimator.h>
 
 #include "dsp/multichannel_downconverter.h"
+#include "dsp/taps_cache.h"
 
 #define LPF_CUTOFF 120e3
 
@@ -46,10 +47,10 @@ void multichannel_downconverter_cc::set_decim_and_samp_rate(int decim,
     if (d_decim > 1) {
         // init d_proto_taps
         double out_rate = d_samp_rate / decimation();
-        d_proto_taps = gr::filter::firdes::low_pass(
+        d_proto_taps = taps_cache::instance().low_pass(
             1.0, d_samp_rate, LPF_CUTOFF, out_rate - 2 * LPF_CUTOFF);
 
-        compute_sizes(d_proto_taps.size());
+        compute_sizes(d_proto_taps->size());
     }
 
     for (auto& channel_data : d_channels_data) {
@@ -63,39 +64,21 @@ void multichannel_downconverter_cc::build_composite_taps(size_t idx)
     float fwT0 = 2 * GR_M_PI * channel_data.offset / d_samp_rate;
 
     if (d_decim > 1) {
-        // initialize taps
-        d_composite_taps.resize(d_proto_taps.size());
-
-        for (size_t i = 0; i < d_proto_taps.size(); i++) {
-            d_composite_taps[i] =
-                d_proto_taps[i] * exp(gr_complex(0, i * fwT0));
-        }
-
         // initialize tail
         volk::vector<gr_complex>& tail = channel_data.tail;
         tail.resize(tailsize());
         std::fill(tail.begin(), tail.end(), 0);
 
-        gr_complex* in = d_fwdfft->get_inbuf();
-        gr_complex* out = d_fwdfft->get_outbuf();
-
-        float scale = 1.0 / d_fftsize;
-
-        // Compute forward xform of taps.
-        // Copy taps into first ntaps slots, then pad with zeros
-        for (int i = 0; i < d_ntaps; i++)
-            in[i] = d_composite_taps[i] * scale;
-
-        for (int i = d_ntaps; i < d_fftsize; i++)
-            in[i] = 0;
-
-        d_fwdfft->execute(); // do the xform
+        // forward xform of the taps shifted to the channel offset, which is
+        // shared with every other channel at the same offset and rate
+        double out_rate = d_samp_rate / decimation();
+        auto xformed_taps = taps_cache::instance().xformed_low_pass(
+            1.0, d_samp_rate, LPF_CUTOFF, out_rate - 2 * LPF_CUTOFF,
+            channel_data.offset, d_fftsize);
 
         // now copy output to d_xformed_taps
-        channel_data.xformed_taps.resize(d_fftsize);
-        for (int i = 0; i < d_fftsize; i++) {
-            channel_data.xformed_taps[i] = out[i];
-        }
+        channel_data.xformed_taps.assign(xformed_taps->begin(),
+                                         xformed_taps->end());
     }
 
     gr::blocks::rotator& rot = channel_data.rotator;
@@ -109,7 +92,8 @@ void multichannel_downconverter_cc::build_composite_taps(size_t idx)
     phase /= std::abs(phase);
     float delta_freq = channel_data.offset - channel_data.prev_offset;
     float delta_omega = 2.0 * GR_M_PI * delta_freq / d_samp_rate;
-    float delta_phase = -delta_omega * (d_proto_taps.size() - 1) / 2.0;
+    float delay = d_proto_taps ? (d_proto_taps->size() - 1) / 2.0 : 0.0;
+    float delta_phase = -delta_omega * delay;
     phase *= exp(gr_complex(0, delta_phase));
     rot.set_phase(phase);
     channel_data.prev_offset = channel_data.offset;
@@ -8,6 +8,8 @@
 #include <gnuradio/hier_block2.h>
 #include <gnuradio/sync_decimator.h>
 
+#include "dsp/taps_cache.h"
+
 class multichannel_downconverter_cc : public gr::sync_decimator
 {
 public:
@@ -54,8 +56,7 @@ private:
     unsigned int d_decim;
     double d_samp_rate;
 
-    std::vector<float> d_proto_taps;
-    std::vector<gr_complex> d_composite_taps;
+    taps_cache::taps_sptr<float> d_proto_taps;
 
     std::vector<channel_data> d_channels_data;
 
@@ -0,0 +1,56 @@
+#include "perf_counters.h"
+#include <numeric>
+
+#include <gnuradio/block.h>
+#include <gnuradio/block_detail.h>
+#include <gnuradio/high_res_timer.h>
+#include <gnuradio/prefs.h>
+
+static double average(const std::vector<float>& values)
+{
+    if (values.empty())
+        return 0.0;
+
+    return std::accumulate(values.begin(), values.end(), 0.0) /
+           values.size();
+}
+
+void enable_perf_counters()
+{
+    gr::prefs::singleton()->set_bool("PerfCounters", "on", true);
+}
+
+void read_perf_counters(const gr::basic_block_sptr& block,
+                        std::vector<block_perf_counters>& counters)
+{
+    if (!block)
+        return;
+
+    if (auto container =
+            std::dynamic_pointer_cast<perf_counters_container>(block)) {
+        std::vector<gr::basic_block_sptr> blocks;
+        container->get_perf_blocks(blocks);
+
+        for (const auto& b : blocks)
+            read_perf_counters(b, counters);
+        return;
+    }
+
+    auto leaf = std::dynamic_pointer_cast<gr::block>(block);
+
+    // a block that never ran has no detail, and no counters
+    if (!leaf || !leaf->detail())
+        return;
+
+    // work times are counted in ticks of the high resolution timer
+    const double tps = (double)gr::high_res_timer_tps();
+
+    counters.push_back(block_perf_counters{
+        .name = leaf->alias(),
+        .work_time_avg = leaf->pc_work_time_avg() / tps,
+        .work_time_total = leaf->pc_work_time_total() / tps,
+        .nproduced_avg = leaf->pc_nproduced_avg(),
+        .input_buffers_full = average(leaf->pc_input_buffers_full_avg()),
+        .output_buffers_full = average(leaf->pc_output_buffers_full_avg()),
+    });
+}
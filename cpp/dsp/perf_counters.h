@@ -0,0 +1,48 @@
+#ifndef VIOLETRX_DSP_PERF_COUNTERS
+#define VIOLETRX_DSP_PERF_COUNTERS
+
+#include <string>
+#include <vector>
+
+#include <gnuradio/basic_block.h>
+
+/*! \brief GNU Radio performance counters of a single block. */
+struct block_perf_counters {
+    std::string name;           /*!< Block alias, e.g. fft_filter_ccc(42). */
+    double work_time_avg;       /*!< Average time spent in work(), in s. */
+    double work_time_total;     /*!< Total time spent in work(), in s. */
+    double nproduced_avg;       /*!< Average items produced by work(). */
+    double input_buffers_full;  /*!< Average fullness of the inputs, 0..1. */
+    double output_buffers_full; /*!< Average fullness of the outputs, 0..1. */
+};
+
+/*! \brief Implemented by hier blocks to list the blocks they are made of.
+ *
+ * GNU Radio gives no access to the blocks inside a hier block, so every hier
+ * block lists its own. Blocks that are not connected at the moment may be
+ * listed too, they are skipped if they never ran.
+ */
+class perf_counters_container
+{
+public:
+    virtual ~perf_counters_container() = default;
+
+    virtual void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const = 0;
+};
+
+/*! \brief Turn on the performance counters of GNU Radio.
+ *
+ * The counters are only kept by blocks started after this call.
+ */
+void enable_perf_counters();
+
+/*! \brief Append the counters of a block.
+ *
+ * Hier blocks are walked down to their leaf blocks. Null blocks are ignored,
+ * so members that were never created can be listed as they are.
+ */
+void read_perf_counters(const gr::basic_block_sptr& block,
+                        std::vector<block_perf_counters>& counters);
+
+#endif // VIOLETRX_DSP_PERF_COUNTERS
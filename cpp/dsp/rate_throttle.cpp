@@ -0,0 +1,34 @@
+#include "rate_throttle.h"
+#include <algorithm>
+#include <thread>
+
+rate_throttle::rate_throttle(double sample_rate) :
+    d_sample_rate(sample_rate),
+    d_restart(true),
+    d_nproduced(0)
+{
+}
+
+/* Sleep until the wall clock catches up with the samples produced so far. */
+void rate_throttle::wait(int nitems)
+{
+    using namespace std::chrono;
+
+    if (d_restart.exchange(false)) {
+        d_start = steady_clock::now();
+        d_nproduced = 0;
+    }
+
+    d_nproduced += nitems;
+
+    auto expected =
+        d_start + duration_cast<steady_clock::duration>(
+                      duration<double>(d_nproduced / d_sample_rate));
+
+    // cap the sleep so that stopping the flow graph isn't delayed, the next
+    // call catches up
+    auto now = steady_clock::now();
+    if (expected > now)
+        std::this_thread::sleep_for(
+            std::min<steady_clock::duration>(expected - now, 100ms));
+}
@@ -0,0 +1,38 @@
+#ifndef VIOLETRX_DSP_RATE_THROTTLE
+#define VIOLETRX_DSP_RATE_THROTTLE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/*! \brief Paces a source block to a sample rate.
+ *  \ingroup DSP
+ *
+ * Sources that don't come from hardware call wait() from work() with the
+ * number of items produced, and it sleeps until the wall clock catches up with
+ * the samples produced so far. The clock starts with the first call, and
+ * again with the first call after reset().
+ */
+class rate_throttle
+{
+public:
+    explicit rate_throttle(double sample_rate);
+
+    void wait(int nitems);
+
+    /*! \brief Restart the clock, after the source was paused or seeked.
+     *
+     * Can be called from any thread.
+     */
+    void reset() { d_restart = true; }
+
+private:
+    const double d_sample_rate;
+
+    std::atomic<bool> d_restart;
+
+    std::chrono::steady_clock::time_point d_start;
+    uint64_t d_nproduced;
+};
+
+#endif // VIOLETRX_DSP_RATE_THROTTLE
@@ -20,10 +20,134 @@
 
 #include "decoder_impl.h"
 #include "constants.h"
+#include <array>
 #include <gnuradio/io_signature.h>
 
 using namespace gr::rds;
 
+namespace {
+
+const unsigned int syndrome_poly = 0x5B9;
+const unsigned int syndrome_plen = 10;
+
+/* multiply a syndrome by x modulo the generator polynomial */
+constexpr unsigned int syndrome_mul_x(unsigned int reg) {
+	reg <<= 1;
+	if (reg & (1 << syndrome_plen)) reg ^= syndrome_poly;
+	return reg;
+}
+
+/* syndrome_table[v] is the syndrome of the 8-bit message v, i.e.
+ * v(x) * x^10 mod g(x) */
+constexpr std::array<unsigned short, 256> make_syndrome_table() {
+	std::array<unsigned short, 256> table{};
+	unsigned int bit_syndrome = 1;
+	for (unsigned int i = 0; i < syndrome_plen; i++)
+		bit_syndrome = syndrome_mul_x(bit_syndrome);
+	for (unsigned int bit = 0; bit < 8; bit++) {
+		for (unsigned int v = 0; v < 256; v++)
+			if (v & (1 << bit)) table[v] ^= bit_syndrome;
+		bit_syndrome = syndrome_mul_x(bit_syndrome);
+	}
+	return table;
+}
+
+constexpr auto syndrome_table = make_syndrome_table();
+
+/* contribution of a bit entering the 26-bit register (x^10), and of the
+ * bit leaving it (x^36) */
+constexpr unsigned int syndrome_bit_in = syndrome_table[1];
+constexpr unsigned int syndrome_bit_out = [] {
+	unsigned int reg = syndrome_bit_in;
+	for (int i = 0; i < 26; i++) reg = syndrome_mul_x(reg);
+	return reg;
+}();
+
+/* offset_table[s] is the offset word (index into syndrome[]) whose syndrome
+ * is s, or -1 if there is none */
+constexpr std::array<signed char, 1 << syndrome_plen> make_offset_table() {
+	std::array<signed char, 1 << syndrome_plen> table{};
+	for (auto& entry : table) entry = -1;
+	for (int j = 4; j >= 0; j--) table[syndrome[j]] = j;
+	return table;
+}
+
+constexpr auto offset_table = make_offset_table();
+
+/* the message is processed a byte at a time, starting with the leading
+ * (mlen % 8) bits */
+constexpr unsigned int table_syndrome(unsigned long message,
+		unsigned char mlen) {
+	unsigned int reg = 0;
+	int shift = mlen - (mlen % 8 ? mlen % 8 : 8);
+
+	reg = syndrome_table[(message >> shift) & ((1 << (mlen - shift)) - 1)];
+	for (shift -= 8; shift >= 0; shift -= 8) {
+		reg = syndrome_table[((reg >> (syndrome_plen - 8)) ^ (message >> shift)) & 0xff]
+			^ ((reg << 8) & ((1 << syndrome_plen) - 1));
+	}
+	return reg;
+}
+
+/* syndrome of the last 26 bits after shifting bit into reg, given the
+ * syndrome before the shift */
+constexpr unsigned int slide_syndrome(unsigned int reg_syndrome,
+		unsigned long reg, bool bit) {
+	reg_syndrome = syndrome_mul_x(reg_syndrome);
+	if (bit) reg_syndrome ^= syndrome_bit_in;
+	if ((reg >> 25) & 0x01) reg_syndrome ^= syndrome_bit_out;
+	return reg_syndrome;
+}
+
+/* the original bit at a time implementation, kept as a reference */
+constexpr unsigned int bitwise_syndrome(unsigned long message,
+		unsigned char mlen) {
+	unsigned long reg = 0;
+	unsigned int i = 0;
+
+	for (i = mlen; i > 0; i--)  {
+		reg = (reg << 1) | ((message >> (i-1)) & 0x01);
+		if (reg & (1 << syndrome_plen)) reg = reg ^ syndrome_poly;
+	}
+	for (i = syndrome_plen; i > 0; i--) {
+		reg = reg << 1;
+		if (reg & (1<<syndrome_plen)) reg = reg ^ syndrome_poly;
+	}
+	return (reg & ((1<<syndrome_plen)-1));
+}
+
+/* the table-driven syndromes must match the reference. Both are linear in
+ * the message, so checking every single-bit message covers all of them. */
+constexpr bool check_table_syndrome() {
+	for (unsigned char mlen : {16, 26})
+		for (unsigned int bit = 0; bit < mlen; bit++)
+			if (table_syndrome(1ul << bit, mlen) !=
+					bitwise_syndrome(1ul << bit, mlen))
+				return false;
+	return true;
+}
+
+/* the sliding syndrome over a pseudo-random bitstream */
+constexpr bool check_slide_syndrome() {
+	unsigned long reg = 0;
+	unsigned int reg_syndrome = 0;
+	unsigned int lfsr = 0xACE1;
+	for (int i = 0; i < 1000; i++) {
+		bool bit = lfsr & 1;
+		lfsr = (lfsr >> 1) ^ (bit ? 0xB400 : 0);
+		reg_syndrome = slide_syndrome(reg_syndrome, reg, bit);
+		reg = (reg << 1) | bit;
+		if (reg_syndrome != bitwise_syndrome(reg & 0x3ffffff, 26)) return false;
+		if (table_syndrome(reg & 0x3ffffff, 26) != reg_syndrome) return false;
+	}
+	return true;
+}
+
+static_assert(check_table_syndrome());
+static_assert(check_slide_syndrome());
+
+} // namespace
+
 decoder::sptr
 decoder::make(bool log, bool debug) {
   return gnuradio::make_block_sptr<decoder_impl>(log, debug);
@@ -33,6 +157,8 @@ decoder_impl::decoder_impl(bool log, bool debug)
 	: gr::sync_block ("gr_rds_decoder",
 			gr::io_signature::make (1, 1, sizeof(char)),
 			gr::io_signature::make (0, 0, 0)),
+	reg(0),
+	reg_syndrome(0),
 	log(log),
 	debug(debug)
 {
@@ -64,20 +190,7 @@ void decoder_impl::enter_sync(unsigned int sync_block_number) {
 /* see Annex B, page 64 of the standard */
 unsigned int decoder_impl::calc_syndrome(unsigned long message,
 		unsigned char mlen) {
-	unsigned long reg = 0;
-	unsigned int i;
-	const unsigned long poly = 0x5B9;
-	const unsigned char plen = 10;
-
-	for (i = mlen; i > 0; i--)  {
-		reg = (reg << 1) | ((message >> (i-1)) & 0x01);
-		if (reg & (1 << plen)) reg = reg ^ poly;
-	}
-	for (i = plen; i > 0; i--) {
-		reg = reg << 1;
-		if (reg & (1<<plen)) reg = reg ^ poly;
-	}
-	return (reg & ((1<<plen)-1));	// select the bottom plen bits of reg
+	return table_syndrome(message, mlen);
 }
 
 void decoder_impl::decode_group(unsigned int *group) {
@@ -122,35 +235,35 @@ int decoder_impl::work (int noutput_items,
 	int i=0,j;
 	unsigned long bit_distance, block_distance;
 	unsigned int block_calculated_crc, block_received_crc, checkword,dataword;
-	unsigned int reg_syndrome;
 	unsigned char offset_char('x');  // x = error while decoding the word offset
 
 /* the synchronization process is described in Annex C, page 66 of the standard */
 	while (i<noutput_items) {
+		/* slide the syndrome along with the register instead of
+		 * recomputing it from the last 26 bits */
+		reg_syndrome = slide_syndrome(reg_syndrome, reg, in[i]);
+
 		reg=(reg<<1)|in[i];		// reg contains the last 26 rds bits
 		switch (d_state) {
 			case NO_SYNC:
-				reg_syndrome = calc_syndrome(reg,26);
-				for (j=0;j<5;j++) {
-					if (reg_syndrome==syndrome[j]) {
-						if (!presync) {
-							lastseen_offset=j;
-							lastseen_offset_counter=bit_counter;
-							presync=true;
-						}
+				j = offset_table[reg_syndrome];
+				if (j >= 0) {
+					if (!presync) {
+						lastseen_offset=j;
+						lastseen_offset_counter=bit_counter;
+						presync=true;
+					}
+					else {
+						bit_distance=bit_counter-lastseen_offset_counter;
+						if (offset_pos[lastseen_offset]>=offset_pos[j])
+							block_distance=offset_pos[j]+4-offset_pos[lastseen_offset];
+						else
+							block_distance=offset_pos[j]-offset_pos[lastseen_offset];
+						if ((block_distance*26)!=bit_distance) presync=false;
 						else {
-							bit_distance=bit_counter-lastseen_offset_counter;
-							if (offset_pos[lastseen_offset]>=offset_pos[j])
-								block_distance=offset_pos[j]+4-offset_pos[lastseen_offset];
-							else
-								block_distance=offset_pos[j]-offset_pos[lastseen_offset];
-							if ((block_distance*26)!=bit_distance) presync=false;
-							else {
-								lout << "@@@@@ Sync State Detected" << std::endl;
-								enter_sync(j);
-							}
+							lout << "@@@@@ Sync State Detected" << std::endl;
+							enter_sync(j);
 						}
-					break; //syndrome found, no more cycles
 					}
 				}
 			break;
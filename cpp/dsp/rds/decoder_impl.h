@@ -36,11 +36,12 @@ private:
 
 	void enter_no_sync();
 	void enter_sync(unsigned int);
-	unsigned int calc_syndrome(unsigned long, unsigned char);
+	static unsigned int calc_syndrome(unsigned long, unsigned char);
 	void decode_group(unsigned int*);
 
 	unsigned long  bit_counter;
 	unsigned long  lastseen_offset_counter, reg;
+	unsigned int   reg_syndrome;  // syndrome of the last 26 bits in reg
 	unsigned int   block_bit_counter;
 	unsigned int   wrong_blocks_counter;
 	unsigned int   blocks_counter;
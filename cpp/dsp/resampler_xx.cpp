@@ -24,6 +24,7 @@
 #include <gnuradio/io_signature.h>
 #include <gnuradio/filter/firdes.h>
 #include "dsp/resampler_xx.h"
+#include "dsp/taps_cache.h"
 
 
 /* Create a new instance of resampler_cc and return
@@ -53,7 +54,7 @@ resampler_cc::resampler_cc(float rate)
     double trans_width = rate > 1.0f ? 0.2 : 0.2*(double)rate;
     unsigned int flt_size = 32;
 
-    d_taps = gr::filter::firdes::low_pass(flt_size, flt_size, cutoff, trans_width);
+    d_taps = *taps_cache::instance().low_pass(flt_size, flt_size, cutoff, trans_width);
 
     /* create the filter */
     d_filter = gr::filter::pfb_arb_resampler_ccf::make(rate, d_taps, flt_size);
@@ -68,23 +69,24 @@ resampler_cc::~resampler_cc()
 
 }
 
+void resampler_cc::get_perf_blocks(
+    std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(), {d_filter});
+}
+
 void resampler_cc::set_rate(float rate)
 {
     /* generate taps */
     double cutoff = rate > 1.0f ? 0.4 : 0.4*(double)rate;
     double trans_width = rate > 1.0f ? 0.2 : 0.2*(double)rate;
     unsigned int flt_size = 32;
-    d_taps = gr::filter::firdes::low_pass(flt_size, flt_size, cutoff, trans_width);
+    d_taps = *taps_cache::instance().low_pass(flt_size, flt_size, cutoff, trans_width);
 
-    /* FIXME: Should implement set_taps() in PFB */
-    lock();
-    disconnect(self(), 0, d_filter, 0);
-    disconnect(d_filter, 0, self(), 0);
-    d_filter.reset();
-    d_filter = gr::filter::pfb_arb_resampler_ccf::make(rate, d_taps, flt_size);
-    connect(self(), 0, d_filter, 0);
-    connect(d_filter, 0, self(), 0);
-    unlock();
+    /* The PFB swaps taps and rate under its own mutex between two calls to
+       work(), so there is no need to reconfigure the flowgraph. */
+    d_filter->set_taps(d_taps);
+    d_filter->set_rate(rate);
 }
 
 /* Create a new instance of resampler_ff and return
@@ -114,7 +116,7 @@ resampler_ff::resampler_ff(float rate)
     double trans_width = rate > 1.0f ? 0.2 : 0.2*(double)rate;
     unsigned int flt_size = 32;
 
-    d_taps = gr::filter::firdes::low_pass(flt_size, flt_size, cutoff, trans_width);
+    d_taps = *taps_cache::instance().low_pass(flt_size, flt_size, cutoff, trans_width);
 
     /* create the filter */
     d_filter = gr::filter::pfb_arb_resampler_fff::make(rate, d_taps, flt_size);
@@ -129,21 +131,21 @@ resampler_ff::~resampler_ff()
 
 }
 
+void resampler_ff::get_perf_blocks(
+    std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(), {d_filter});
+}
+
 void resampler_ff::set_rate(float rate)
 {
     /* generate taps */
     double cutoff = rate > 1.0f ? 0.4 : 0.4*(double)rate;
     double trans_width = rate > 1.0f ? 0.2 : 0.2*(double)rate;
     unsigned int flt_size = 32;
-    d_taps = gr::filter::firdes::low_pass(flt_size, flt_size, cutoff, trans_width);
+    d_taps = *taps_cache::instance().low_pass(flt_size, flt_size, cutoff, trans_width);
 
-    /* FIXME: Should implement set_taps() in PFB */
-    lock();
-    disconnect(self(), 0, d_filter, 0);
-    disconnect(d_filter, 0, self(), 0);
-    d_filter.reset();
-    d_filter = gr::filter::pfb_arb_resampler_fff::make(rate, d_taps, flt_size);
-    connect(self(), 0, d_filter, 0);
-    connect(d_filter, 0, self(), 0);
-    unlock();
+    /* retarget in place, see resampler_cc::set_rate() */
+    d_filter->set_taps(d_taps);
+    d_filter->set_rate(rate);
 }
@@ -26,6 +26,7 @@
 #include <gnuradio/hier_block2.h>
 #include <gnuradio/filter/pfb_arb_resampler_ccf.h>
 #include <gnuradio/filter/pfb_arb_resampler_fff.h>
+#include "dsp/perf_counters.h"
 
 
 class resampler_cc;
@@ -47,13 +48,18 @@ resampler_cc_sptr make_resampler_cc(float rate);
  * This block is a convenience wrapper around gr_pfb_arb_resampler_ccf. It takes care
  * of generating filter taps that can be used for the filter, as well as calculating
  * the other required parameters.
+ *
+ * set_rate() retargets the resampler in place, without reconnecting anything.
  */
-class resampler_cc : public gr::hier_block2
+class resampler_cc : public gr::hier_block2,
+                     public perf_counters_container
 {
 
 public:
     resampler_cc(float rate); // FIXME: should be private
     ~resampler_cc();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
 
     void set_rate(float rate);
 
@@ -77,13 +83,18 @@ resampler_ff_sptr make_resampler_ff(float rate);
  * This block is a convenience wrapper around gr_pfb_arb_resampler_fff. It takes care
  * of generating filter taps that can be used for the filter, as well as calculating
  * the other required parameters.
+ *
+ * set_rate() retargets the resampler in place, without reconnecting anything.
  */
-class resampler_ff : public gr::hier_block2
+class resampler_ff : public gr::hier_block2,
+                     public perf_counters_container
 {
 
 public:
     resampler_ff(float rate); // FIXME: should be private
     ~resampler_ff();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
 
     void set_rate(float rate);
 
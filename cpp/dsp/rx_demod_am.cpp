@@ -191,3 +191,15 @@ void rx_demod_amsync::set_pll_bw(float pll_bw)
     d_demod1->set_loop_bandwidth(pll_bw);
     d_demod1->update_gains();
 }
+
+void rx_demod_am::get_perf_blocks(
+    std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(), {d_demod, d_dcr});
+}
+
+void rx_demod_amsync::get_perf_blocks(
+    std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(), {d_demod1, d_demod2, d_dcr});
+}
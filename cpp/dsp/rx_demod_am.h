@@ -30,6 +30,7 @@
 #include <gnuradio/analog/pll_carriertracking_cc.h>
 #include <gnuradio/filter/iir_filter_ffd.h>
 #include <vector>
+#include "dsp/perf_counters.h"
 
 class rx_demod_am;
 class rx_demod_amsync;
@@ -53,12 +54,15 @@ rx_demod_am_sptr make_rx_demod_am(float quad_rate, bool dcr=true);
  * This block implements an optional IIR DC-removal filter for the demodulated signal.
  *
  */
-class rx_demod_am : public gr::hier_block2
+class rx_demod_am : public gr::hier_block2,
+                    public perf_counters_container
 {
 
 public:
     rx_demod_am(float quad_rate, bool dcr=true); // FIXME: could be private
     ~rx_demod_am();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
 
     void set_dcr(bool dcr);
 
@@ -96,12 +100,15 @@ rx_demod_amsync_sptr make_rx_demod_amsync(float quad_rate, bool dcr=true, float
  * This block implements an optional IIR DC-removal filter for the demodulated signal.
  *
  */
-class rx_demod_amsync : public gr::hier_block2
+class rx_demod_amsync : public gr::hier_block2,
+                        public perf_counters_container
 {
 
 public:
     rx_demod_amsync(float quad_rate, bool dcr=true, float pll_bw=0.001); // FIXME: could be private
     ~rx_demod_amsync();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
 
     void set_dcr(bool dcr);
     void set_pll_bw(float pll_bw);
@@ -100,3 +100,9 @@ void rx_demod_fm::set_tau(double tau)
 {
     d_deemph->set_tau(tau);
 }
+
+void rx_demod_fm::get_perf_blocks(
+    std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(), {d_quad, d_deemph});
+}
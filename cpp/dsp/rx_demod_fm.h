@@ -26,6 +26,7 @@
 #include <gnuradio/hier_block2.h>
 #include <vector>
 #include "dsp/fm_deemph.h"
+#include "dsp/perf_counters.h"
 
 class rx_demod_fm;
 typedef std::shared_ptr<rx_demod_fm> rx_demod_fm_sptr;
@@ -48,12 +49,15 @@ rx_demod_fm_sptr make_rx_demod_fm(float quad_rate, float max_dev=5000.0, double
  * It also provides de-emphasis with variable time constant (use 0.0 to disable).
  *
  */
-class rx_demod_fm : public gr::hier_block2
+class rx_demod_fm : public gr::hier_block2,
+                    public perf_counters_container
 {
 
 public:
     rx_demod_fm(float quad_rate, float max_dev, double tau); // FIXME: should be private
     ~rx_demod_fm();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
 
     void set_max_dev(float max_dev);
     void set_tau(double tau);
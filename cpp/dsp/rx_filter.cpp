@@ -25,6 +25,7 @@
 #include <gnuradio/filter/firdes.h>
 #include <iostream>
 #include "dsp/rx_filter.h"
+#include "dsp/taps_cache.h"
 
 static const int MIN_IN = 1;  /* Minimum number of input streams. */
 static const int MAX_IN = 1;  /* Maximum number of input streams. */
@@ -57,14 +58,22 @@ rx_filter::rx_filter(double sample_rate, double low, double high, double trans_w
         d_high = 0.95*sample_rate/2.0;
 
     /* generate taps */
-    d_taps = gr::filter::firdes::complex_band_pass(1.0, d_sample_rate, d_low, d_high, d_trans_width);
+    d_taps = *taps_cache::instance().complex_band_pass(1.0, d_sample_rate, d_low, d_high, d_trans_width);
+    d_use_fft = d_taps.size() > RX_FILTER_FFT_THRESHOLD;
 
     /* create band pass filter */
-    d_bpf = gr::filter::fir_filter_ccc::make(1, d_taps);
-
-    /* connect filter */
-    connect(self(), 0, d_bpf, 0);
-    connect(d_bpf, 0, self(), 0);
+    if (d_use_fft)
+    {
+        d_fft_bpf = gr::filter::fft_filter_ccc::make(1, d_taps);
+        connect(self(), 0, d_fft_bpf, 0);
+        connect(d_fft_bpf, 0, self(), 0);
+    }
+    else
+    {
+        d_bpf = gr::filter::fir_filter_ccc::make(1, d_taps);
+        connect(self(), 0, d_bpf, 0);
+        connect(d_bpf, 0, self(), 0);
+    }
 }
 
 rx_filter::~rx_filter ()
@@ -84,15 +93,73 @@ void rx_filter::set_param(double low, double high, double trans_width)
         d_high = 0.95*d_sample_rate/2.0;
 
     /* generate new taps */
-    d_taps = gr::filter::firdes::complex_band_pass(1.0, d_sample_rate,
-                                                   d_low + d_cw_offset,
-                                                   d_high + d_cw_offset,
-                                                   d_trans_width);
+    d_taps = *taps_cache::instance().complex_band_pass(1.0, d_sample_rate,
+                                                       d_low + d_cw_offset,
+                                                       d_high + d_cw_offset,
+                                                       d_trans_width);
 
     d_logger->debug("Generating taps for new filter   LO: {}  HI: {}  TW: {}  Taps: {}", d_low
              , d_high, d_trans_width, d_taps.size());
 
-    d_bpf->set_taps(d_taps);
+    update_taps();
+}
+
+/*
+ * Load the current taps into the active filter, swapping between the
+ * time-domain and the FFT filter if the tap count crossed the threshold.
+ * The filter not in use is kept around so that dragging the filter edge
+ * back and forth across the threshold does not recreate blocks (or FFTW
+ * plans) every time.
+ */
+void rx_filter::update_taps()
+{
+    bool use_fft = d_taps.size() > RX_FILTER_FFT_THRESHOLD;
+
+    if (use_fft == d_use_fft)
+    {
+        if (d_use_fft)
+            d_fft_bpf->set_taps(d_taps);
+        else
+            d_bpf->set_taps(d_taps);
+        return;
+    }
+
+    d_logger->debug("Switching to {} filter", use_fft ? "FFT" : "FIR");
+
+    lock();
+    if (d_use_fft)
+    {
+        disconnect(self(), 0, d_fft_bpf, 0);
+        disconnect(d_fft_bpf, 0, self(), 0);
+    }
+    else
+    {
+        disconnect(self(), 0, d_bpf, 0);
+        disconnect(d_bpf, 0, self(), 0);
+    }
+
+    if (use_fft)
+    {
+        if (d_fft_bpf)
+            d_fft_bpf->set_taps(d_taps);
+        else
+            d_fft_bpf = gr::filter::fft_filter_ccc::make(1, d_taps);
+
+        connect(self(), 0, d_fft_bpf, 0);
+        connect(d_fft_bpf, 0, self(), 0);
+    }
+    else
+    {
+        if (d_bpf)
+            d_bpf->set_taps(d_taps);
+        else
+            d_bpf = gr::filter::fir_filter_ccc::make(1, d_taps);
+
+        connect(self(), 0, d_bpf, 0);
+        connect(d_bpf, 0, self(), 0);
+    }
+    d_use_fft = use_fft;
+    unlock();
 }
 
 
@@ -128,7 +195,7 @@ rx_xlating_filter::rx_xlating_filter(double sample_rate, double center, double l
       d_trans_width(trans_width)
 {
     /* generate taps */
-    d_taps = gr::filter::firdes::complex_band_pass(1.0, d_sample_rate, -d_high, -d_low, d_trans_width);
+    d_taps = *taps_cache::instance().complex_band_pass(1.0, d_sample_rate, -d_high, -d_low, d_trans_width);
 
     /* create band pass filter */
     d_bpf = gr::filter::freq_xlating_fir_filter_ccc::make(1, d_taps, d_center, d_sample_rate);
@@ -144,6 +211,12 @@ rx_xlating_filter::~rx_xlating_filter()
 
 }
 
+void rx_xlating_filter::get_perf_blocks(
+    std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(), {d_bpf});
+}
+
 
 void rx_xlating_filter::set_offset(double center)
 {
@@ -163,7 +236,7 @@ void rx_xlating_filter::set_param(double low, double high, double trans_width)
     d_high        = high;
 
     /* generate new taps */
-    d_taps = gr::filter::firdes::complex_band_pass(1.0, d_sample_rate, -d_high, -d_low, d_trans_width);
+    d_taps = *taps_cache::instance().complex_band_pass(1.0, d_sample_rate, -d_high, -d_low, d_trans_width);
 
     d_bpf->set_taps(d_taps);
 }
@@ -174,3 +247,8 @@ void rx_xlating_filter::set_param(double center, double low, double high, double
     set_offset(center);
     set_param(low, high, trans_width);
 }
+
+void rx_filter::get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(), {d_bpf, d_fft_bpf});
+}
@@ -24,11 +24,14 @@
 #define RX_FILTER_H
 
 #include <gnuradio/hier_block2.h>
+#include <gnuradio/filter/fft_filter_ccc.h>
 #include <gnuradio/filter/fir_filter_blk.h>
 #include <gnuradio/filter/freq_xlating_fir_filter.h>
+#include "dsp/perf_counters.h"
 
 
 #define RX_FILTER_MIN_WIDTH 100  /*! Minimum width of filter */
+#define RX_FILTER_FFT_THRESHOLD 256  /*! Tap count above which the FFT filter is used */
 
 class rx_filter;
 class rx_xlating_filter;
@@ -62,21 +65,37 @@ rx_filter_sptr make_rx_filter(double sample_rate,
  * performed by the accessors (though the taps generator from gr::filter::firdes does perform
  * some sanity checks and throws std::out_of_range in case of bad parameter).
  *
+ * Short filters run through a time-domain FIR. When the number of taps exceeds
+ * RX_FILTER_FFT_THRESHOLD (e.g. sharp filters at high sample rates) the filter
+ * switches to an overlap-save FFT filter, which has a much lower per-sample cost
+ * for long tap sets. The switch happens transparently in set_param().
+ *
  * \note In order to have proper LSB/USB, we must exchange low and high and reverse their sign
  */
-class rx_filter : public gr::hier_block2
+class rx_filter : public gr::hier_block2,
+                  public perf_counters_container
 {
 
 public:
     rx_filter(double sample_rate=96000.0, double low=-5000.0, double high=5000.0, double trans_width=1000.0); // FIXME: should be private
     ~rx_filter();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
 
     void set_param(double low, double high, double trans_width);
     void set_cw_offset(double offset);
 
+    /*! \brief Whether the frequency-domain filter is currently in use. */
+    bool is_fft_filter() const { return d_use_fft; }
+
+private:
+    void update_taps();
+
 private:
     std::vector<gr_complex> d_taps;
-    gr::filter::fir_filter_ccc::sptr  d_bpf;
+    gr::filter::fir_filter_ccc::sptr  d_bpf;      /*!< Time-domain filter for short tap sets. */
+    gr::filter::fft_filter_ccc::sptr  d_fft_bpf;  /*!< Overlap-save filter for long tap sets. */
+    bool d_use_fft;
 
     double d_sample_rate;
     double d_low;
@@ -122,12 +141,15 @@ rx_xlating_filter_sptr make_rx_xlating_filter(double sample_rate,
  *
  * \note In order to have proper LSB/USB, we must exchange low and high and reverse their sign?
  */
-class rx_xlating_filter : public gr::hier_block2
+class rx_xlating_filter : public gr::hier_block2,
+                          public perf_counters_container
 {
 
 public:
     rx_xlating_filter(double sample_rate=96000.0, double center=0.0, double low=-5000.0, double high=5000.0, double trans_width=1000.0); // FIXME: should be private
     ~rx_xlating_filter();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
 
     void set_offset(double center);
     void set_param(double low, double high, double trans_width);
@@ -34,10 +34,12 @@ rx_meter_c_sptr make_rx_meter_c(double quad_rate)
 
 rx_meter_c::rx_meter_c(double quad_rate)
     : gr::sync_block ("rx_meter_c",
-          gr::io_signature::make(1, 1, sizeof(gr_complex)),
+          gr::io_signature::make(1, 2, sizeof(gr_complex)),
           gr::io_signature::make(0, 0, 0)),
       d_quadrate(quad_rate),
-      d_avgsize(quad_rate * 0.100)
+      d_avgsize(quad_rate * 0.100),
+      d_window_power(0.0),
+      d_window_samples(0)
 {
     /* allocate circular buffer */
     d_writer = gr::make_buffer(d_avgsize + d_quadrate, sizeof(gr_complex), 1, 1);
@@ -60,6 +62,14 @@ int rx_meter_c::work(int noutput_items,
     const gr_complex *in = (const gr_complex *) input_items[0];
     (void) output_items; // unused
 
+    if (d_stats)
+    {
+        const gr_complex *sql_out = nullptr;
+        if (input_items.size() > 1)
+            sql_out = (const gr_complex *) input_items[1];
+        update_stats(in, sql_out, noutput_items);
+    }
+
     int items_to_copy = std::min(noutput_items, (int)d_writer->bufsize());
     if (items_to_copy < noutput_items)
         in += (noutput_items - items_to_copy);
@@ -90,3 +100,56 @@ float rx_meter_c::get_level_db()
     float power = sum / (float)(d_avgsize);
     return 10.f * log10f(power + 1.0e-20f);
 }
+
+void rx_meter_c::set_stats(std::shared_ptr<rx_meter_stats> stats)
+{
+    std::lock_guard<std::mutex> lock(d_mutex);
+
+    d_stats = std::move(stats);
+    d_window_power = 0.0;
+    d_window_samples = 0;
+}
+
+/* Called with d_mutex held. */
+void rx_meter_c::update_stats(const gr_complex *in, const gr_complex *sql_out,
+                              int n)
+{
+    double power_sum = 0.0;
+
+    for (int i = 0; i < n;)
+    {
+        int k = std::min<int>(n - i, d_avgsize - d_window_samples);
+        float power = 0;
+        volk_32f_x2_dot_prod_32f(&power, (const float *)(in + i),
+                                 (const float *)(in + i), k * 2);
+        power_sum += power;
+        d_window_power += power;
+        d_window_samples += k;
+        i += k;
+
+        if (d_window_samples == d_avgsize)
+        {
+            float level = 10.f * log10f(d_window_power / d_avgsize + 1.0e-20f);
+            d_stats->level_db.store(level, std::memory_order_relaxed);
+            if (level > d_stats->peak_db.load(std::memory_order_relaxed))
+                d_stats->peak_db.store(level, std::memory_order_relaxed);
+            d_window_power = 0.0;
+            d_window_samples = 0;
+        }
+    }
+
+    // the squelch outputs zeros while it is closed
+    uint64_t open = n;
+    if (sql_out && n > 0)
+    {
+        open = 0;
+        for (int i = 0; i < n; i++)
+            open += sql_out[i] != gr_complex(0.f, 0.f);
+        d_stats->sql_open.store(sql_out[n - 1] != gr_complex(0.f, 0.f),
+                                std::memory_order_relaxed);
+    }
+
+    d_stats->samples.fetch_add(n, std::memory_order_relaxed);
+    d_stats->sql_open_samples.fetch_add(open, std::memory_order_relaxed);
+    d_stats->power_sum.fetch_add(power_sum, std::memory_order_relaxed);
+}
@@ -26,9 +26,28 @@
 #include <gnuradio/sync_block.h>
 #include <gnuradio/buffer_reader.h>
 #include <gnuradio/buffer.h>
+#include <atomic>
+#include <cstdint>
 
 class rx_meter_c;
 
+/*! \brief Signal statistics of a channel, accumulated by rx_meter_c.
+ *
+ * Updated from the scheduler thread for every sample, and safe to read from
+ * any thread. Levels are in dBFS, averaged over the same 100 ms windows as
+ * get_level_db(), so they don't depend on how the scheduler splits the
+ * stream.
+ */
+struct rx_meter_stats
+{
+    std::atomic<float> level_db{-200.f}; /*!< Level of the last window. */
+    std::atomic<float> peak_db{-200.f};  /*!< Highest level of a window. */
+    std::atomic<bool> sql_open{true};    /*!< Squelch state, last sample. */
+    std::atomic<uint64_t> samples{0};    /*!< Samples measured. */
+    std::atomic<uint64_t> sql_open_samples{0}; /*!< Passed the squelch. */
+    std::atomic<double> power_sum{0.0};  /*!< Sum of the linear power. */
+};
+
 typedef std::shared_ptr<rx_meter_c> rx_meter_c_sptr;
 
 /*! \brief Return a shared_ptr to a new instance of rx_meter_c.
@@ -46,6 +65,9 @@ rx_meter_c_sptr make_rx_meter_c(double quad_rate);
  * This block can be used to measure the received signal strength.
  * The get_level_db() method returns the average signal power
  * over a 100ms period.
+ *
+ * The optional second input takes the output of the squelch, which is zero
+ * while the squelch is closed, to count the samples that pass it.
  */
 class rx_meter_c : public gr::sync_block
 {
@@ -60,7 +82,12 @@ public:
     /*! \brief Get the current signal level in dBFS. */
     float get_level_db();
 
+    /*! \brief Accumulate statistics into \p stats, nullptr to stop. */
+    void set_stats(std::shared_ptr<rx_meter_stats> stats);
+
 private:
+    void update_stats(const gr_complex *in, const gr_complex *sql_out, int n);
+
     double d_quadrate;
     unsigned int d_avgsize; /*! Number of samples to average. */
 
@@ -69,6 +96,10 @@ private:
     std::chrono::time_point<std::chrono::steady_clock> d_lasttime;
 
     std::mutex   d_mutex;  /*! Used to lock FFT output buffer. */
+
+    std::shared_ptr<rx_meter_stats> d_stats;
+    double       d_window_power;   /*! Power summed over the current window. */
+    unsigned int d_window_samples; /*! Samples in the current window. */
 };
 
 
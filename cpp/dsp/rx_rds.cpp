@@ -134,3 +134,9 @@ void rx_rds_store::get_message(std::string &out, int &type)
         type=-1;
     }
 }
+
+void rx_rds::get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const
+{
+    blocks.insert(blocks.end(),
+                  {d_bpf, d_fxff, d_rsmp, d_agc, d_sync, d_mpsk, d_ddbb});
+}
@@ -39,6 +39,7 @@
 #include <queue>
 #include "dsp/rds/decoder.h"
 #include "dsp/rds/parser.h"
+#include "dsp/perf_counters.h"
 
 class rx_rds;
 class rx_rds_store;
@@ -66,12 +67,15 @@ private:
 
 };
 
-class rx_rds : public gr::hier_block2
+class rx_rds : public gr::hier_block2,
+               public perf_counters_container
 {
 
 public:
     rx_rds(double sample_rate=240000.0);
     ~rx_rds();
+    void
+    get_perf_blocks(std::vector<gr::basic_block_sptr>& blocks) const override;
 
     void set_param(double low, double high, double trans_width);
 
@@ -0,0 +1,329 @@
+#include "shm_ring.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static uint64_t writing_seq(uint64_t n) { return 2 * n + 1; }
+static uint64_t published_seq(uint64_t n) { return 2 * n + 2; }
+
+/* The futex is shared between processes, so it can't be FUTEX_PRIVATE. */
+static void futex_wait(std::atomic<uint32_t>* addr, uint32_t val,
+                       const timespec* timeout)
+{
+    syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAIT, val, timeout, nullptr, 0);
+}
+
+static void futex_wake_all(std::atomic<uint32_t>* addr)
+{
+    syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAKE, INT_MAX, nullptr, nullptr,
+            0);
+}
+
+static std::runtime_error shm_error(const std::string& what,
+                                    const std::string& name)
+{
+    return std::runtime_error(what + " " + name + ": " +
+                              std::strerror(errno));
+}
+
+/* Whether a process exists, even if we may not signal it. */
+static bool process_alive(pid_t pid)
+{
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+/* Unlink the ring a writer left behind under a name, if it closed the ring or
+ * died without closing it. Anything else is left alone. */
+static void unlink_stale(const std::string& name)
+{
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return;
+
+    bool stale = false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= shm_ring::header_size()) {
+        void* p = mmap(nullptr, shm_ring::header_size(), PROT_READ, MAP_SHARED,
+                       fd, 0);
+        if (p != MAP_FAILED) {
+            auto* hdr = (const shm_ring::header*)p;
+
+            bool valid = hdr->magic == shm_ring::MAGIC;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            stale = valid && (hdr->version != shm_ring::VERSION ||
+                              hdr->closed.load(std::memory_order_acquire) ||
+                              !process_alive(hdr->writer_pid));
+
+            munmap(p, shm_ring::header_size());
+        }
+    }
+    close(fd);
+
+    if (!stale)
+        throw std::runtime_error(
+            "shared memory " + name +
+            " is in use by another writer, or is not a ring");
+
+    shm_unlink(name.c_str());
+}
+
+std::string shm_ring::object_name(const std::string& name)
+{
+    if (name.empty() || name.find('/') != std::string::npos)
+        throw std::runtime_error("invalid shared memory name: " + name);
+
+    return "/" + name;
+}
+
+size_t shm_ring::header_size()
+{
+    return (sizeof(header) + alignof(slot) - 1) / alignof(slot) *
+           alignof(slot);
+}
+
+size_t shm_ring::slot_stride(size_t slot_size)
+{
+    return (sizeof(slot) + slot_size + alignof(slot) - 1) / alignof(slot) *
+           alignof(slot);
+}
+
+size_t shm_ring::mapping_size(size_t slot_size, size_t nslots)
+{
+    return header_size() + nslots * slot_stride(slot_size);
+}
+
+shm_ring_writer::sptr shm_ring_writer::make(const std::string& name,
+                                            shm_ring::kind kind,
+                                            size_t slot_size, size_t nslots)
+{
+    return std::make_shared<shm_ring_writer>(name, kind, slot_size, nslots);
+}
+
+shm_ring_writer::shm_ring_writer(const std::string& name, shm_ring::kind kind,
+                                 size_t slot_size, size_t nslots) :
+    d_name(shm_ring::object_name(name)),
+    d_hdr(nullptr),
+    d_size(shm_ring::mapping_size(slot_size, nslots)),
+    d_head(0)
+{
+    if (slot_size == 0 || nslots == 0)
+        throw std::runtime_error("invalid shared memory ring size");
+
+    // a writer that crashed leaves its object behind
+    unlink_stale(d_name);
+
+    int fd = shm_open(d_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        throw shm_error("can not create", d_name);
+
+    if (ftruncate(fd, d_size) != 0) {
+        auto error = shm_error("can not resize", d_name);
+        close(fd);
+        shm_unlink(d_name.c_str());
+        throw error;
+    }
+
+    void* p = mmap(nullptr, d_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        auto error = shm_error("can not map", d_name);
+        shm_unlink(d_name.c_str());
+        throw error;
+    }
+
+    // ftruncate() zero filled the object, which is a valid empty ring
+    d_hdr = new (p) shm_ring::header{};
+    d_hdr->kind = kind;
+    d_hdr->nslots = nslots;
+    d_hdr->slot_size = slot_size;
+    d_hdr->slot_stride = shm_ring::slot_stride(slot_size);
+    d_hdr->version = shm_ring::VERSION;
+    d_hdr->writer_pid = getpid();
+    std::atomic_thread_fence(std::memory_order_release);
+    d_hdr->magic = shm_ring::MAGIC;
+}
+
+shm_ring_writer::~shm_ring_writer()
+{
+    d_hdr->closed.store(1, std::memory_order_release);
+    d_hdr->futex.fetch_add(1);
+    futex_wake_all(&d_hdr->futex);
+
+    munmap(d_hdr, d_size);
+    shm_unlink(d_name.c_str());
+}
+
+shm_ring::slot* shm_ring_writer::slot_at(uint64_t n) const
+{
+    char* base = (char*)d_hdr + shm_ring::header_size();
+    return (shm_ring::slot*)(base + (n % d_hdr->nslots) * d_hdr->slot_stride);
+}
+
+void* shm_ring_writer::begin_write()
+{
+    shm_ring::slot* s = slot_at(d_head);
+
+    s->seq.store(writing_seq(d_head), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return s + 1;
+}
+
+void shm_ring_writer::commit(size_t size, uint64_t offset, double sample_rate)
+{
+    using namespace std::chrono;
+
+    shm_ring::slot* s = slot_at(d_head);
+
+    s->offset = offset;
+    s->timestamp_ns =
+        duration_cast<nanoseconds>(system_clock::now().time_since_epoch())
+            .count();
+    s->sample_rate = sample_rate;
+    s->size = size;
+    s->seq.store(published_seq(d_head), std::memory_order_release);
+
+    d_head++;
+    d_hdr->head.store(d_head, std::memory_order_release);
+
+    // Both are sequentially consistent, so that a reader going to sleep
+    // either is seen here, or sees the new futex value and doesn't sleep.
+    d_hdr->futex.fetch_add(1);
+    if (d_hdr->waiters.load() > 0)
+        futex_wake_all(&d_hdr->futex);
+}
+
+void shm_ring_writer::write(const void* data, size_t size, uint64_t offset,
+                            double sample_rate)
+{
+    size = std::min<size_t>(size, d_hdr->slot_size);
+    std::memcpy(begin_write(), data, size);
+    commit(size, offset, sample_rate);
+}
+
+shm_ring_reader::shm_ring_reader(const std::string& name) :
+    d_hdr(nullptr),
+    d_size(0),
+    d_cursor(0)
+{
+    const std::string object = shm_ring::object_name(name);
+
+    // read-write, since sleeping readers register in the header
+    int fd = shm_open(object.c_str(), O_RDWR, 0);
+    if (fd < 0)
+        throw shm_error("can not open", object);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < shm_ring::header_size()) {
+        close(fd);
+        throw std::runtime_error("invalid shared memory ring " + object);
+    }
+
+    d_size = st.st_size;
+    void* p = mmap(nullptr, d_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        throw shm_error("can not map", object);
+
+    d_hdr = (shm_ring::header*)p;
+
+    bool valid = d_hdr->magic == shm_ring::MAGIC;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    valid = valid && d_hdr->version == shm_ring::VERSION &&
+            d_hdr->nslots > 0 &&
+            d_hdr->slot_stride ==
+                shm_ring::slot_stride(d_hdr->slot_size) &&
+            d_size >= shm_ring::mapping_size(d_hdr->slot_size,
+                                             d_hdr->nslots);
+    if (!valid) {
+        munmap(d_hdr, d_size);
+        throw std::runtime_error("invalid shared memory ring " + object);
+    }
+
+    d_cursor = d_hdr->head.load(std::memory_order_acquire);
+}
+
+shm_ring_reader::~shm_ring_reader() { munmap(d_hdr, d_size); }
+
+const shm_ring::slot* shm_ring_reader::slot_at(uint64_t n) const
+{
+    const char* base = (const char*)d_hdr + shm_ring::header_size();
+    return (const shm_ring::slot*)(base +
+                                   (n % d_hdr->nslots) * d_hdr->slot_stride);
+}
+
+shm_ring::status shm_ring_reader::next(shm_ring::frame& frame, int timeout_ms)
+{
+    using namespace std::chrono;
+
+    const auto deadline = steady_clock::now() + milliseconds(timeout_ms);
+
+    for (;;) {
+        // read before the head, so that a frame published in between changes
+        // it and the wait below returns right away
+        uint32_t futex = d_hdr->futex.load();
+        uint64_t head = d_hdr->head.load(std::memory_order_acquire);
+
+        if (head > d_cursor) {
+            const shm_ring::slot* s = slot_at(d_cursor);
+
+            if (head - d_cursor > d_hdr->nslots ||
+                s->seq.load(std::memory_order_acquire) !=
+                    published_seq(d_cursor)) {
+                d_cursor = head - 1;
+                return shm_ring::STATUS_LAGGED;
+            }
+
+            frame.data = s + 1;
+            frame.size = std::min<size_t>(s->size, d_hdr->slot_size);
+            frame.offset = s->offset;
+            frame.timestamp_ns = s->timestamp_ns;
+            frame.sample_rate = s->sample_rate;
+            frame.seq = d_cursor;
+
+            d_cursor++;
+            return shm_ring::STATUS_OK;
+        }
+
+        if (d_hdr->closed.load(std::memory_order_acquire))
+            return shm_ring::STATUS_CLOSED;
+
+        timespec ts;
+        const timespec* timeout = nullptr;
+        if (timeout_ms >= 0) {
+            auto left =
+                duration_cast<nanoseconds>(deadline - steady_clock::now());
+            if (left.count() <= 0)
+                return shm_ring::STATUS_TIMEOUT;
+
+            ts.tv_sec = left.count() / 1000000000;
+            ts.tv_nsec = left.count() % 1000000000;
+            timeout = &ts;
+        }
+
+        d_hdr->waiters.fetch_add(1);
+        futex_wait(&d_hdr->futex, futex, timeout);
+        d_hdr->waiters.fetch_sub(1);
+    }
+}
+
+bool shm_ring_reader::validate(const shm_ring::frame& frame) const
+{
+    // orders the reads of the payload before the check
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return slot_at(frame.seq)->seq.load(std::memory_order_relaxed) ==
+           published_seq(frame.seq);
+}
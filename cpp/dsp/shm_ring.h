@@ -0,0 +1,184 @@
+#ifndef VIOLETRX_DSP_SHM_RING
+#define VIOLETRX_DSP_SHM_RING
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/*! \brief A single producer ring of frames in POSIX shared memory.
+ *  \ingroup IO
+ *
+ * The ring lets readers on the same host take samples straight out of the
+ * writer's memory. The writer fills slots in place and publishes them with a
+ * per-slot sequence number, like a seqlock, and never waits for readers.
+ * Readers follow with their own cursor, get a pointer into the slot and check
+ * after using it that the writer didn't overwrite it in the meantime. Idle
+ * readers sleep on a futex in the shared header, which the writer only wakes
+ * when somebody is waiting, so publishing a frame costs no system call.
+ *
+ * Slot n of the stream is in slot (n % nslots). Its sequence number is odd
+ * while the writer fills it and becomes 2 * n + 2 once it is published.
+ */
+class shm_ring
+{
+public:
+    /*! \brief What the frames hold. */
+    enum kind : uint32_t {
+        KIND_IQ_CF32 = 0,          /*!< Interleaved 32-bit float I/Q. */
+        KIND_AUDIO_F32_STEREO = 1, /*!< Interleaved 32-bit float L/R. */
+        KIND_FFT_F32 = 2,          /*!< One FFT frame of mag^2 bins. */
+    };
+
+    /*! \brief Result of reading a frame. */
+    enum status {
+        STATUS_OK = 0,      /*!< A frame was read. */
+        STATUS_TIMEOUT = 1, /*!< No frame was published in time. */
+        STATUS_LAGGED = 2,  /*!< Frames were lost, the reader skipped ahead. */
+        STATUS_CLOSED = 3,  /*!< The writer is gone. */
+    };
+
+    static constexpr uint32_t MAGIC = 0x474e5256; /* "VRNG" */
+    static constexpr uint32_t VERSION = 1;
+
+    /*! \brief Shared header at the start of the mapping. */
+    struct header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t kind;
+        uint32_t nslots;
+        uint64_t slot_size;   /*!< Payload bytes per slot. */
+        uint64_t slot_stride; /*!< Bytes between two slots. */
+
+        alignas(64) std::atomic<uint64_t> head; /*!< Slots published. */
+        std::atomic<uint32_t> closed;           /*!< Set by the writer. */
+        int32_t writer_pid;                     /*!< Process of the writer. */
+
+        alignas(64) std::atomic<uint32_t> futex; /*!< Bumped per frame. */
+        std::atomic<uint32_t> waiters;           /*!< Readers asleep. */
+    };
+
+    /*! \brief Shared slot header, followed by the payload. */
+    struct alignas(64) slot {
+        std::atomic<uint64_t> seq;
+        uint64_t offset;       /*!< Stream index of the first item. */
+        uint64_t timestamp_ns; /*!< Wall clock time of publishing. */
+        double sample_rate;    /*!< Items, or frames, per second. */
+        uint64_t size;         /*!< Payload bytes. */
+    };
+
+    /*! \brief A frame handed to a reader. */
+    struct frame {
+        const void* data;
+        size_t size;
+        uint64_t offset;
+        uint64_t timestamp_ns;
+        double sample_rate;
+        uint64_t seq; /*!< Index of the frame in the stream. */
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+    /*! \brief Name of the shared memory object, as given to shm_open(). */
+    static std::string object_name(const std::string& name);
+
+    static size_t header_size();
+    static size_t slot_stride(size_t slot_size);
+    static size_t mapping_size(size_t slot_size, size_t nslots);
+};
+
+/*! \brief The writing side of a shm_ring.
+ *
+ * Creating a writer replaces a stale ring with the same name, one that was
+ * closed or whose writer process is gone, but fails if the name is taken by a
+ * live writer or by something else. Destroying it marks the ring closed, wakes
+ * up the readers and unlinks the name; readers that still have it mapped keep
+ * a valid mapping until they close it.
+ *
+ * Only one thread may write at a time.
+ */
+class shm_ring_writer
+{
+public:
+    using sptr = std::shared_ptr<shm_ring_writer>;
+
+    /*! \throws std::runtime_error if the shared memory can't be set up. */
+    static sptr make(const std::string& name, shm_ring::kind kind,
+                     size_t slot_size, size_t nslots);
+
+    shm_ring_writer(const std::string& name, shm_ring::kind kind,
+                    size_t slot_size, size_t nslots);
+    ~shm_ring_writer();
+
+    shm_ring_writer(const shm_ring_writer&) = delete;
+    shm_ring_writer& operator=(const shm_ring_writer&) = delete;
+
+    /*! \brief Claim the next slot and return its payload to be filled. */
+    void* begin_write();
+
+    /*! \brief Publish the slot claimed by begin_write(). */
+    void commit(size_t size, uint64_t offset, double sample_rate);
+
+    /*! \brief Copy a frame into the next slot and publish it. */
+    void write(const void* data, size_t size, uint64_t offset,
+               double sample_rate);
+
+    const std::string& name() const { return d_name; }
+    size_t slot_size() const { return d_hdr->slot_size; }
+
+private:
+    shm_ring::slot* slot_at(uint64_t n) const;
+
+private:
+    const std::string d_name;
+    shm_ring::header* d_hdr; /*!< Start of the mapping. */
+    size_t d_size;           /*!< Size of the mapping. */
+    uint64_t d_head;         /*!< Index of the slot being written. */
+};
+
+/*! \brief The reading side of a shm_ring.
+ *
+ * A reader starts with the next frame published after it was opened. It is
+ * meant to be used by one thread; open the ring once per reading thread.
+ */
+class shm_ring_reader
+{
+public:
+    /*! \throws std::runtime_error if the ring doesn't exist or is invalid. */
+    explicit shm_ring_reader(const std::string& name);
+    ~shm_ring_reader();
+
+    shm_ring_reader(const shm_ring_reader&) = delete;
+    shm_ring_reader& operator=(const shm_ring_reader&) = delete;
+
+    shm_ring::kind get_kind() const { return (shm_ring::kind)d_hdr->kind; }
+    size_t slot_size() const { return d_hdr->slot_size; }
+    size_t num_slots() const { return d_hdr->nslots; }
+
+    /*! \brief Get the next frame, waiting for it if needed.
+     *  \param frame Receives the frame, which points into shared memory.
+     *  \param timeout_ms How long to wait, or -1 to wait forever.
+     *
+     * On STATUS_LAGGED, the reader has skipped to the latest frame, which the
+     * next call returns.
+     */
+    shm_ring::status next(shm_ring::frame& frame, int timeout_ms);
+
+    /*! \brief Check that a frame wasn't overwritten while it was being used.
+     *
+     * Anything read from the frame must be thrown away if this returns false.
+     */
+    bool validate(const shm_ring::frame& frame) const;
+
+private:
+    const shm_ring::slot* slot_at(uint64_t n) const;
+
+private:
+    shm_ring::header* d_hdr; /*!< Start of the mapping. */
+    size_t d_size;           /*!< Size of the mapping. */
+    uint64_t d_cursor;       /*!< Index of the next frame to read. */
+};
+
+#endif // VIOLETRX_DSP_SHM_RING
@@ -0,0 +1,67 @@
+#include "shm_ring_sink.h"
+#include <algorithm>
+#include <cstring>
+
+#include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+
+shm_ring_sink::sptr shm_ring_sink::make(shm_ring_writer::sptr ring,
+                                        size_t itemsize, int ninputs,
+                                        double sample_rate)
+{
+    return gnuradio::make_block_sptr<shm_ring_sink>(
+        std::move(ring), itemsize, ninputs, sample_rate,
+        private_construction_tag{});
+}
+
+shm_ring_sink::shm_ring_sink(shm_ring_writer::sptr ring, size_t itemsize,
+                             int ninputs, double sample_rate,
+                             private_construction_tag) :
+    gr::sync_block("shm_ring_sink",
+                   gr::io_signature::make(ninputs, ninputs, itemsize),
+                   gr::io_signature::make(0, 0, 0)),
+    d_ring(std::move(ring)),
+    d_itemsize(itemsize),
+    d_ninputs(ninputs),
+    d_sample_rate(sample_rate),
+    d_offset(0)
+{
+}
+
+int shm_ring_sink::work(int noutput_items,
+                        gr_vector_const_void_star& input_items,
+                        gr_vector_void_star& /* output_items */)
+{
+    const size_t frame_size = d_itemsize * d_ninputs;
+    const size_t slot_items = d_ring->slot_size() / frame_size;
+    const double sample_rate = d_sample_rate;
+
+    for (int i = 0; i < noutput_items;) {
+        size_t n = std::min<size_t>(noutput_items - i, slot_items);
+        char* out = (char*)d_ring->begin_write();
+
+        if (d_ninputs == 1) {
+            std::memcpy(out, (const char*)input_items[0] + i * d_itemsize,
+                        n * d_itemsize);
+        } else if (d_ninputs == 2 && d_itemsize == sizeof(float)) {
+            // interleaving two floats is the same as making complex numbers
+            volk_32f_x2_interleave_32fc((lv_32fc_t*)out,
+                                        (const float*)input_items[0] + i,
+                                        (const float*)input_items[1] + i, n);
+        } else {
+            for (size_t k = 0; k < n; k++)
+                for (int c = 0; c < d_ninputs; c++)
+                    std::memcpy(out + (k * d_ninputs + c) * d_itemsize,
+                                (const char*)input_items[c] +
+                                    (i + k) * d_itemsize,
+                                d_itemsize);
+        }
+
+        d_ring->commit(n * frame_size, d_offset, sample_rate);
+
+        i += n;
+        d_offset += n;
+    }
+
+    return noutput_items;
+}
@@ -0,0 +1,57 @@
+#ifndef VIOLETRX_DSP_SHM_RING_SINK
+#define VIOLETRX_DSP_SHM_RING_SINK
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include <gnuradio/sync_block.h>
+
+#include "dsp/shm_ring.h"
+
+/*! \brief Writes one or more streams into a shared memory ring.
+ *  \ingroup IO
+ *
+ * The inputs are interleaved item by item straight into the slots of the
+ * ring, so a complex stream is written as is and two float streams become
+ * interleaved stereo. Every call to work() publishes what it got right away,
+ * split into as many slots as needed.
+ */
+class shm_ring_sink : public gr::sync_block
+{
+public:
+    using sptr = std::shared_ptr<shm_ring_sink>;
+
+private:
+    struct private_construction_tag {
+    };
+
+public:
+    /*! \brief Create a sink.
+     *  \param ring The ring to write to.
+     *  \param itemsize Size of the items of every input.
+     *  \param ninputs Number of inputs to interleave.
+     *  \param sample_rate Items per second, recorded with every slot.
+     */
+    static sptr make(shm_ring_writer::sptr ring, size_t itemsize, int ninputs,
+                     double sample_rate);
+
+    shm_ring_sink(shm_ring_writer::sptr ring, size_t itemsize, int ninputs,
+                  double sample_rate, private_construction_tag);
+
+    int work(int noutput_items, gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override;
+
+    void set_sample_rate(double sample_rate) { d_sample_rate = sample_rate; }
+    const shm_ring_writer::sptr& get_ring() const { return d_ring; }
+
+private:
+    const shm_ring_writer::sptr d_ring;
+    const size_t d_itemsize;
+    const int d_ninputs;
+
+    std::atomic<double> d_sample_rate;
+    uint64_t d_offset; /*!< Index of the next item. */
+};
+
+#endif // VIOLETRX_DSP_SHM_RING_SINK
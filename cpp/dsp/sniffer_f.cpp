@@ -41,7 +41,8 @@ sniffer_f::sniffer_f(int buffsize) :
     gr::sync_block("sniffer_f", gr::io_signature::make(1, 1, sizeof(float)),
                    gr::io_signature::make(0, 0, 0)),
     d_buffsize(buffsize),
-    d_minsamp(1000)
+    d_minsamp(1000),
+    d_blocking(false)
 {
     d_writer = gr::make_buffer(d_buffsize, sizeof(float), 1, 1);
     d_reader = gr::buffer_add_reader(d_writer, 0);
@@ -55,7 +56,8 @@ sniffer_f::~sniffer_f() {}
  *  \param output_items
  *
  * This method does nothing except dumping the incoming samples into the
- * circular buffer.
+ * circular buffer. In blocking mode it waits for the reader to make room,
+ * until the flow graph stops and interrupts the wait.
  */
 int sniffer_f::work(int noutput_items, gr_vector_const_void_star& input_items,
                     gr_vector_void_star& output_items)
@@ -64,7 +66,18 @@ int sniffer_f::work(int noutput_items, gr_vector_const_void_star& input_items,
 
     (void)output_items;
 
-    std::lock_guard<std::mutex> lock(d_mutex);
+    gr::thread::scoped_lock lock(d_mutex);
+
+    while (d_blocking && d_writer->space_available() == 0)
+        d_cond.wait(lock);
+
+    if (d_blocking) {
+        int n = std::min(noutput_items, d_writer->space_available());
+        memcpy(d_writer->write_pointer(), in, sizeof(float) * n);
+        d_writer->update_write_pointer(n);
+
+        return n;
+    }
 
     /* dump new samples into the buffer */
     int items_to_copy = std::min(noutput_items, (int)d_writer->bufsize());
@@ -88,7 +101,7 @@ int sniffer_f::work(int noutput_items, gr_vector_const_void_star& input_items,
  */
 int sniffer_f::samples_available()
 {
-    std::lock_guard<std::mutex> lock(d_mutex);
+    gr::thread::scoped_lock lock(d_mutex);
 
     return d_reader->items_available();
 }
@@ -100,9 +113,10 @@ int sniffer_f::samples_available()
  */
 void sniffer_f::get_samples(float* out, int& num)
 {
-    std::lock_guard<std::mutex> lock(d_mutex);
+    gr::thread::scoped_lock lock(d_mutex);
 
-    if (d_reader->items_available() < d_minsamp) {
+    /* a blocking sniffer is drained completely at the end of the stream */
+    if (!d_blocking && d_reader->items_available() < d_minsamp) {
         /* not enough samples in buffer */
         num = 0;
         return;
@@ -111,6 +125,8 @@ void sniffer_f::get_samples(float* out, int& num)
     num = std::min(d_reader->items_available(), d_buffsize);
     memcpy(out, d_reader->read_pointer(), sizeof(float) * num);
     d_reader->update_read_pointer(num);
+
+    d_cond.notify_one();
 }
 
 /*! \brief Resize internal buffer.
@@ -118,10 +134,20 @@ void sniffer_f::get_samples(float* out, int& num)
  */
 void sniffer_f::set_buffer_size(int newsize)
 {
-    std::lock_guard<std::mutex> lock(d_mutex);
+    gr::thread::scoped_lock lock(d_mutex);
 
     d_writer = gr::make_buffer(newsize, sizeof(float), 1, 1);
     d_reader = gr::buffer_add_reader(d_writer, 0);
+
+    d_cond.notify_one();
+}
+
+void sniffer_f::set_blocking(bool blocking)
+{
+    gr::thread::scoped_lock lock(d_mutex);
+
+    d_blocking = blocking;
+    d_cond.notify_one();
 }
 
 /*! \brief Get current size of the internal buffer.
@@ -131,7 +157,7 @@ void sniffer_f::set_buffer_size(int newsize)
  */
 int sniffer_f::buffer_size()
 {
-    std::lock_guard<std::mutex> lock(d_mutex);
+    gr::thread::scoped_lock lock(d_mutex);
 
     return d_writer->bufsize();
 }
@@ -26,7 +26,7 @@
 #include <gnuradio/buffer.h>
 #include <gnuradio/buffer_reader.h>
 #include <gnuradio/sync_block.h>
-#include <mutex>
+#include <gnuradio/thread/thread.h>
 
 class sniffer_f;
 
@@ -52,6 +52,9 @@ sniffer_f_sptr make_sniffer_f(int buffsize = 48000);
  * The class uses a circular buffer for internal storage and if the received
  * samples exceed the buffer size, old samples will be overwritten. The
  * collected samples can be accessed via the get_samples() method.
+ *
+ * In blocking mode, the flow graph waits for the reader instead, so that no
+ * sample is lost when the input runs faster than real time.
  */
 class sniffer_f : public gr::sync_block
 {
@@ -71,12 +74,17 @@ public:
     void set_min_samples(int num) { d_minsamp = num; }
     int min_samples() { return d_minsamp; }
 
+    /*! \brief Wait for free space instead of overwriting old samples. */
+    void set_blocking(bool blocking);
+
 private:
-    std::mutex d_mutex; /*! Used to prevent concurrent access to buffer. */
+    gr::thread::mutex d_mutex; /*! Prevents concurrent access to buffer. */
+    gr::thread::condition_variable d_cond; /*! Signals free space. */
     gr::buffer_sptr d_writer;
     gr::buffer_reader_sptr d_reader;
     int d_buffsize;
     int d_minsamp; /*! smallest number of samples we want to return. */
+    bool d_blocking;
 };
 
 #endif /* SNIFFER_F_H */
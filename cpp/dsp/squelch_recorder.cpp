@@ -0,0 +1,290 @@
+#include "squelch_recorder.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+#include <gnuradio/io_signature.h>
+#include <sndfile.h>
+
+#include "squelch_tagger_cc.h"
+
+/* <prefix>_20240131T235959.123Z.flac, with a -<n> suffix before the extension
+ * for the n-th extra segment started in the same millisecond. */
+static std::string segment_filename(const std::string& prefix,
+                                    std::chrono::system_clock::time_point t,
+                                    unsigned n)
+{
+    using namespace std::chrono;
+
+    std::time_t secs = system_clock::to_time_t(t);
+    int millis = (int)(duration_cast<milliseconds>(t.time_since_epoch()) %
+                       seconds(1))
+                     .count();
+
+    std::tm tm;
+    gmtime_r(&secs, &tm);
+
+    char buf[64];
+    size_t len = std::strftime(buf, sizeof(buf), "%Y%m%dT%H%M%S", &tm);
+    if (n == 0)
+        std::snprintf(buf + len, sizeof(buf) - len, ".%03dZ.flac", millis);
+    else
+        std::snprintf(buf + len, sizeof(buf) - len, ".%03dZ-%u.flac", millis,
+                      n);
+
+    return prefix + "_" + buf;
+}
+
+squelch_recorder::sptr squelch_recorder::make(const std::string& prefix,
+                                              int sample_rate, double hang_time,
+                                              segment_callback callback)
+{
+    return gnuradio::make_block_sptr<squelch_recorder>(
+        prefix, sample_rate, hang_time, std::move(callback),
+        private_construction_tag{});
+}
+
+squelch_recorder::squelch_recorder(const std::string& prefix, int sample_rate,
+                                   double hang_time, segment_callback callback,
+                                   private_construction_tag) :
+    gr::sync_block("squelch_recorder",
+                   gr::io_signature::make(2, 2, sizeof(float)),
+                   gr::io_signature::make(0, 0, 0)),
+    d_prefix(prefix),
+    d_sample_rate(sample_rate),
+    d_hang_time(hang_time),
+    d_callback(std::move(callback)),
+    d_sql_open(false),
+    d_stereo(false),
+    d_active(false),
+    d_closed(false),
+    d_channels(1),
+    d_first(false),
+    d_frames(0),
+    d_hang(0),
+    d_same_time(0),
+    d_stop(false),
+    d_write_errors(0)
+{
+    d_writer = std::thread(&squelch_recorder::writer_loop, this);
+}
+
+squelch_recorder::~squelch_recorder() { close(); }
+
+void squelch_recorder::close()
+{
+    {
+        std::lock_guard lock{d_work_mutex};
+
+        if (d_closed)
+            return;
+        d_closed = true;
+
+        if (d_active)
+            end_segment();
+    }
+
+    {
+        std::lock_guard lock{d_queue_mutex};
+        d_stop = true;
+    }
+    d_queue_cond.notify_one();
+    d_writer.join();
+}
+
+void squelch_recorder::set_stereo(bool stereo)
+{
+    std::lock_guard lock{d_work_mutex};
+    d_stereo = stereo;
+}
+
+uint64_t squelch_recorder::write_errors() const
+{
+    std::lock_guard lock{d_queue_mutex};
+    return d_write_errors;
+}
+
+int squelch_recorder::work(int noutput_items,
+                           gr_vector_const_void_star& input_items,
+                           gr_vector_void_star& /* output_items */)
+{
+    const float* left = (const float*)input_items[0];
+    const float* right = (const float*)input_items[1];
+
+    std::lock_guard lock{d_work_mutex};
+
+    if (d_closed)
+        return noutput_items;
+
+    // both channels come from the same receiver, with the same tags
+    std::vector<gr::tag_t> tags;
+    get_tags_in_window(tags, 0, 0, noutput_items, squelch_tagger_cc::TAG_KEY);
+
+    const uint64_t offset = nitems_read(0);
+    int i = 0;
+    for (const auto& tag : tags) {
+        int pos = (int)(tag.offset - offset);
+        record(left + i, right + i, pos - i);
+        d_sql_open = pmt::to_bool(tag.value);
+        i = pos;
+    }
+    record(left + i, right + i, noutput_items - i);
+
+    return noutput_items;
+}
+
+/* Record frames received while the squelch state doesn't change. */
+void squelch_recorder::record(const float* left, const float* right, int n)
+{
+    if (n == 0)
+        return;
+
+    if (d_sql_open)
+        d_hang = (uint64_t)(d_hang_time * d_sample_rate);
+    else if (!d_active)
+        return;
+
+    if (!d_active)
+        begin_segment();
+
+    // the segment ends within these frames once the hang time runs out
+    bool ending = false;
+    if (!d_sql_open) {
+        if (d_hang <= (uint64_t)n) {
+            n = (int)d_hang;
+            ending = true;
+        }
+        d_hang -= n;
+    }
+
+    for (int i = 0; i < n;) {
+        int k = std::min<size_t>(n - i,
+                                 CHUNK_FRAMES - d_pending.size() / d_channels);
+
+        if (d_channels == 2) {
+            for (int j = i; j < i + k; j++) {
+                d_pending.push_back(left[j]);
+                d_pending.push_back(right[j]);
+            }
+        } else {
+            d_pending.insert(d_pending.end(), left + i, left + i + k);
+        }
+
+        i += k;
+        d_frames += k;
+
+        if (d_pending.size() == CHUNK_FRAMES * d_channels)
+            submit(false);
+    }
+
+    if (ending)
+        end_segment();
+}
+
+void squelch_recorder::begin_segment()
+{
+    auto now = std::chrono::system_clock::now();
+
+    // playback faster than real time can start several segments in the same
+    // millisecond
+    using std::chrono::milliseconds;
+    if (std::chrono::floor<milliseconds>(now) ==
+        std::chrono::floor<milliseconds>(d_segment.start))
+        d_same_time++;
+    else
+        d_same_time = 0;
+
+    d_active = true;
+    d_first = true;
+    d_channels = d_stereo ? 2 : 1;
+    d_segment = segment{
+        .filename = segment_filename(d_prefix, now, d_same_time),
+        .start = now,
+        .duration = 0,
+    };
+    d_frames = 0;
+    d_pending.reserve(CHUNK_FRAMES * 2);
+}
+
+void squelch_recorder::end_segment()
+{
+    d_segment.duration = (double)d_frames / d_sample_rate;
+    submit(true);
+    d_active = false;
+}
+
+/* Hand the pending frames over to the writer thread. */
+void squelch_recorder::submit(bool last)
+{
+    chunk c{
+        .samples = std::move(d_pending),
+        .channels = d_channels,
+        .first = d_first,
+        .last = last,
+        .seg = d_segment,
+    };
+
+    d_pending = std::vector<float>();
+    d_pending.reserve(CHUNK_FRAMES * 2);
+    d_first = false;
+
+    {
+        std::lock_guard lock{d_queue_mutex};
+        d_queue.push_back(std::move(c));
+    }
+    d_queue_cond.notify_one();
+}
+
+void squelch_recorder::writer_loop()
+{
+    SNDFILE* sf = nullptr;
+
+    for (;;) {
+        chunk c;
+
+        {
+            std::unique_lock lock{d_queue_mutex};
+            d_queue_cond.wait(lock,
+                              [this] { return d_stop || !d_queue.empty(); });
+
+            // only exit once everything has been written
+            if (d_queue.empty())
+                break;
+
+            c = std::move(d_queue.front());
+            d_queue.pop_front();
+        }
+
+        if (c.first) {
+            SF_INFO info{};
+            info.samplerate = d_sample_rate;
+            info.channels = c.channels;
+            info.format = SF_FORMAT_FLAC | SF_FORMAT_PCM_16;
+
+            sf = sf_open(c.seg.filename.c_str(), SFM_WRITE, &info);
+            if (sf) {
+                // saturate instead of wrapping around on loud audio
+                sf_command(sf, SFC_SET_CLIPPING, nullptr, SF_TRUE);
+            } else {
+                std::lock_guard lock{d_queue_mutex};
+                d_write_errors++;
+            }
+        }
+
+        if (!sf)
+            continue;
+
+        sf_writef_float(sf, c.samples.data(), c.samples.size() / c.channels);
+
+        if (c.last) {
+            sf_close(sf);
+            sf = nullptr;
+
+            if (d_callback)
+                d_callback(c.seg);
+        }
+    }
+
+    if (sf)
+        sf_close(sf);
+}
@@ -0,0 +1,129 @@
+#ifndef VIOLETRX_DSP_SQUELCH_RECORDER
+#define VIOLETRX_DSP_SQUELCH_RECORDER
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gnuradio/sync_block.h>
+
+/*! \brief Squelch gated audio recorder.
+ *  \ingroup DSP
+ *
+ * Records only while the squelch is open, plus a hang time after it closes,
+ * so that a monitored channel doesn't fill the disk with silence. Every
+ * transmission becomes a separate FLAC file named after the recording prefix
+ * and the UTC time at which it started. Mono channels (where both inputs
+ * carry the same audio) are written as mono.
+ *
+ * The squelch state comes with the audio, as the tags of a squelch_tagger_cc
+ * upstream, so segments start and end on the audio of the transition however
+ * far ahead of the recorder the squelch runs. Encoding and disk I/O happen on
+ * a background thread, which also reports every completed segment through the
+ * segment callback.
+ *
+ * The flow graph restarts the block on every reconfiguration, so a segment
+ * only ends when the squelch closes or the recording is closed, never when
+ * the block is stopped.
+ */
+class squelch_recorder : public gr::sync_block
+{
+public:
+    using sptr = std::shared_ptr<squelch_recorder>;
+
+    struct segment {
+        std::string filename;
+        std::chrono::system_clock::time_point start;
+        double duration; /*!< In seconds. */
+    };
+
+    using segment_callback = std::function<void(const segment&)>;
+
+    /*! \brief Number of frames handed to the writer thread at once. */
+    static constexpr size_t CHUNK_FRAMES = 16384;
+
+private:
+    struct private_construction_tag {
+    };
+
+public:
+    /*! \brief Create a new recorder.
+     *  \param prefix Path prefix of the segment files.
+     *  \param sample_rate Audio sample rate.
+     *  \param hang_time Time to keep recording after the squelch closes, in
+     *                   seconds.
+     *  \param callback Called from the writer thread for every segment.
+     */
+    static sptr make(const std::string& prefix, int sample_rate,
+                     double hang_time, segment_callback callback);
+
+    squelch_recorder(const std::string& prefix, int sample_rate,
+                     double hang_time, segment_callback callback,
+                     private_construction_tag);
+    ~squelch_recorder() override;
+
+    int work(int noutput_items, gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override;
+
+    /*! \brief Record two channels instead of one, from the next segment. */
+    void set_stereo(bool stereo);
+
+    /*! \brief End the current segment and wait for it to be written. */
+    void close();
+
+    const std::string& prefix() const { return d_prefix; }
+    double hang_time() const { return d_hang_time; }
+
+    /*! \brief Number of segments that couldn't be written. */
+    uint64_t write_errors() const;
+
+private:
+    struct chunk {
+        std::vector<float> samples; /*!< Interleaved frames. */
+        int channels;
+        bool first;
+        bool last;
+        segment seg;
+    };
+
+    void record(const float* left, const float* right, int n);
+    void begin_segment();
+    void end_segment();
+    void submit(bool last);
+    void writer_loop();
+
+private:
+    const std::string d_prefix;
+    const int d_sample_rate;
+    const double d_hang_time;
+    const segment_callback d_callback;
+
+    std::mutex d_work_mutex; /*!< Protects the state below. */
+    bool d_sql_open; /*!< Squelch state from the last tag. */
+    bool d_stereo;
+    bool d_active; /*!< Whether a segment is being recorded. */
+    bool d_closed;
+    int d_channels;               /*!< Channels of the current segment. */
+    bool d_first;                 /*!< Next chunk starts the segment. */
+    segment d_segment;            /*!< Current segment. */
+    uint64_t d_frames;            /*!< Frames in the current segment. */
+    uint64_t d_hang;              /*!< Frames left before the segment ends. */
+    std::vector<float> d_pending; /*!< Frames not submitted yet. */
+    unsigned d_same_time;         /*!< Earlier segments in the same ms. */
+
+    mutable std::mutex d_queue_mutex;
+    std::condition_variable d_queue_cond;
+    std::deque<chunk> d_queue;
+    bool d_stop;
+    uint64_t d_write_errors;
+    std::thread d_writer;
+};
+
+#endif // VIOLETRX_DSP_SQUELCH_RECORDER
@@ -0,0 +1,44 @@
+#include "squelch_tagger_cc.h"
+#include <cstring>
+
+#include <gnuradio/io_signature.h>
+
+const pmt::pmt_t squelch_tagger_cc::TAG_KEY = pmt::intern("squelch");
+
+squelch_tagger_cc::sptr squelch_tagger_cc::make()
+{
+    return gnuradio::make_block_sptr<squelch_tagger_cc>(
+        private_construction_tag{});
+}
+
+squelch_tagger_cc::squelch_tagger_cc(private_construction_tag) :
+    gr::sync_block("squelch_tagger_cc",
+                   gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                   gr::io_signature::make(1, 1, sizeof(gr_complex))),
+    d_open(false)
+{
+}
+
+int squelch_tagger_cc::work(int noutput_items,
+                            gr_vector_const_void_star& input_items,
+                            gr_vector_void_star& output_items)
+{
+    const gr_complex* in = (const gr_complex*)input_items[0];
+    gr_complex* out = (gr_complex*)output_items[0];
+
+    std::memcpy(out, in, noutput_items * sizeof(gr_complex));
+
+    const uint64_t offset = nitems_written(0);
+    for (int i = 0; i < noutput_items; i++) {
+        // a lone zero sample while open is absorbed by the hang time of the
+        // squelch recorder
+        bool open = in[i] != gr_complex(0.0f, 0.0f);
+        if (i > 0 && open == d_open)
+            continue;
+
+        d_open = open;
+        add_item_tag(0, offset + i, TAG_KEY, pmt::from_bool(open));
+    }
+
+    return noutput_items;
+}
@@ -0,0 +1,45 @@
+#ifndef VIOLETRX_DSP_SQUELCH_TAGGER_CC
+#define VIOLETRX_DSP_SQUELCH_TAGGER_CC
+
+#include <memory>
+
+#include <gnuradio/sync_block.h>
+
+/*! \brief Tags the squelch state in the stream.
+ *  \ingroup DSP
+ *
+ * Passes the output of a gr::analog::simple_squelch_cc through unchanged,
+ * which is exactly zero while muted, and tags it with the squelch state:
+ * a "squelch" tag with a boolean value (true when open) on every transition,
+ * and on the first sample of every call to work() so that blocks connected
+ * later, or to a new receiver, learn the state as well.
+ *
+ * The tags follow the samples through the demodulators and resamplers, so
+ * sinks downstream see the squelch open and close in step with the audio,
+ * however far the squelch runs ahead of them.
+ */
+class squelch_tagger_cc : public gr::sync_block
+{
+public:
+    using sptr = std::shared_ptr<squelch_tagger_cc>;
+
+    /*! \brief Key of the squelch state tags. */
+    static const pmt::pmt_t TAG_KEY;
+
+private:
+    struct private_construction_tag {
+    };
+
+public:
+    static sptr make();
+
+    explicit squelch_tagger_cc(private_construction_tag);
+
+    int work(int noutput_items, gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override;
+
+private:
+    bool d_open; /*!< State at the last sample. */
+};
+
+#endif // VIOLETRX_DSP_SQUELCH_TAGGER_CC
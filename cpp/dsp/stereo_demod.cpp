@@ -21,10 +21,14 @@
  * the Free Software Foundation, Inc., 51 Franklin Street,
  * Boston, MA 02110-1301, USA.
  */
+#include <algorithm>
+#include <cmath>
 #include <gnuradio/io_signature.h>
-#include <math.h>
-#include <iostream>
-#include <dsp/stereo_demod.h>
+#include <gnuradio/math.h>
+#include <gnuradio/sincos.h>
+#include <volk/volk.h>
+#include "dsp/stereo_demod.h"
+#include "dsp/taps_cache.h"
 
 
 /* Create a new instance of stereo_demod and return a shared_ptr. */
@@ -40,113 +44,244 @@ static const int MAX_IN  = 1; /* Maximum number of input streams. */
 static const int MIN_OUT = 2; /* Minimum number of output streams. */
 static const int MAX_OUT = 2; /* Maximum number of output streams. */
 
+static const int CHUNK_SIZE = 1024; /* Input samples processed per pass. */
+
 /*! \brief Create stereo demodulator object.
  *
  * Use make_stereo_demod() instead.
  */
 stereo_demod::stereo_demod(float input_rate, float audio_rate, bool stereo, bool oirt)
-    : gr::hier_block2("stereo_demod",
-                     gr::io_signature::make (MIN_IN,  MAX_IN,  sizeof (float)),
-                     gr::io_signature::make (MIN_OUT, MAX_OUT, sizeof (float))),
+    : gr::block("stereo_demod",
+                gr::io_signature::make (MIN_IN,  MAX_IN,  sizeof (float)),
+                gr::io_signature::make (MIN_OUT, MAX_OUT, sizeof (float))),
     d_input_rate(input_rate),
     d_audio_rate(audio_rate),
     d_stereo(stereo),
-    d_oirt(oirt)
+    d_oirt(oirt),
+    d_step((double)input_rate / (double)audio_rate),
+    d_t(0.0),
+    d_delay(0),
+    d_pll_alpha(0.0f),
+    d_pll_beta(0.0f),
+    d_pll_phase(0.0f),
+    d_pll_freq(0.0f),
+    d_pll_min_freq(0.0f),
+    d_pll_max_freq(0.0f),
+    d_left_x1(0.0f), d_left_y1(0.0f),
+    d_right_x1(0.0f), d_right_y1(0.0f)
 {
-  double cutof_freq = d_oirt ? 15e3 : 17e3;
-  lpf0 = make_lpf_ff(d_input_rate, cutof_freq, 2e3); // FIXME
-  audio_rr0 = make_resampler_ff(d_audio_rate/d_input_rate);
-  deemph0 = make_fm_deemph(d_audio_rate, 50.0e-6);
-
-  if (d_stereo)
-  {
-    lpf1 = make_lpf_ff(d_input_rate, cutof_freq, 2e3, -2.1); // FIXME
-    audio_rr1 = make_resampler_ff(d_audio_rate/d_input_rate);
-    deemph1 = make_fm_deemph(d_audio_rate, 50.0e-6);
-
-    if (!d_oirt)
+    set_relative_rate((double)audio_rate / (double)input_rate);
+
+    /* audio low-pass filters, the L-R gain compensates for the mixer */
+    double cutof_freq = d_oirt ? 15e3 : 17e3;
+    auto lpf_taps = taps_cache::instance().low_pass(1.0, d_input_rate, cutof_freq, 2e3); // FIXME
+    d_sum_taps.assign(lpf_taps->rbegin(), lpf_taps->rend());
+    d_diff_taps.resize(d_sum_taps.size());
+    for (size_t i = 0; i < d_sum_taps.size(); i++)
+        d_diff_taps[i] = -2.1f * d_sum_taps[i];
+
+    d_sum.resize(d_sum_taps.size() + CHUNK_SIZE);
+
+    if (d_stereo)
     {
-        d_tone_taps = gr::filter::firdes::complex_band_pass(
-                                       1.0,          // gain,
-		                                   d_input_rate, // sampling_freq
-                                       18980.,       // low_cutoff_freq
-                                       19020.,       // high_cutoff_freq
-                                       5000.);       // transition_width
-        pll = gr::analog::pll_refout_cc::make(0.0002,    // loop_bw FIXME
-                                2 * (float)M_PI * 19020 / input_rate,  // max_freq
-                                2 * (float)M_PI * 18980 / input_rate); // min_freq
-        subtone = gr::blocks::multiply_cc::make();
-    } else {
-        d_tone_taps = gr::filter::firdes::complex_band_pass(
+        float min_freq = d_oirt ? 31200.f : 18980.f;
+        float max_freq = d_oirt ? 31300.f : 19020.f;
+
+        auto tone_taps = taps_cache::instance().complex_band_pass(
                                        1.0,          // gain,
                                        d_input_rate, // sampling_freq
-                                       31200.,       // low_cutoff_freq
-                                       31300.,       // high_cutoff_freq
+                                       min_freq,     // low_cutoff_freq
+                                       max_freq,     // high_cutoff_freq
                                        5000.);       // transition_width
-        pll = gr::analog::pll_refout_cc::make(0.0002,    // loop_bw FIXME
-                                2 * (float)M_PI * 31200 / input_rate,  // max_freq
-                                2 * (float)M_PI * 31300 / input_rate); // min_freq
+        d_tone_taps.assign(tone_taps->rbegin(), tone_taps->rend());
+        d_delay = (d_tone_taps.size() - 1) / 2;
+
+        d_mpx.resize(d_tone_taps.size() - 1 + CHUNK_SIZE);
+        d_diff.resize(d_diff_taps.size() + CHUNK_SIZE);
+
+        /* same loop as gr::analog::pll_refout_cc */
+        float loop_bw = 0.0002f; // FIXME
+        float damping = sqrtf(2.0f) / 2.0f;
+        float denom = (1.0f + 2.0f * damping * loop_bw + loop_bw * loop_bw);
+        d_pll_alpha = (4.0f * damping * loop_bw) / denom;
+        d_pll_beta = (4.0f * loop_bw * loop_bw) / denom;
+        d_pll_min_freq = 2 * (float)M_PI * min_freq / input_rate;
+        d_pll_max_freq = 2 * (float)M_PI * max_freq / input_rate;
     }
 
-    tone = gr::filter::fir_filter_fcc::make(1, d_tone_taps);
-    delay = gr::blocks::delay::make(sizeof(float), (d_tone_taps.size() - 1) / 2);
+    /* 50us de-emphasis at the audio rate, see fm_deemph::calculate_iir_taps() */
+    double fs = d_audio_rate;
+    double w_ca = 2.0 * fs * tan(1.0 / 50.0e-6 / (2.0 * fs));
+    double k = -w_ca / (2.0 * fs);
+    double p1 = (1.0 + k) / (1.0 - k);
+    double b0 = -k / (1.0 - k);
+    d_deemph_b0 = b0;
+    d_deemph_b1 = b0;
+    d_deemph_a1 = -p1;
+}
+
+
+stereo_demod::~stereo_demod()
+{
+
+}
+
+void stereo_demod::forecast(int noutput_items,
+                            gr_vector_int& ninput_items_required)
+{
+    ninput_items_required[0] = (int)std::ceil(noutput_items * d_step);
+}
+
+int stereo_demod::general_work(int noutput_items, gr_vector_int& ninput_items,
+                               gr_vector_const_void_star& input_items,
+                               gr_vector_void_star& output_items)
+{
+    const float* in = (const float*)input_items[0];
+    float* out_l = (float*)output_items[0];
+    float* out_r = (float*)output_items[1];
 
-    lo = gr::blocks::complex_to_imag::make();
+    int consumed = 0;
+    int produced = 0;
 
-    mixer = gr::blocks::multiply_ff::make();
+    while (produced < noutput_items)
+    {
+        /* don't consume input whose output we have no room for */
+        double t_last = d_t + (noutput_items - produced - 1) * d_step;
+        int n = std::min({CHUNK_SIZE, ninput_items[0] - consumed,
+                          (int)std::ceil(t_last) + 1});
 
-    add = gr::blocks::add_ff::make();
-    sub = gr::blocks::sub_ff::make();
+        int nout = process_chunk(in + consumed, n, out_l + produced,
+                                 out_r + produced, noutput_items - produced);
 
-    /* connect block */
-    if (!d_oirt) {
-        connect(self(), 0, tone, 0);
-        connect(self(), 0, delay, 0);
-        connect(tone, 0, pll, 0);
-        connect(pll, 0, subtone, 0);
-        connect(pll, 0, subtone, 1);
-        connect(subtone, 0, lo, 0);
+        consumed += n;
+        produced += nout;
 
-        connect(lo, 0, mixer, 0);
-    } else {
-        connect(self(), 0, tone, 0);
-        connect(self(), 0, delay, 0);
-        connect(tone, 0, pll, 0);
-        connect(pll, 0, lo, 0);
-        connect(lo, 0, mixer, 0);
+        if (n == 0 && nout == 0)
+            break;
     }
 
-    connect(delay, 0, mixer, 1);
-
-    connect(delay, 0, lpf0, 0);
-    connect(mixer, 0, lpf1, 0);
-
-    connect(lpf0, 0, audio_rr0, 0); // sum
-    connect(lpf1, 0, audio_rr1, 0); // delta
-
-    connect(audio_rr0, 0, add,   0);
-    connect(audio_rr1, 0, add,   1);
-    connect(add,       0, deemph0, 0);
-    connect(deemph0,   0, self(), 0); // left = sum + delta
-
-    connect(audio_rr0, 0, sub,   0);
-    connect(audio_rr1, 0, sub,   1);
-    connect(sub,       0, deemph1, 0);
-    connect(deemph1,   0, self(), 1); // right = sum - delta
-  }
-  else // if (!d_stereo)
-  {
-    /* connect block */
-    connect(self(), 0, lpf0, 0);
-    connect(lpf0,   0, audio_rr0, 0);
-    connect(audio_rr0, 0, deemph0, 0);
-    connect(deemph0, 0, self(), 0);
-    connect(deemph0, 0, self(), 1);
-  }
+    consume_each(consumed);
+    return produced;
 }
 
+/*! \brief Demodulate a chunk of at most CHUNK_SIZE input samples.
+ *  \return The number of produced audio samples.
+ */
+int stereo_demod::process_chunk(const float* in, int ninput, float* out_l,
+                                float* out_r, int noutput)
+{
+    int ntone = d_tone_taps.size();
+    int nlpf = d_sum_taps.size();
 
-stereo_demod::~stereo_demod()
+    if (d_stereo)
+    {
+        std::copy(in, in + ninput, d_mpx.begin() + ntone - 1);
+
+        for (int i = 0; i < ninput; i++)
+        {
+            gr_complex pilot;
+            volk_32fc_32f_dot_prod_32fc(&pilot, d_tone_taps.data(),
+                                        &d_mpx[i], ntone);
+
+            float subcarrier = pll_step(pilot);
+            float x = d_mpx[ntone - 1 + i - d_delay];
+
+            d_sum[nlpf + i] = x;
+            d_diff[nlpf + i] = x * subcarrier;
+        }
+    }
+    else
+    {
+        std::copy(in, in + ninput, d_sum.begin() + nlpf);
+    }
+
+    int nout = 0;
+    while (nout < noutput)
+    {
+        /* output sample is interpolated between these two inputs */
+        double i0 = std::floor(d_t);
+        if ((d_t > i0 ? i0 + 1 : i0) > ninput - 1)
+            break;
+
+        float sum = lpf(d_sum_taps, d_sum, d_t);
+        if (d_stereo)
+        {
+            float diff = lpf(d_diff_taps, d_diff, d_t);
+            out_l[nout] = deemph(sum + diff, d_left_x1, d_left_y1);   // left = sum + delta
+            out_r[nout] = deemph(sum - diff, d_right_x1, d_right_y1); // right = sum - delta
+        }
+        else
+        {
+            out_l[nout] = out_r[nout] = deemph(sum, d_left_x1, d_left_y1);
+        }
+
+        nout++;
+        d_t += d_step;
+    }
+    d_t -= ninput;
+
+    /* keep the tails for the next chunk */
+    std::copy(d_sum.begin() + ninput, d_sum.begin() + ninput + nlpf, d_sum.begin());
+    if (d_stereo)
+    {
+        std::copy(d_diff.begin() + ninput, d_diff.begin() + ninput + nlpf, d_diff.begin());
+        std::copy(d_mpx.begin() + ninput, d_mpx.begin() + ninput + ntone - 1, d_mpx.begin());
+    }
+
+    return nout;
+}
+
+/*! \brief Advance the pilot PLL by one sample.
+ *  \return The regenerated subcarrier.
+ */
+float stereo_demod::pll_step(gr_complex pilot)
+{
+    /* the reference is taken before advancing the loop so that it lines up
+       with the delayed multiplex sample */
+    float s, c;
+    gr::sincosf(d_pll_phase, &s, &c);
+
+    float error = gr::fast_atan2f(pilot.imag(), pilot.real()) - d_pll_phase;
+    if (error > (float)M_PI)
+        error -= 2 * (float)M_PI;
+    else if (error < -(float)M_PI)
+        error += 2 * (float)M_PI;
+
+    d_pll_freq += d_pll_beta * error;
+    d_pll_phase += d_pll_freq + d_pll_alpha * error;
+
+    while (d_pll_phase > 2 * (float)M_PI)
+        d_pll_phase -= 2 * (float)M_PI;
+    while (d_pll_phase < -2 * (float)M_PI)
+        d_pll_phase += 2 * (float)M_PI;
+
+    d_pll_freq = std::clamp(d_pll_freq, d_pll_min_freq, d_pll_max_freq);
+
+    /* 38 kHz subcarrier is the imaginary part of the squared 19 kHz pilot,
+       the OIRT pilot is used as is */
+    return d_oirt ? s : 2.0f * s * c;
+}
+
+/*! \brief Evaluate a low-pass filter at (fractional) sample position t. */
+float stereo_demod::lpf(const volk::vector<float>& taps,
+                        const volk::vector<float>& buf, double t) const
 {
+    int i0 = (int)std::floor(t);
+    float frac = t - i0;
+    float y0, y1;
+
+    volk_32f_x2_dot_prod_32f(&y0, taps.data(), &buf[i0 + 1], taps.size());
+    if (frac == 0.0f)
+        return y0;
 
+    volk_32f_x2_dot_prod_32f(&y1, taps.data(), &buf[i0 + 2], taps.size());
+    return y0 + frac * (y1 - y0);
+}
+
+float stereo_demod::deemph(float x, float& x1, float& y1) const
+{
+    float y = d_deemph_b0 * x + d_deemph_b1 * x1 - d_deemph_a1 * y1;
+    x1 = x;
+    y1 = y;
+    return y;
 }
@@ -24,19 +24,9 @@
 #ifndef STEREO_DEMOD_H
 #define STEREO_DEMOD_H
 
-#include "dsp/fm_deemph.h"
-#include "dsp/lpf.h"
-#include "dsp/resampler_xx.h"
-#include <gnuradio/analog/pll_refout_cc.h>
-#include <gnuradio/blocks/add_blk.h>
-#include <gnuradio/blocks/complex_to_imag.h>
-#include <gnuradio/blocks/delay.h>
-#include <gnuradio/blocks/multiply.h>
-#include <gnuradio/blocks/multiply_const.h>
-#include <gnuradio/blocks/sub.h>
-#include <gnuradio/filter/fir_filter_blk.h>
-#include <gnuradio/filter/firdes.h>
-#include <gnuradio/hier_block2.h>
+#include <gnuradio/block.h>
+#include <gnuradio/gr_complex.h>
+#include <volk/volk_alloc.hh>
 #include <vector>
 
 class stereo_demod;
@@ -61,37 +51,65 @@ stereo_demod_sptr make_stereo_demod(float quad_rate = 120e3,
  *
  * This class implements the stereo demodulator for 87.5...108 MHz band.
  *
+ * Pilot band-pass, pilot PLL, subcarrier regeneration, L+R / L-R matrixing,
+ * low-pass filtering, resampling to the audio rate and de-emphasis are all
+ * done by this single block. The input is processed in small chunks so that
+ * the intermediate signals stay in cache, and the audio low-pass filters are
+ * only evaluated at the output instants.
  */
-class stereo_demod : public gr::hier_block2
+class stereo_demod : public gr::block
 {
 public:
     stereo_demod(float input_rate, float audio_rate, bool stereo, bool oirt);
     ~stereo_demod();
 
+    void forecast(int noutput_items,
+                  gr_vector_int& ninput_items_required) override;
+
+    int general_work(int noutput_items, gr_vector_int& ninput_items,
+                     gr_vector_const_void_star& input_items,
+                     gr_vector_void_star& output_items) override;
+
 private:
-    /* GR blocks */
-    gr::filter::fir_filter_fcc::sptr tone; /*!< Pilot tone BPF. */
-    gr::blocks::delay::sptr delay;       /*!< Delay to match pilot tone BPF. */
-    gr::analog::pll_refout_cc::sptr pll; /*!< Pilot tone PLL. */
-    gr::blocks::multiply_cc::sptr subtone; /*!< Stereo subtone. */
-    gr::blocks::complex_to_imag::sptr lo;  /*!< Complex tone imag. */
-    gr::blocks::multiply_ff::sptr mixer;   /*!< Balance mixer. */
-    lpf_ff_sptr lpf0;                      /*!< Low-pass filter #0. */
-    lpf_ff_sptr lpf1;                      /*!< Low-pass filter #1. */
-    resampler_ff_sptr audio_rr0;           /*!< Audio resampler #0. */
-    resampler_ff_sptr audio_rr1;           /*!< Audio resampler #1. */
-    fm_deemph_sptr deemph0;                /*!< FM de-emphasis #0. */
-    fm_deemph_sptr deemph1;                /*!< FM de-emphasis #1. */
-    gr::blocks::add_ff::sptr add;          /*!< Left stereo channel. */
-    gr::blocks::sub_ff::sptr sub;          /*!< Right stereo channel. */
+    int process_chunk(const float* in, int ninput, float* out_l,
+                      float* out_r, int noutput);
+    float pll_step(gr_complex pilot);
+    float lpf(const volk::vector<float>& taps, const volk::vector<float>& buf,
+              double t) const;
+    float deemph(float x, float& x1, float& y1) const;
 
     /* other parameters */
     float d_input_rate; /*! Input rate. */
     float d_audio_rate; /*! Audio rate. */
     bool d_stereo;      /*! On/off stereo mode. */
     bool d_oirt;
-    std::vector<gr_complex> d_tone_taps; /*! Tone BPF taps. */
-    std::vector<float> d_pll_taps;       /*! Subtone BPF taps. */
+    double d_step;      /*! Input samples per output sample. */
+    double d_t;         /*! Position of next output sample in the current chunk. */
+
+    volk::vector<gr_complex> d_tone_taps; /*! Tone BPF taps (reversed). */
+    volk::vector<float> d_sum_taps;       /*! L+R LPF taps (reversed). */
+    volk::vector<float> d_diff_taps;      /*! L-R LPF taps (reversed). */
+    int d_delay;                          /*! Delay to match pilot tone BPF. */
+
+    /* chunk buffers, each starting with the tail of the previous chunk */
+    volk::vector<float> d_mpx;  /*! Raw multiplex signal. */
+    volk::vector<float> d_sum;  /*! L+R before low-pass filtering. */
+    volk::vector<float> d_diff; /*! L-R before low-pass filtering. */
+
+    /* pilot PLL */
+    float d_pll_alpha;
+    float d_pll_beta;
+    float d_pll_phase;
+    float d_pll_freq;
+    float d_pll_min_freq;
+    float d_pll_max_freq;
+
+    /* de-emphasis IIR filter, see fm_deemph */
+    float d_deemph_b0;
+    float d_deemph_b1;
+    float d_deemph_a1;
+    float d_left_x1, d_left_y1;
+    float d_right_x1, d_right_y1;
 };
 
 #endif // STEREO_DEMOD_H
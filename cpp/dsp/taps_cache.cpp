@@ -0,0 +1,161 @@
+#include <algorithm>
+
+#include <gnuradio/fft/fft.h>
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/math.h>
+
+#include "dsp/taps_cache.h"
+
+taps_cache& taps_cache::instance()
+{
+    static taps_cache cache;
+    return cache;
+}
+
+taps_cache::taps_cache() :
+    d_capacity(DEFAULT_CAPACITY),
+    d_hits(0),
+    d_misses(0)
+{
+}
+
+taps_cache::taps_sptr<float> taps_cache::low_pass(double gain,
+                                                  double sampling_freq,
+                                                  double cutoff_freq,
+                                                  double transition_width)
+{
+    key k{design::LOW_PASS,
+          {gain, sampling_freq, cutoff_freq, transition_width, 0, 0}};
+
+    return get_or_design(d_real_taps, k, [&]() {
+        return gr::filter::firdes::low_pass(gain, sampling_freq, cutoff_freq,
+                                            transition_width);
+    });
+}
+
+taps_cache::taps_sptr<gr_complex>
+taps_cache::complex_band_pass(double gain, double sampling_freq,
+                              double low_cutoff_freq, double high_cutoff_freq,
+                              double transition_width)
+{
+    key k{design::COMPLEX_BAND_PASS,
+          {gain, sampling_freq, low_cutoff_freq, high_cutoff_freq,
+           transition_width, 0}};
+
+    return get_or_design(d_complex_taps, k, [&]() {
+        return gr::filter::firdes::complex_band_pass(
+            gain, sampling_freq, low_cutoff_freq, high_cutoff_freq,
+            transition_width);
+    });
+}
+
+taps_cache::taps_sptr<gr_complex>
+taps_cache::xformed_low_pass(double gain, double sampling_freq,
+                             double cutoff_freq, double transition_width,
+                             double offset, int fftsize)
+{
+    key k{design::XFORMED_LOW_PASS,
+          {gain, sampling_freq, cutoff_freq, transition_width, offset,
+           (double)fftsize}};
+
+    return get_or_design(d_complex_taps, k, [&]() {
+        taps_sptr<float> proto =
+            low_pass(gain, sampling_freq, cutoff_freq, transition_width);
+
+        gr::fft::fft_complex_fwd fwdfft(fftsize, 1);
+        gr_complex* in = fwdfft.get_inbuf();
+        gr_complex* out = fwdfft.get_outbuf();
+
+        float fwT0 = 2 * GR_M_PI * offset / sampling_freq;
+        float scale = 1.0 / fftsize;
+        int ntaps = std::min((int)proto->size(), fftsize);
+
+        // Copy shifted taps into first ntaps slots, then pad with zeros
+        for (int i = 0; i < ntaps; i++)
+            in[i] = (*proto)[i] * exp(gr_complex(0, i * fwT0)) * scale;
+
+        for (int i = ntaps; i < fftsize; i++)
+            in[i] = 0;
+
+        fwdfft.execute();
+
+        return std::vector<gr_complex>(out, out + fftsize);
+    });
+}
+
+template <typename T, typename Func>
+taps_cache::taps_sptr<T> taps_cache::get_or_design(lru<T>& lru, const key& k,
+                                                   Func&& design_func)
+{
+    {
+        std::lock_guard lock{d_mutex};
+
+        auto it = lru.index.find(k);
+        if (it != lru.index.end()) {
+            d_hits++;
+            lru.entries.splice(lru.entries.begin(), lru.entries, it->second);
+            return it->second->second;
+        }
+
+        d_misses++;
+    }
+
+    // designing the taps can take a while, so don't block other users of the
+    // cache in the meantime
+    auto taps = std::make_shared<const std::vector<T>>(design_func());
+
+    std::lock_guard lock{d_mutex};
+
+    // someone else might have designed the same taps while we were at it
+    auto it = lru.index.find(k);
+    if (it != lru.index.end()) {
+        lru.entries.splice(lru.entries.begin(), lru.entries, it->second);
+        return it->second->second;
+    }
+
+    lru.entries.emplace_front(k, taps);
+    lru.index.emplace(k, lru.entries.begin());
+    trim(lru);
+
+    return taps;
+}
+
+template <typename T>
+void taps_cache::trim(lru<T>& lru)
+{
+    while (lru.entries.size() > d_capacity) {
+        lru.index.erase(lru.entries.back().first);
+        lru.entries.pop_back();
+    }
+}
+
+taps_cache::stats taps_cache::get_stats() const
+{
+    std::lock_guard lock{d_mutex};
+
+    return stats{
+        .hits = d_hits,
+        .misses = d_misses,
+        .size = d_real_taps.entries.size() + d_complex_taps.entries.size(),
+        .capacity = d_capacity,
+    };
+}
+
+void taps_cache::set_capacity(size_t capacity)
+{
+    std::lock_guard lock{d_mutex};
+
+    d_capacity = capacity;
+    trim(d_real_taps);
+    trim(d_complex_taps);
+}
+
+void taps_cache::clear()
+{
+    std::lock_guard lock{d_mutex};
+
+    d_real_taps.entries.clear();
+    d_real_taps.index.clear();
+    d_complex_taps.entries.clear();
+    d_complex_taps.index.clear();
+}
@@ -0,0 +1,114 @@
+#ifndef VIOLETRX_DSP_TAPS_CACHE
+#define VIOLETRX_DSP_TAPS_CACHE
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <gnuradio/gr_complex.h>
+
+/*! \brief Process-wide LRU cache of designed filter taps.
+ *  \ingroup DSP
+ *
+ * Every VFO designs its filters independently, and a lot of them end up with
+ * the exact same taps (same preset, same sample rate). This cache memoizes the
+ * gr::filter::firdes designs used by the dsp blocks, as well as the forward
+ * FFT transforms used by the frequency domain filters, keyed by their design
+ * parameters.
+ *
+ * Returned taps are immutable and shared, so they stay valid even after being
+ * evicted from the cache. All member functions are thread-safe.
+ */
+class taps_cache
+{
+public:
+    template <typename T>
+    using taps_sptr = std::shared_ptr<const std::vector<T>>;
+
+    struct stats {
+        uint64_t hits;
+        uint64_t misses;
+        size_t size;
+        size_t capacity;
+    };
+
+    static constexpr size_t DEFAULT_CAPACITY = 128;
+
+public:
+    static taps_cache& instance();
+
+    /*! \brief Cached gr::filter::firdes::low_pass(). */
+    taps_sptr<float> low_pass(double gain, double sampling_freq,
+                              double cutoff_freq, double transition_width);
+
+    /*! \brief Cached gr::filter::firdes::complex_band_pass(). */
+    taps_sptr<gr_complex> complex_band_pass(double gain, double sampling_freq,
+                                            double low_cutoff_freq,
+                                            double high_cutoff_freq,
+                                            double transition_width);
+
+    /*! \brief Forward transform of a low pass filter shifted by \p offset.
+     *
+     * The low pass taps are modulated by exp(j*2*pi*offset/sampling_freq),
+     * scaled by 1/fftsize, zero padded to \p fftsize and transformed, which
+     * is what an overlap-save filter multiplies its input spectrum with.
+     */
+    taps_sptr<gr_complex> xformed_low_pass(double gain, double sampling_freq,
+                                           double cutoff_freq,
+                                           double transition_width,
+                                           double offset, int fftsize);
+
+    stats get_stats() const;
+    void set_capacity(size_t capacity);
+    void clear();
+
+private:
+    taps_cache();
+
+    enum class design {
+        LOW_PASS,
+        COMPLEX_BAND_PASS,
+        XFORMED_LOW_PASS,
+    };
+
+    struct key {
+        design type;
+        std::array<double, 6> params;
+
+        bool operator<(const key& other) const
+        {
+            if (type != other.type)
+                return type < other.type;
+            return params < other.params;
+        }
+    };
+
+    template <typename T>
+    struct lru {
+        using list_type = std::list<std::pair<key, taps_sptr<T>>>;
+
+        list_type entries; // most recently used first
+        std::map<key, typename list_type::iterator> index;
+    };
+
+    template <typename T, typename Func>
+    taps_sptr<T> get_or_design(lru<T>& lru, const key& k, Func&& design_func);
+
+    template <typename T>
+    void trim(lru<T>& lru);
+
+private:
+    mutable std::mutex d_mutex;
+    size_t d_capacity;
+    uint64_t d_hits;
+    uint64_t d_misses;
+
+    lru<float> d_real_taps;
+    lru<gr_complex> d_complex_taps;
+};
+
+#endif // VIOLETRX_DSP_TAPS_CACHE
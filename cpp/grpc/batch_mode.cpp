@@ -0,0 +1,492 @@
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+
+#include <spdlog/spdlog.h>
+#include <yaml-cpp/yaml.h>
+
+#include "async_core/async_vfo.h"
+#include "async_core/error_codes.h"
+#include "batch_mode.h"
+#include "dsp/iq_file_source.h"
+
+namespace violetrx
+{
+
+/* How often the sniffers are emptied. */
+static constexpr auto POLL_INTERVAL = std::chrono::milliseconds(20);
+
+static const std::pair<const char*, Demod> DEMOD_NAMES[] = {
+    {"off", Demod::OFF},
+    {"raw", Demod::RAW},
+    {"am", Demod::AM},
+    {"am_sync", Demod::AM_SYNC},
+    {"lsb", Demod::LSB},
+    {"usb", Demod::USB},
+    {"cwl", Demod::CWL},
+    {"cwu", Demod::CWU},
+    {"nfm", Demod::NFM},
+    {"wfm_mono", Demod::WFM_MONO},
+    {"wfm_stereo", Demod::WFM_STEREO},
+    {"wfm_stereo_oirt", Demod::WFM_STEREO_OIRT},
+};
+
+static const std::pair<const char*, FilterShape> FILTER_SHAPE_NAMES[] = {
+    {"soft", FilterShape::SOFT},
+    {"normal", FilterShape::NORMAL},
+    {"sharp", FilterShape::SHARP},
+};
+
+static volatile std::sig_atomic_t interrupted = 0;
+
+static void onSignal(int) { interrupted = 1; }
+
+template <typename T, size_t N>
+static T parseName(const std::pair<const char*, T> (&names)[N],
+                   const std::string& name, const char* what)
+{
+    for (const auto& [n, value] : names) {
+        if (name == n)
+            return value;
+    }
+
+    throw std::runtime_error(fmt::format("unknown {} {}", what, name));
+}
+
+template <typename T, size_t N>
+static const char* nameOf(const std::pair<const char*, T> (&names)[N],
+                          T value)
+{
+    for (const auto& [n, v] : names) {
+        if (v == value)
+            return n;
+    }
+
+    return "unknown";
+}
+
+static BatchVfoConfig parseVfo(const YAML::Node& node, size_t index)
+{
+    BatchVfoConfig vfo;
+
+    if (!node.IsMap())
+        throw std::runtime_error(fmt::format("VFO {} is not a map", index));
+
+    vfo.name = node["name"] ? node["name"].as<std::string>()
+                            : fmt::format("vfo{}", index);
+
+    if (!node["offset"])
+        throw std::runtime_error(fmt::format("VFO {} has no offset", vfo.name));
+    vfo.offset = node["offset"].as<double>();
+
+    if (node["demod"])
+        vfo.demod =
+            parseName(DEMOD_NAMES, node["demod"].as<std::string>(), "demod");
+
+    if (const YAML::Node& filter = node["filter"]) {
+        vfo.filter = Filter{
+            .shape = filter["shape"]
+                         ? parseName(FILTER_SHAPE_NAMES,
+                                     filter["shape"].as<std::string>(),
+                                     "filter shape")
+                         : FilterShape::NORMAL,
+            .low = (int32_t)filter["low"].as<double>(),
+            .high = (int32_t)filter["high"].as<double>(),
+        };
+    }
+
+    if (node["squelch"])
+        vfo.sqlLevel = node["squelch"].as<double>();
+
+    if (node["audio_gain"])
+        vfo.audioGain = node["audio_gain"].as<float>();
+
+    if (node["record"])
+        vfo.recordPath = node["record"].as<std::string>();
+
+    if (const YAML::Node& sniffer = node["sniffer"]) {
+        if (sniffer.IsScalar()) {
+            vfo.snifferPath = sniffer.as<std::string>();
+        } else {
+            vfo.snifferPath = sniffer["path"].as<std::string>();
+            if (sniffer["rate"])
+                vfo.snifferRate = sniffer["rate"].as<int>();
+            if (sniffer["buffer"])
+                vfo.snifferBuffer = sniffer["buffer"].as<int>();
+        }
+    }
+
+    // the channel stalls whenever the sniffer is full, so a bigger buffer
+    // keeps unthrottled playback going between two polls
+    if (vfo.snifferBuffer <= 0)
+        vfo.snifferBuffer = 4 * vfo.snifferRate;
+
+    return vfo;
+}
+
+BatchConfig loadBatchConfig(const std::string& filename)
+{
+    BatchConfig config;
+
+    // YAML is a superset of JSON, so this takes both
+    YAML::Node root;
+    try {
+        root = YAML::LoadFile(filename);
+    } catch (const YAML::Exception& e) {
+        throw std::runtime_error(
+            fmt::format("can't load {}: {}", filename, e.what()));
+    }
+
+    YAML::Node vfos = root.IsMap() ? root["vfos"] : root;
+    if (!vfos.IsSequence())
+        throw std::runtime_error(filename + " has no list of VFOs");
+
+    try {
+        for (size_t i = 0; i < vfos.size(); i++)
+            config.vfos.push_back(parseVfo(vfos[i], i));
+    } catch (const YAML::Exception& e) {
+        throw std::runtime_error(
+            fmt::format("invalid VFO in {}: {}", filename, e.what()));
+    }
+
+    return config;
+}
+
+/* Run an asynchronous call and wait for its result. */
+template <typename... Args, typename Function>
+static std::tuple<ErrorCode, Args...> blockingCall(Function&& function)
+{
+    std::promise<std::tuple<ErrorCode, Args...>> promise;
+    auto future = promise.get_future();
+
+    function([&promise](ErrorCode err, Args... args) {
+        promise.set_value({err, std::move(args)...});
+    });
+
+    return future.get();
+}
+
+static void check(ErrorCode err, const std::string& what)
+{
+    if (err != ErrorCode::OK)
+        throw std::runtime_error(what + ": " + errorMsg(err));
+}
+
+namespace
+{
+
+struct Channel {
+    const BatchVfoConfig& config;
+    std::shared_ptr<AsyncVfo> vfo;
+    std::shared_ptr<const rx_meter_stats> stats;
+    FILE* sniffer = nullptr;
+    std::vector<float> snifferBuffer;
+    uint64_t snifferSamples = 0;
+};
+
+struct DoneWaiter {
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool done = false;
+    std::chrono::steady_clock::time_point time;
+
+    void notify()
+    {
+        std::lock_guard lock{mutex};
+        done = true;
+        time = std::chrono::steady_clock::now();
+        cond.notify_one();
+    }
+};
+
+} // namespace
+
+static void setupChannel(AsyncReceiver& receiver, Channel& ch)
+{
+    const BatchVfoConfig& conf = ch.config;
+    ErrorCode err;
+
+    AsyncVfoIfaceSptr vfo;
+    std::tie(err, vfo) = blockingCall<AsyncVfoIfaceSptr>(
+        [&](auto cb) { receiver.addVfoChannel(std::move(cb)); });
+    check(err, conf.name + ": can't add VFO");
+
+    ch.vfo = std::static_pointer_cast<AsyncVfo>(vfo);
+    ch.stats = ch.vfo->getSignalStats();
+
+    std::tie(err) = blockingCall(
+        [&](auto cb) { ch.vfo->setDemod(conf.demod, std::move(cb)); });
+    check(err, conf.name + ": can't set demod");
+
+    std::tie(err) = blockingCall(
+        [&](auto cb) { ch.vfo->setFilterOffset(conf.offset, std::move(cb)); });
+    check(err, conf.name + ": can't set offset");
+
+    if (conf.filter) {
+        std::tie(err) = blockingCall([&](auto cb) {
+            ch.vfo->setFilter(conf.filter->low, conf.filter->high,
+                              conf.filter->shape, std::move(cb));
+        });
+        check(err, conf.name + ": can't set filter");
+    }
+
+    if (conf.sqlLevel) {
+        std::tie(err) = blockingCall([&](auto cb) {
+            ch.vfo->setSqlLevel(*conf.sqlLevel, std::move(cb));
+        });
+        check(err, conf.name + ": can't set squelch");
+    }
+
+    if (conf.audioGain) {
+        std::tie(err) = blockingCall([&](auto cb) {
+            ch.vfo->setAudioGain(*conf.audioGain, std::move(cb));
+        });
+        check(err, conf.name + ": can't set audio gain");
+    }
+
+    // armed before the receiver starts, so that nothing is missed
+    if (!conf.recordPath.empty()) {
+        std::tie(err) = blockingCall([&](auto cb) {
+            ch.vfo->startAudioRecording(conf.recordPath, std::move(cb));
+        });
+        check(err, conf.name + ": can't record to " + conf.recordPath);
+    }
+
+    if (!conf.snifferPath.empty()) {
+        ch.sniffer = std::fopen(conf.snifferPath.c_str(), "wb");
+        if (!ch.sniffer) {
+            throw std::runtime_error(conf.name + ": can't open " +
+                                     conf.snifferPath);
+        }
+
+        std::tie(err) = blockingCall([&](auto cb) {
+            ch.vfo->startBlockingSniffer(conf.snifferRate, conf.snifferBuffer,
+                                         std::move(cb));
+        });
+        check(err, conf.name + ": can't start sniffer");
+
+        // the buffer of the sniffer may have been rounded up
+        ch.snifferBuffer.resize(ch.vfo->inner()->get_sniffer_buffsize());
+    }
+}
+
+/* Move the sniffed audio to its file, which lets the channel go on. Returns
+ * the number of sniffed samples.
+ *
+ * The sniffer is read directly: the worker waits for the flow graph to drain
+ * at the end of the file, and the graph waits for the sniffers. */
+static int pollChannel(Channel& ch)
+{
+    if (!ch.sniffer)
+        return 0;
+
+    int num = ch.vfo->readSnifferData(ch.snifferBuffer.data(),
+                                      (int)ch.snifferBuffer.size());
+    if (num <= 0)
+        return 0;
+
+    std::fwrite(ch.snifferBuffer.data(), sizeof(float), num, ch.sniffer);
+    ch.snifferSamples += num;
+
+    return num;
+}
+
+static void finishChannel(Channel& ch)
+{
+    if (ch.sniffer) {
+        // whatever was sniffed since the last poll
+        while (pollChannel(ch) > 0)
+            ;
+        blockingCall([&](auto cb) { ch.vfo->stopSniffer(std::move(cb)); });
+        std::fclose(ch.sniffer);
+        ch.sniffer = nullptr;
+    }
+
+    // finalizes the WAV header
+    if (!ch.config.recordPath.empty()) {
+        blockingCall(
+            [&](auto cb) { ch.vfo->stopAudioRecording(std::move(cb)); });
+    }
+}
+
+static void printStats(const std::string& device,
+                       const iq_file_source::config& input, double elapsed,
+                       bool complete, const std::vector<Channel>& channels)
+{
+    size_t nsamples = std::filesystem::file_size(input.filename) /
+                      iq_file_sink::sample_size(input.format);
+    double duration = nsamples / input.sample_rate;
+
+    YAML::Emitter out;
+    out << YAML::BeginMap;
+
+    out << YAML::Key << "input" << YAML::Value << YAML::BeginMap;
+    out << YAML::Key << "device" << YAML::Value << device;
+    out << YAML::Key << "sample_rate" << YAML::Value << input.sample_rate;
+    out << YAML::Key << "samples" << YAML::Value << nsamples;
+    out << YAML::Key << "duration" << YAML::Value << duration;
+    out << YAML::Key << "complete" << YAML::Value << complete;
+    out << YAML::Key << "elapsed" << YAML::Value << elapsed;
+    if (complete && elapsed > 0) {
+        out << YAML::Key << "realtime_factor" << YAML::Value
+            << duration / elapsed;
+        out << YAML::Key << "samples_per_second" << YAML::Value
+            << nsamples / elapsed;
+    }
+    out << YAML::EndMap;
+
+    out << YAML::Key << "vfos" << YAML::Value << YAML::BeginSeq;
+    for (const auto& ch : channels) {
+        const BatchVfoConfig& conf = ch.config;
+
+        out << YAML::BeginMap;
+        out << YAML::Key << "name" << YAML::Value << conf.name;
+        out << YAML::Key << "offset" << YAML::Value << conf.offset;
+        out << YAML::Key << "demod" << YAML::Value
+            << nameOf(DEMOD_NAMES, conf.demod);
+        if (uint64_t samples = ch.stats->samples.load()) {
+            // level of the mean power, not the mean of the levels
+            double power = ch.stats->power_sum.load() / samples;
+            out << YAML::Key << "signal_mean" << YAML::Value
+                << 10.0 * std::log10(power + 1.0e-20);
+            out << YAML::Key << "signal_peak" << YAML::Value
+                << ch.stats->peak_db.load();
+            if (conf.sqlLevel) {
+                out << YAML::Key << "squelch_open" << YAML::Value
+                    << (double)ch.stats->sql_open_samples.load() / samples;
+            }
+        }
+        if (!conf.recordPath.empty())
+            out << YAML::Key << "record" << YAML::Value << conf.recordPath;
+        if (!conf.snifferPath.empty()) {
+            out << YAML::Key << "sniffer" << YAML::Value << conf.snifferPath;
+            out << YAML::Key << "sniffer_samples" << YAML::Value
+                << ch.snifferSamples;
+        }
+        out << YAML::EndMap;
+    }
+    out << YAML::EndSeq;
+
+    out << YAML::EndMap;
+
+    std::cout << out.c_str() << std::endl;
+}
+
+int runBatch(std::shared_ptr<AsyncReceiver> receiver, const std::string& input,
+             const BatchConfig& config)
+{
+    using namespace std::chrono;
+
+    std::string device = iq_file_source::is_device_string(input)
+                             ? input
+                             : iq_file_source::make_device_string(input);
+
+    iq_file_source::config input_conf;
+    try {
+        input_conf = iq_file_source::parse_device_string(device);
+    } catch (const std::exception& e) {
+        spdlog::error("{}", e.what());
+        return 1;
+    }
+
+    DoneWaiter waiter;
+    Connection connection;
+    std::vector<Channel> channels;
+    channels.reserve(config.vfos.size());
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    steady_clock::time_point start;
+
+    try {
+        ErrorCode err;
+
+        std::tie(err, connection) = blockingCall<Connection>([&](auto cb) {
+            receiver->subscribe(
+                [&waiter](const ReceiverEvent& event) {
+                    if (std::holds_alternative<InputEof>(event))
+                        waiter.notify();
+                },
+                std::move(cb));
+        });
+        check(err, "can't subscribe to the receiver");
+
+        std::tie(err) = blockingCall(
+            [&](auto cb) { receiver->setInputDevice(device, std::move(cb)); });
+        check(err, "can't open " + input_conf.filename);
+
+        for (const auto& vfo : config.vfos) {
+            channels.push_back(Channel{.config = vfo});
+            setupChannel(*receiver, channels.back());
+        }
+
+        spdlog::info("Decoding {} with {} VFOs", input_conf.filename,
+                     channels.size());
+
+        start = steady_clock::now();
+        std::tie(err) =
+            blockingCall([&](auto cb) { receiver->start(std::move(cb)); });
+        check(err, "can't start the receiver");
+    } catch (const std::exception& e) {
+        spdlog::error("{}", e.what());
+        for (auto& ch : channels) {
+            if (ch.sniffer)
+                std::fclose(ch.sniffer);
+        }
+        receiver->unsubscribe(connection);
+        return 1;
+    }
+
+    // the receiver stops itself once everything up to the end of the file
+    // has gone through the flow graph. The sniffers are drained until then,
+    // also while an interrupted receiver stops.
+    steady_clock::time_point end;
+    bool stopping = false;
+    for (;;) {
+        {
+            std::unique_lock lock{waiter.mutex};
+            if (waiter.cond.wait_for(lock, POLL_INTERVAL,
+                                     [&] { return waiter.done; })) {
+                end = waiter.time;
+                break;
+            }
+        }
+
+        if (interrupted && !stopping) {
+            spdlog::warn("Interrupted, stopping");
+            receiver->stop([&waiter](ErrorCode) { waiter.notify(); });
+            stopping = true;
+        }
+
+        for (auto& ch : channels)
+            pollChannel(ch);
+    }
+
+    // the stop callback holds on to the waiter
+    if (stopping)
+        blockingCall([&](auto cb) { receiver->synchronize(std::move(cb)); });
+
+    for (auto& ch : channels)
+        finishChannel(ch);
+
+    receiver->unsubscribe(connection);
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+
+    printStats(device, input_conf, duration<double>(end - start).count(),
+               !interrupted, channels);
+
+    return interrupted ? 1 : 0;
+}
+
+} // namespace violetrx
@@ -0,0 +1,58 @@
+#ifndef VIOLETRX_GRPC_BATCH_MODE_H
+#define VIOLETRX_GRPC_BATCH_MODE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "async_core/async_receiver.h"
+#include "async_core/types.h"
+
+namespace violetrx
+{
+
+struct BatchVfoConfig {
+    std::string name;
+    int64_t offset = 0;
+    Demod demod = Demod::NFM;
+    std::optional<Filter> filter;
+    std::optional<double> sqlLevel;
+    std::optional<float> audioGain;
+    std::string recordPath;  /*!< WAV file, empty to not record. */
+    std::string snifferPath; /*!< Raw float32 audio, empty to not sniff. */
+    int snifferRate = 48000;
+    int snifferBuffer = 0; /*!< In samples, 0 for 4 seconds. */
+};
+
+struct BatchConfig {
+    std::vector<BatchVfoConfig> vfos;
+};
+
+/* Load the VFO definitions of a batch run from a YAML or JSON file.
+ *
+ * The file holds either a list of VFOs, or a map with a "vfos" list. Each
+ * VFO has the keys name, offset, demod, filter (low, high, shape), squelch,
+ * audio_gain, record (WAV path) and sniffer (path, rate, buffer), and all of
+ * them but offset are optional.
+ *
+ * Throws std::runtime_error on invalid files. */
+BatchConfig loadBatchConfig(const std::string& filename);
+
+/* Decode an I/Q file with the VFOs of a batch configuration, as fast as the
+ * CPU allows, and print per-channel statistics to stdout once the end of the
+ * file is reached.
+ *
+ * The statistics are accumulated by the flow graph for every sample, the
+ * sniffers stall their channel rather than drop audio, and the flow graph
+ * drains completely at the end of the file before the statistics are printed,
+ * so the results don't depend on the speed of the machine.
+ *
+ * \p input is a path or an iqfile= device string. Returns the process exit
+ * code. */
+int runBatch(std::shared_ptr<AsyncReceiver> receiver, const std::string& input,
+             const BatchConfig& config);
+
+} // namespace violetrx
+
+#endif // VIOLETRX_GRPC_BATCH_MODE_H
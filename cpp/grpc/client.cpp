@@ -92,6 +92,28 @@ void GrpcClient::GetDevices(Callback<std::vector<Device>> callback)
         WRAP(data, call, &GrpcClient::OnGetDevicesCallDone));
 }
 
+void GrpcClient::GetPerfStats(Callback<PerfStats> callback)
+{
+    auto [call, data] = Allocate<GetPerfStatsCall>();
+
+    data.callback = std::move(callback);
+
+    stub_->async()->GetPerfStats(
+        &data.context, &data.request, &data.response,
+        WRAP(data, call, &GrpcClient::OnGetPerfStatsCallDone));
+}
+
+void GrpcClient::GetWorkerStats(Callback<WorkerStats> callback)
+{
+    auto [call, data] = Allocate<GetWorkerStatsCall>();
+
+    data.callback = std::move(callback);
+
+    stub_->async()->GetWorkerStats(
+        &data.context, &data.request, &data.response,
+        WRAP(data, call, &GrpcClient::OnGetWorkerStatsCallDone));
+}
+
 void GrpcClient::Stop(Callback<> callback)
 {
     auto [call, data] = Allocate<StopCall>();
@@ -679,11 +701,15 @@ class GrpcClient::EventsReactor
 public:
     EventsReactor(std::shared_ptr<Receiver::Rx::Stub> stub,
                   EventHandler callback,
-                  std::shared_ptr<WorkerThread> callback_thread) :
+                  std::shared_ptr<WorkerThread> callback_thread,
+                  std::optional<int64_t> last_seen_event_id) :
         callback_thread_{std::move(callback_thread)},
         callback_{std::move(callback)},
         unsubscribed_{false}
     {
+        if (last_seen_event_id) {
+            request_.set_last_seen_event_id(*last_seen_event_id);
+        }
         stub->async()->Subscribe(&context_, &request_, this);
         StartRead(&response_);
         StartCall();
@@ -753,7 +779,7 @@ public:
 
 private:
     grpc::ClientContext context_;
-    google::protobuf::Empty request_;
+    Receiver::SubscribeRequest request_;
     Receiver::Event response_;
 
     std::shared_ptr<WorkerThread> callback_thread_;
@@ -762,9 +788,11 @@ private:
     bool unsubscribed_;
 };
 
-void GrpcClient::Subscribe(EventHandler callback)
+void GrpcClient::Subscribe(EventHandler callback,
+                           std::optional<int64_t> last_seen_event_id)
 {
-    new EventsReactor(stub_, std::move(callback), callback_thread_);
+    new EventsReactor(stub_, std::move(callback), callback_thread_,
+                      last_seen_event_id);
 }
 
 template <typename CallType>
@@ -817,6 +845,30 @@ void GrpcClient::OnGetDevicesCallDone(GetDevicesCall& call,
     }
 }
 
+void GrpcClient::OnGetPerfStatsCallDone(GetPerfStatsCall& call,
+                                        const grpc::Status& status)
+{
+    if (status.ok()) {
+        INVOKE(call.callback, ErrorCodeProtoToCore(call.response.code()),
+               PerfStatsProtoToCore(call.response));
+    } else {
+        SPDLOG_ERROR(status.error_message());
+        INVOKE(call.callback, ErrorCode::CALL_ERROR, PerfStats{});
+    }
+}
+
+void GrpcClient::OnGetWorkerStatsCallDone(GetWorkerStatsCall& call,
+                                          const grpc::Status& status)
+{
+    if (status.ok()) {
+        INVOKE(call.callback, ErrorCodeProtoToCore(call.response.code()),
+               WorkerStatsProtoToCore(call.response));
+    } else {
+        SPDLOG_ERROR(status.error_message());
+        INVOKE(call.callback, ErrorCode::CALL_ERROR, WorkerStats{});
+    }
+}
+
 void GrpcClient::OnStopCallDone(StopCall& call, const grpc::Status& status)
 {
     OnEmptyResponseCallDone(call, status);
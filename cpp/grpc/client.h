@@ -2,6 +2,7 @@
 #define VIOLET_GRPC_CLIENT_H
 
 #include <memory>
+#include <optional>
 #include <source_location>
 #include <string>
 
@@ -24,6 +25,8 @@ public:
     ~GrpcClient();
 
     void GetDevices(Callback<std::vector<Device>> = {});
+    void GetPerfStats(Callback<PerfStats> = {});
+    void GetWorkerStats(Callback<WorkerStats> = {});
     void Start(Callback<> = {});
     void Stop(Callback<> = {});
     void SetInputDevice(std::string, Callback<> = {});
@@ -77,7 +80,12 @@ public:
     void StartRdsDecoder(uint64_t, Callback<> = {});
     void StopRdsDecoder(uint64_t, Callback<> = {});
     void ResetRdsParser(uint64_t, Callback<> = {});
-    void Subscribe(EventHandler);
+
+    // Resumes after \p last_seen_event_id if the server still has every
+    // event after it, otherwise starts with the full SyncStart ... SyncEnd
+    // snapshot like a new subscription.
+    void Subscribe(EventHandler,
+                   std::optional<int64_t> last_seen_event_id = std::nullopt);
 
 private:
     class EventsReactor;
@@ -115,6 +123,10 @@ private:
         std::source_location loc = std::source_location::current());
 
     void OnGetDevicesCallDone(GetDevicesCall& call, const grpc::Status& status);
+    void OnGetPerfStatsCallDone(GetPerfStatsCall& call,
+                                const grpc::Status& status);
+    void OnGetWorkerStatsCallDone(GetWorkerStatsCall& call,
+                                  const grpc::Status& status);
     void OnStartCallDone(StartCall& call, const grpc::Status& status);
     void OnStopCallDone(StopCall& call, const grpc::Status& status);
     void OnInputDeviceCallDone(SetInputDeviceCall& call,
@@ -23,6 +23,18 @@ struct GetDevicesCall : public ClientCallCommon {
     Callback<std::vector<Device>> callback;
 };
 
+struct GetPerfStatsCall : public ClientCallCommon {
+    google::protobuf::Empty request;
+    Receiver::PerfStatsResponse response;
+    Callback<PerfStats> callback;
+};
+
+struct GetWorkerStatsCall : public ClientCallCommon {
+    google::protobuf::Empty request;
+    Receiver::WorkerStatsResponse response;
+    Callback<WorkerStats> callback;
+};
+
 struct StartCall : public ClientCallCommon {
     google::protobuf::Empty request;
     Receiver::EmptyResponse response;
@@ -326,7 +338,7 @@ using ClientCall = std::variant<
     SetAmDcrCall, SetAmSyncDcrCall, SetAmSyncPllBwCall, StartAudioRecordingCall,
     StopAudioRecordingCall, StartSnifferCall, StopSnifferCall,
     GetSnifferDataCall, StartRdsDecoderCall, StopRdsDecoderCall,
-    ResetRdsParserCall, GetRdsDataCall>;
+    ResetRdsParserCall, GetRdsDataCall, GetPerfStatsCall, GetWorkerStatsCall>;
 
 } // namespace violetrx
 
@@ -0,0 +1,135 @@
+// Measures the server side cost of delivering one event to N subscribers, the
+// way GrpcServer used to do it (every subscriber converts and serializes the
+// event) against the way it does it now (serialized once, then only the
+// buffer is shared).
+//
+// No network is involved: this is only the CPU work between the receiver
+// emitting an event and the bytes being handed to gRPC.
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <broadcast_queue.h>
+#include <gflags/gflags.h>
+#include <grpcpp/impl/proto_utils.h>
+#include <spdlog/spdlog.h>
+
+#include "async_core/events.h"
+#include "receiver.pb.h"
+#include "type_conversion.h"
+
+DEFINE_int32(events, 2000, "Number of events per run");
+DEFINE_string(subscribers, "1,100,1000", "Comma separated subscriber counts");
+
+using namespace violetrx;
+using Clock = std::chrono::steady_clock;
+
+constexpr int kQueueSize = 64;
+
+struct SerializedEvent {
+    grpc::ByteBuffer buffer;
+    bool unsubscribed = false;
+};
+
+static void Serialize(const Receiver::Event& proto, grpc::ByteBuffer* buffer)
+{
+    buffer->Clear();
+
+    bool own_buffer;
+    grpc::SerializationTraits<Receiver::Event>::Serialize(proto, buffer,
+                                                          &own_buffer);
+}
+
+static Event MakeEvent(int64_t id)
+{
+    std::vector<GainStage> stages{
+        {"LNA", 0.0, 40.0, 8.0, 24.0},
+        {"VGA", 0.0, 62.0, 2.0, 20.0},
+        {"AMP", 0.0, 14.0, 14.0, 0.0},
+    };
+    return GainStagesChanged{{.id = id, .timestamp = Timestamp::Now()},
+                             std::move(stages)};
+}
+
+// Every subscriber dequeues the event, converts it and serializes it.
+static double PerSubscriber(int subscribers, int events)
+{
+    broadcast_queue::sender<Event> sender{kQueueSize};
+    std::vector<broadcast_queue::receiver<Event>> receivers;
+    std::vector<Receiver::Event> protos(subscribers);
+    std::vector<grpc::ByteBuffer> buffers(subscribers);
+    for (int i = 0; i < subscribers; i++) {
+        receivers.push_back(sender.subscribe());
+    }
+
+    auto start = Clock::now();
+    for (int n = 0; n < events; n++) {
+        sender.push(MakeEvent(n));
+
+        for (int i = 0; i < subscribers; i++) {
+            Event event;
+            receivers[i].try_dequeue(&event);
+
+            EventCoreToProto(event, &protos[i]);
+            Serialize(protos[i], &buffers[i]);
+        }
+    }
+    std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+
+    return elapsed.count() / events;
+}
+
+// The event is serialized once, and every subscriber dequeues a reference to
+// the same slices.
+static double SerializeOnce(int subscribers, int events)
+{
+    broadcast_queue::sender<SerializedEvent> sender{kQueueSize};
+    std::vector<broadcast_queue::receiver<SerializedEvent>> receivers;
+    std::vector<grpc::ByteBuffer> buffers(subscribers);
+    for (int i = 0; i < subscribers; i++) {
+        receivers.push_back(sender.subscribe());
+    }
+
+    Receiver::Event proto;
+    auto start = Clock::now();
+    for (int n = 0; n < events; n++) {
+        SerializedEvent serialized;
+        EventCoreToProto(MakeEvent(n), &proto);
+        Serialize(proto, &serialized.buffer);
+        sender.push(std::move(serialized));
+
+        for (int i = 0; i < subscribers; i++) {
+            SerializedEvent event;
+            receivers[i].try_dequeue(&event);
+
+            buffers[i].Swap(&event.buffer);
+        }
+    }
+    std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+
+    return elapsed.count() / events;
+}
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+    std::vector<int> counts;
+    std::stringstream ss{FLAGS_subscribers};
+    for (std::string count; std::getline(ss, count, ',');) {
+        counts.push_back(std::stoi(count));
+    }
+
+    spdlog::info("{:>12} {:>20} {:>20}", "subscribers", "per subscriber (us)",
+                 "serialize once (us)");
+    for (int subscribers : counts) {
+        double before = PerSubscriber(subscribers, FLAGS_events);
+        double after = SerializeOnce(subscribers, FLAGS_events);
+
+        spdlog::info("{:>12} {:>20.2f} {:>20.2f}", subscribers, before, after);
+    }
+
+    return EXIT_SUCCESS;
+}
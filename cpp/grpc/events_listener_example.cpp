@@ -1,10 +1,12 @@
-#include <boost/asio.hpp>
 #include <gflags/gflags.h>
 #include <spdlog/spdlog.h>
 
 #include "async_core/events_format.h" // IWYU pragma: keep
 #include "grpc/client.h"
 
+// Last: <termios.h> defines CS8 as a macro, which breaks IqFormat::CS8
+#include <boost/asio.hpp>
+
 DEFINE_string(url, "0.0.0.0:50050", "Server URL");
 DEFINE_bool(sync_only, false, "Receive sync events only and exit");
 
@@ -120,6 +120,7 @@ void GrpcAsyncReceiver::onReceiverEvent(const ReceiverEvent& event)
                 iq_recording_path_ = ev.path;
             },
             [&](const IqRecordingStopped&) { is_iq_recording_ = false; },
+            [&](const InputEof&) {},
             [&](const VfoAdded& ev) { addVfoIfDoesntExist(ev.handle); },
             [&](const VfoRemoved&) {
                 // Will not handle this now!
@@ -185,6 +186,16 @@ void GrpcAsyncReceiver::getDevices(Callback<std::vector<Device>> callback) const
     client_->GetDevices(std::move(callback));
 }
 
+void GrpcAsyncReceiver::getPerfStats(Callback<PerfStats> callback) const
+{
+    client_->GetPerfStats(std::move(callback));
+}
+
+void GrpcAsyncReceiver::getWorkerStats(Callback<WorkerStats> callback) const
+{
+    client_->GetWorkerStats(std::move(callback));
+}
+
 void GrpcAsyncReceiver::start(Callback<> callback)
 {
     // Note: We do not update the local state even the callback indicated
@@ -265,7 +276,8 @@ void GrpcAsyncReceiver::getIqFftData(
 {
     client_->GetFftData(data, size, std::move(callback));
 }
-void GrpcAsyncReceiver::startIqRecording(std::string, Callback<> callback)
+void GrpcAsyncReceiver::startIqRecording(std::string, IqFormat,
+                                         Callback<> callback)
 {
     // TODO
     callback(ErrorCode::UNIMPLEMENTED);
@@ -275,6 +287,26 @@ void GrpcAsyncReceiver::stopIqRecording(Callback<> callback)
     // TODO
     callback(ErrorCode::UNIMPLEMENTED);
 }
+void GrpcAsyncReceiver::setIqHistory(double, Callback<> callback)
+{
+    // TODO
+    callback(ErrorCode::UNIMPLEMENTED);
+}
+void GrpcAsyncReceiver::saveIqSnapshot(std::string, double, double,
+                                       Callback<> callback)
+{
+    // TODO
+    callback(ErrorCode::UNIMPLEMENTED);
+}
+void GrpcAsyncReceiver::startShmOutput(std::string, Callback<> callback)
+{
+    // shared memory is local to the server's host
+    callback(ErrorCode::UNIMPLEMENTED);
+}
+void GrpcAsyncReceiver::stopShmOutput(Callback<> callback)
+{
+    callback(ErrorCode::UNIMPLEMENTED);
+}
 
 AsyncVfoIfaceSptr GrpcAsyncReceiver::addVfoIfDoesntExist(uint64_t handle)
 {
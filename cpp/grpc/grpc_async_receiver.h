@@ -23,6 +23,8 @@ public:
     ~GrpcAsyncReceiver() override;
 
     void getDevices(Callback<std::vector<Device>>) const override;
+    void getPerfStats(Callback<PerfStats>) const override;
+    void getWorkerStats(Callback<WorkerStats>) const override;
     void subscribe(ReceiverEventHandler, Callback<Connection>) override;
     void unsubscribe(const Connection&) override;
 
@@ -48,8 +50,16 @@ public:
                  Callback<Timestamp, int64_t, int, float*, int> = {}) override;
 
     /* I/Q Recording */
-    void startIqRecording(std::string, Callback<> = {}) override;
+    void startIqRecording(std::string, IqFormat,
+                          Callback<> = {}) override;
     void stopIqRecording(Callback<> = {}) override;
+    void setIqHistory(double, Callback<> = {}) override;
+    void saveIqSnapshot(std::string, double, double,
+                        Callback<> = {}) override;
+
+    /* Shared memory output */
+    void startShmOutput(std::string, Callback<> = {}) override;
+    void stopShmOutput(Callback<> = {}) override;
 
     /* VFO channels */
     void addVfoChannel(Callback<AsyncVfoIfaceSptr> = {}) override;
@@ -55,6 +55,9 @@ GrpcAsyncVfo::GrpcAsyncVfo(uint64_t handle, std::shared_ptr<GrpcClient> client,
     udp_host_{},
     udp_port_{0},
     udp_stereo_{false},
+    udp_rtp_{false},
+    is_iq_streaming_{false},
+    iq_params_{},
     is_rds_decoder_active_{false},
     removed_{false}
 {
@@ -137,7 +140,13 @@ void GrpcAsyncVfo::forEachStateEvent(Lambda&& lambda) const
         lambda(SnifferStarted{ec, sniffer_sample_rate_, sniffer_buff_size_});
     }
     if (isUdpStreaming()) {
-        lambda(UdpStreamingStarted{ec, udp_host_, udp_port_, udp_stereo_});
+        lambda(UdpStreamingStarted{ec, udp_host_, udp_port_, udp_stereo_,
+                                   udp_rtp_});
+    }
+    if (isIqStreaming()) {
+        lambda(IqStreamStarted{ec, iq_params_.sampleRate, iq_params_.format,
+                               iq_params_.transport, iq_params_.host,
+                               iq_params_.port});
     }
     if (isRdsDecoderActive()) {
         lambda(RdsDecoderStarted{ec});
@@ -260,12 +269,23 @@ void GrpcAsyncVfo::stopAudioRecording(Callback<> callback)
     client_->StopAudioRecording(handle_, std::move(callback));
 }
 
+void GrpcAsyncVfo::startSqlRecording(const std::string&, double,
+                                     Callback<> callback)
+{
+    INVOKE(callback, ErrorCode::UNIMPLEMENTED);
+}
+
+void GrpcAsyncVfo::stopSqlRecording(Callback<> callback)
+{
+    INVOKE(callback, ErrorCode::UNIMPLEMENTED);
+}
+
 void GrpcAsyncVfo::setAudioGain(float /* gain */, Callback<> callback)
 {
     INVOKE(callback, ErrorCode::UNIMPLEMENTED);
 }
 
-void GrpcAsyncVfo::startUdpStreaming(const std::string&, int, bool,
+void GrpcAsyncVfo::startUdpStreaming(const std::string&, int, bool, bool,
                                      Callback<> callback)
 {
     INVOKE(callback, ErrorCode::UNIMPLEMENTED);
@@ -276,6 +296,21 @@ void GrpcAsyncVfo::stopUdpStreaming(Callback<> callback)
     INVOKE(callback, ErrorCode::UNIMPLEMENTED);
 }
 
+void GrpcAsyncVfo::startIqStream(const IqStreamParams&, Callback<> callback)
+{
+    INVOKE(callback, ErrorCode::UNIMPLEMENTED);
+}
+
+void GrpcAsyncVfo::stopIqStream(Callback<> callback)
+{
+    INVOKE(callback, ErrorCode::UNIMPLEMENTED);
+}
+
+void GrpcAsyncVfo::subscribeIq(Callback<IqReceiver> callback)
+{
+    INVOKE(callback, ErrorCode::UNIMPLEMENTED, IqReceiver{});
+}
+
 void GrpcAsyncVfo::startSniffer(int sample_rate, int buff_size,
                                 Callback<> callback)
 {
@@ -334,6 +369,7 @@ std::string GrpcAsyncVfo::getRecordingFilename() const
     return recording_path_;
 }
 bool GrpcAsyncVfo::isUdpStreaming() const { return is_udp_streaming_; }
+bool GrpcAsyncVfo::isIqStreaming() const { return is_iq_streaming_; }
 bool GrpcAsyncVfo::isSniffing() const { return is_sniffing_; }
 bool GrpcAsyncVfo::isRdsDecoderActive() const { return is_rds_decoder_active_; }
 bool GrpcAsyncVfo::isAgcOn() const { return agc_on_; }
@@ -351,9 +387,12 @@ float GrpcAsyncVfo::getNoiseBlanker2Threshold() const { return nb2_threshold_; }
 float GrpcAsyncVfo::getAfGain() const { return 1.0f; }
 UdpStreamParams GrpcAsyncVfo::getUdpStreamParams() const
 {
-    return UdpStreamParams{
-        .host = udp_host_, .port = udp_port_, .stereo = udp_stereo_};
+    return UdpStreamParams{.host = udp_host_,
+                           .port = udp_port_,
+                           .stereo = udp_stereo_,
+                           .rtp = udp_rtp_};
 }
+IqStreamParams GrpcAsyncVfo::getIqStreamParams() const { return iq_params_; }
 SnifferParams GrpcAsyncVfo::getSnifferParams() const
 {
     return SnifferParams{.sampleRate = sniffer_sample_rate_,
@@ -432,6 +471,7 @@ void GrpcAsyncVfo::onEvent(const VfoEvent& event)
                 is_audio_recording_ = false;
                 // recording_path_ = {};
             },
+            [&](const AudioSegmentRecorded&) {},
             [&](const SnifferStarted& ev) {
                 sniffer_buff_size_ = ev.size;
                 sniffer_sample_rate_ = ev.sample_rate;
@@ -440,11 +480,21 @@ void GrpcAsyncVfo::onEvent(const VfoEvent& event)
             [&](const SnifferStopped&) { is_sniffing_ = false; },
             [&](const UdpStreamingStarted& ev) {
                 udp_stereo_ = ev.stereo;
+                udp_rtp_ = ev.rtp;
                 udp_host_ = ev.host;
                 udp_port_ = ev.port;
                 is_udp_streaming_ = true;
             },
             [&](const UdpStreamingStopped&) { is_udp_streaming_ = false; },
+            [&](const IqStreamStarted& ev) {
+                iq_params_ = IqStreamParams{.sampleRate = ev.sample_rate,
+                                            .format = ev.format,
+                                            .transport = ev.transport,
+                                            .host = ev.host,
+                                            .port = ev.port};
+                is_iq_streaming_ = true;
+            },
+            [&](const IqStreamStopped&) { is_iq_streaming_ = false; },
             [&](const RdsDecoderStarted&) { is_rds_decoder_active_ = true; },
             [&](const RdsDecoderStopped&) { is_rds_decoder_active_ = false; },
             [&](const RdsParserReset&) {},
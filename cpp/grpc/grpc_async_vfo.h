@@ -68,13 +68,21 @@ public:
     /* Audio Recording */
     void startAudioRecording(const std::string&, Callback<> = {}) override;
     void stopAudioRecording(Callback<> = {}) override;
+    void startSqlRecording(const std::string&, double,
+                           Callback<> = {}) override;
+    void stopSqlRecording(Callback<> = {}) override;
     void setAudioGain(float, Callback<> = {}) override;
 
     /* UDP streaming */
-    void startUdpStreaming(const std::string&, int, bool,
+    void startUdpStreaming(const std::string&, int, bool, bool,
                            Callback<> = {}) override;
     void stopUdpStreaming(Callback<> = {}) override;
 
+    /* I/Q streaming */
+    void startIqStream(const IqStreamParams&, Callback<> = {}) override;
+    void stopIqStream(Callback<> = {}) override;
+    void subscribeIq(Callback<IqReceiver>) override;
+
     /* sample sniffer */
     void startSniffer(int, int, Callback<> = {}) override;
     void stopSniffer(Callback<> = {}) override;
@@ -101,6 +109,7 @@ public:
     bool isAudioRecording() const override;
     std::string getRecordingFilename() const override;
     bool isUdpStreaming() const override;
+    bool isIqStreaming() const override;
     bool isSniffing() const override;
     bool isRdsDecoderActive() const override;
     bool isAgcOn() const override;
@@ -117,6 +126,7 @@ public:
     float getNoiseBlanker2Threshold() const override;
     float getAfGain() const override;
     UdpStreamParams getUdpStreamParams() const override;
+    IqStreamParams getIqStreamParams() const override;
     SnifferParams getSnifferParams() const override;
     std::vector<VfoEvent> getStateAsEvents() const override;
 
@@ -192,6 +202,11 @@ private:
     std::string udp_host_;
     int udp_port_;
     bool udp_stereo_;
+    bool udp_rtp_;
+
+    // iq streaming
+    bool is_iq_streaming_;
+    IqStreamParams iq_params_;
 
     // rds
     bool is_rds_decoder_active_;
@@ -0,0 +1,429 @@
+// Load generator for headless_server: N GrpcClient instances, each polling the
+// FFT at a target frame rate, calling setters on its own VFO, polling the
+// sniffer of that VFO and subscribing to the events. Reports round-trip
+// latency percentiles and throughput per kind of call, the events dropped by
+// the server and, given its PID, the CPU time of the server.
+//
+// Calls are sent open loop: a call that comes due while too many of its kind
+// are still in flight is skipped and counted, the way a GUI drops a frame,
+// instead of being queued behind the slow ones.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+
+#include "async_core/error_codes.h"
+#include "grpc/client.h"
+
+DEFINE_string(url, "0.0.0.0:50050", "Server URL");
+DEFINE_int32(clients, 4, "Number of concurrent clients");
+DEFINE_int32(duration, 10, "Length of the run in seconds");
+DEFINE_double(fft_rate, 25,
+              "GetFftData calls per second and client, 0 for none");
+DEFINE_int32(fft_size, 8192, "Points per FFT frame");
+DEFINE_double(setter_rate, 5, "Setter calls per second and client, 0 for none");
+DEFINE_double(sniffer_rate, 0,
+              "GetSnifferData calls per second and client, 0 for none");
+DEFINE_int32(sniffer_samples, 48000, "Sniffer buffer of each VFO, in samples");
+DEFINE_bool(subscribe, true, "Subscribe every client to the events");
+DEFINE_string(input_device, "",
+              "Device to open and start before the run, if not running yet");
+DEFINE_int32(max_in_flight, 4,
+             "Calls of a kind a client may have in flight before skipping");
+DEFINE_int32(server_pid, 0,
+             "PID of headless_server, when on this host, to report its CPU");
+
+using namespace violetrx;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+
+enum Kind { FFT, SETTER, SNIFFER, EVENT, KIND_COUNT };
+
+constexpr std::array<const char*, KIND_COUNT> KIND_NAMES = {
+    "GetFftData", "setters", "GetSnifferData", "events"};
+
+/* Latencies and errors of one kind of call, shared by all the clients. */
+class Recorder
+{
+public:
+    void add(std::chrono::duration<double, std::micro> latency)
+    {
+        std::scoped_lock lock{mutex_};
+        latencies_.push_back(latency.count());
+    }
+
+    void addError() { errors_++; }
+    void addSkipped() { skipped_++; }
+
+    void report(const char* name, double seconds)
+    {
+        std::scoped_lock lock{mutex_};
+
+        if (latencies_.empty() && errors_ == 0 && skipped_ == 0)
+            return;
+
+        std::sort(latencies_.begin(), latencies_.end());
+        auto percentile = [&](double p) {
+            if (latencies_.empty())
+                return 0.0;
+            size_t i = std::min(latencies_.size() - 1,
+                                size_t(p * latencies_.size()));
+            return latencies_[i];
+        };
+
+        spdlog::info("{:>15} {:>10} {:>10.1f} {:>8} {:>8} {:>10.0f} {:>10.0f} "
+                     "{:>10.0f} {:>10.0f}",
+                     name, latencies_.size(), latencies_.size() / seconds,
+                     errors_.load(), skipped_.load(), percentile(0.5),
+                     percentile(0.99), percentile(0.999),
+                     latencies_.empty() ? 0.0 : latencies_.back());
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<double> latencies_; /* In microseconds */
+    std::atomic<uint64_t> errors_{0};
+    std::atomic<uint64_t> skipped_{0};
+};
+
+struct Results {
+    std::array<Recorder, KIND_COUNT> recorders;
+
+    /* Subscriptions ended by the server or the connection, not by us. */
+    std::atomic<uint64_t> dropped_subscriptions{0};
+};
+
+/* Run an asynchronous call and wait for its result. */
+template <typename... Args, typename Function>
+std::tuple<ErrorCode, Args...> blockingCall(Function&& function)
+{
+    std::promise<std::tuple<ErrorCode, Args...>> promise;
+    auto future = promise.get_future();
+
+    function([&promise](ErrorCode err, Args... args) {
+        promise.set_value({err, std::move(args)...});
+    });
+
+    return future.get();
+}
+
+void check(ErrorCode err, const std::string& what)
+{
+    if (err != ErrorCode::OK)
+        throw std::runtime_error(what + ": " + errorMsg(err));
+}
+
+/* Sum of the user and system CPU time of \p pid, in seconds. */
+double processCpuTime(int pid)
+{
+    std::ifstream file{"/proc/" + std::to_string(pid) + "/stat"};
+    std::string stat{std::istreambuf_iterator<char>{file}, {}};
+
+    // The command name may contain spaces, the fields start after it.
+    size_t pos = stat.rfind(')');
+    if (pos == std::string::npos)
+        return 0;
+
+    std::istringstream fields{stat.substr(pos + 2)};
+    std::string field;
+    for (int i = 3; i < 14; i++)
+        fields >> field;
+
+    uint64_t utime = 0, stime = 0;
+    fields >> utime >> stime;
+
+    return double(utime + stime) / sysconf(_SC_CLK_TCK);
+}
+
+class BenchClient
+{
+public:
+    BenchClient(int index, Results& results) :
+        index_{index},
+        client_{FLAGS_url},
+        results_{results}
+    {
+    }
+
+    void SetUp()
+    {
+        if (FLAGS_subscribe) {
+            client_.Subscribe(
+                [&results = results_](const Event& event) {
+                    OnEvent(results, event);
+                });
+        }
+
+        if (FLAGS_setter_rate <= 0 && FLAGS_sniffer_rate <= 0)
+            return;
+
+        ErrorCode err;
+        std::tie(err, vfo_) = blockingCall<uint64_t>(
+            [&](auto cb) { client_.AddVfoChannel(std::move(cb)); });
+        check(err, fmt::format("client {}: can't add VFO", index_));
+        has_vfo_ = true;
+
+        if (FLAGS_sniffer_rate > 0) {
+            std::tie(err) = blockingCall([&](auto cb) {
+                client_.StartSniffer(vfo_, 48000, FLAGS_sniffer_samples,
+                                     std::move(cb));
+            });
+            check(err, fmt::format("client {}: can't start sniffer", index_));
+        }
+    }
+
+    void Run(Clock::time_point start, Clock::time_point end)
+    {
+        auto next_fft = start;
+        auto next_setter = start;
+        auto next_sniffer = start;
+
+        auto period = [](double rate) {
+            return std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(1.0 / rate));
+        };
+
+        for (auto now = Clock::now(); now < end; now = Clock::now()) {
+            auto next = end;
+
+            if (FLAGS_fft_rate > 0) {
+                if (now >= next_fft) {
+                    SendFft();
+                    next_fft += period(FLAGS_fft_rate);
+                }
+                next = std::min(next, next_fft);
+            }
+            if (FLAGS_setter_rate > 0) {
+                if (now >= next_setter) {
+                    SendSetter();
+                    next_setter += period(FLAGS_setter_rate);
+                }
+                next = std::min(next, next_setter);
+            }
+            if (FLAGS_sniffer_rate > 0) {
+                if (now >= next_sniffer) {
+                    SendSniffer();
+                    next_sniffer += period(FLAGS_sniffer_rate);
+                }
+                next = std::min(next, next_sniffer);
+            }
+
+            std::this_thread::sleep_until(next);
+        }
+    }
+
+    /* Waits for the calls still in flight, so that none outlives us. */
+    void TearDown(Clock::duration timeout)
+    {
+        auto deadline = Clock::now() + timeout;
+        while (InFlight() > 0 && Clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        if (has_vfo_) {
+            blockingCall([&](auto cb) {
+                client_.RemoveVfoChannel(vfo_, std::move(cb));
+            });
+        }
+    }
+
+    int InFlight() const
+    {
+        int total = 0;
+        for (const auto& n : in_flight_)
+            total += n.load();
+        return total;
+    }
+
+private:
+    static void OnEvent(Results& results, const Event& event)
+    {
+        if (const auto* unsubscribed = std::get_if<Unsubscribed>(&event)) {
+            // Sent with a negative id by the client when the stream breaks,
+            // which is how a lagging subscriber gets disconnected.
+            if (unsubscribed->id < 0)
+                results.dropped_subscriptions++;
+            return;
+        }
+
+        // Timestamps are wall clock, only meaningful on the same host
+        auto sent = std::visit([](const auto& e) { return e.timestamp; },
+                               event);
+        results.recorders[EVENT].add(std::chrono::system_clock::now() -
+                                     sent.ToTimepoint());
+    }
+
+    /* Counts the call in flight, or returns false if too many already are. */
+    bool Begin(Kind kind)
+    {
+        if (in_flight_[kind].fetch_add(1) >= FLAGS_max_in_flight) {
+            in_flight_[kind]--;
+            results_.recorders[kind].addSkipped();
+            return false;
+        }
+        return true;
+    }
+
+    template <typename... Args>
+    auto End(Kind kind)
+    {
+        return [this, kind, sent = Clock::now()](ErrorCode err, Args...) {
+            if (err == ErrorCode::OK)
+                results_.recorders[kind].add(Clock::now() - sent);
+            else
+                results_.recorders[kind].addError();
+            in_flight_[kind]--;
+        };
+    }
+
+    void SendFft()
+    {
+        if (!Begin(FFT))
+            return;
+
+        auto buffer = std::make_shared<std::vector<float>>(FLAGS_fft_size);
+        client_.GetFftData(
+            buffer->data(), buffer->size(),
+            [buffer, end = End<Timestamp, int64_t, int, float*, int>(FFT)](
+                ErrorCode err, Timestamp ts, int64_t freq, int rate,
+                float* data, int size) mutable {
+                end(err, ts, freq, rate, data, size);
+            });
+    }
+
+    /* Cycles through setters that only touch this client's VFO. */
+    void SendSetter()
+    {
+        if (!has_vfo_ || !Begin(SETTER))
+            return;
+
+        switch (setter_++ % 4) {
+        case 0:
+            client_.SetFilterOffset(vfo_, (setter_ % 100) * 1000 - 50000,
+                                    End(SETTER));
+            break;
+        case 1:
+            client_.SetSqlLevel(vfo_, -150.0 + setter_ % 50, End(SETTER));
+            break;
+        case 2:
+            client_.SetAgcOn(vfo_, setter_ % 2, End(SETTER));
+            break;
+        case 3:
+            client_.SetFilter(vfo_, -5000, 5000, FilterShape::NORMAL,
+                              End(SETTER));
+            break;
+        }
+    }
+
+    void SendSniffer()
+    {
+        if (!has_vfo_ || !Begin(SNIFFER))
+            return;
+
+        auto buffer =
+            std::make_shared<std::vector<float>>(FLAGS_sniffer_samples);
+        client_.GetSnifferData(
+            vfo_, buffer->data(), buffer->size(),
+            [buffer, end = End<float*, int>(SNIFFER)](
+                ErrorCode err, float* data, int size) mutable {
+                end(err, data, size);
+            });
+    }
+
+private:
+    int index_;
+    GrpcClient client_;
+    Results& results_;
+
+    bool has_vfo_ = false;
+    uint64_t vfo_ = 0;
+    uint64_t setter_ = 0;
+
+    std::array<std::atomic<int>, KIND_COUNT> in_flight_{};
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+    if (!FLAGS_input_device.empty()) {
+        GrpcClient client{FLAGS_url};
+
+        auto [err] = blockingCall([&](auto cb) {
+            client.SetInputDevice(FLAGS_input_device, std::move(cb));
+        });
+        check(err, "can't open input device");
+
+        std::tie(err) =
+            blockingCall([&](auto cb) { client.Start(std::move(cb)); });
+        check(err, "can't start receiver");
+    }
+
+    Results results;
+    std::vector<std::unique_ptr<BenchClient>> clients;
+    for (int i = 0; i < FLAGS_clients; i++) {
+        clients.push_back(std::make_unique<BenchClient>(i, results));
+        clients.back()->SetUp();
+    }
+
+    spdlog::info("{} clients for {} s", FLAGS_clients, FLAGS_duration);
+
+    double cpu_before = FLAGS_server_pid ? processCpuTime(FLAGS_server_pid) : 0;
+    auto start = Clock::now();
+    auto end = start + std::chrono::seconds(FLAGS_duration);
+    {
+        std::vector<std::jthread> threads;
+        for (auto& client : clients) {
+            threads.emplace_back(
+                [&client, start, end]() { client->Run(start, end); });
+        }
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    double cpu_after = FLAGS_server_pid ? processCpuTime(FLAGS_server_pid) : 0;
+
+    for (auto& client : clients)
+        client->TearDown(std::chrono::seconds(5));
+
+    spdlog::info("{:>15} {:>10} {:>10} {:>8} {:>8} {:>10} {:>10} {:>10} {:>10}",
+                 "", "count", "per s", "errors", "skipped", "p50 (us)",
+                 "p99 (us)", "p999 (us)", "max (us)");
+    for (int kind = 0; kind < KIND_COUNT; kind++) {
+        results.recorders[kind].report(KIND_NAMES[kind], elapsed.count());
+    }
+
+    spdlog::info("Dropped subscriptions: {}",
+                 results.dropped_subscriptions.load());
+    if (FLAGS_server_pid) {
+        spdlog::info("Server CPU: {:.1f}%",
+                     100 * (cpu_after - cpu_before) / elapsed.count());
+    }
+
+    // The server side view of the same run
+    GrpcClient client{FLAGS_url};
+    auto [err, stats] = blockingCall<WorkerStats>(
+        [&](auto cb) { client.GetWorkerStats(std::move(cb)); });
+    if (err == ErrorCode::OK) {
+        spdlog::info("Worker thread: queue depth {}, average latency {:.0f} us",
+                     stats.queueDepth, stats.avgLatency * 1e6);
+    }
+
+    return EXIT_SUCCESS;
+}
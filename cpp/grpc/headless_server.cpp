@@ -1,11 +1,26 @@
-#include <boost/asio.hpp>
 #include <gflags/gflags.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
 #include "async_core/async_receiver.h"
+#include "async_core/error_codes.h"
+#include "batch_mode.h"
+#include "metrics_server.h"
 #include "server.h"
 
+#include <boost/asio.hpp> // last, see metrics_server.h
+
 DEFINE_string(url, "0.0.0.0:50050", "Server URL");
+DEFINE_string(iq_file, "",
+              "Decode this I/Q file (path or iqfile= device string) in batch "
+              "mode instead of serving, requires --vfos");
+DEFINE_string(vfos, "", "YAML or JSON file with the VFOs of batch mode");
+DEFINE_string(shm_prefix, "",
+              "Also write the I/Q, FFT and audio to shared memory rings named "
+              "after this prefix, for readers on the same host");
+DEFINE_string(metrics_url, "",
+              "Serve Prometheus metrics over HTTP on this host:port, e.g. "
+              "0.0.0.0:9464");
 
 int main(int argc, char** argv)
 {
@@ -14,10 +29,51 @@ int main(int argc, char** argv)
 
     spdlog::set_level(spdlog::level::debug);
 
+    if (!FLAGS_iq_file.empty()) {
+        if (FLAGS_vfos.empty()) {
+            spdlog::error("--iq_file requires --vfos");
+            return 1;
+        }
+
+        violetrx::BatchConfig config;
+        try {
+            config = violetrx::loadBatchConfig(FLAGS_vfos);
+        } catch (const std::exception& e) {
+            spdlog::error("{}", e.what());
+            return 1;
+        }
+
+        // keep stdout for the statistics, which are meant to be parsed
+        spdlog::set_default_logger(spdlog::stderr_color_mt("batch"));
+        spdlog::set_level(spdlog::level::info);
+
+        return violetrx::runBatch(std::make_shared<violetrx::AsyncReceiver>(),
+                                  FLAGS_iq_file, config);
+    }
+
     // Start the server.
-    violetrx::AsyncReceiver::sptr receiver = violetrx::AsyncReceiver::make();
+    auto receiver = std::make_shared<violetrx::AsyncReceiver>();
     violetrx::GrpcServer server{receiver, FLAGS_url};
 
+    std::unique_ptr<violetrx::MetricsServer> metrics;
+    if (!FLAGS_metrics_url.empty()) {
+        try {
+            metrics = std::make_unique<violetrx::MetricsServer>(
+                receiver, server, FLAGS_metrics_url);
+        } catch (const std::exception& e) {
+            spdlog::error("Metrics on {}: {}", FLAGS_metrics_url, e.what());
+            return 1;
+        }
+    }
+
+    if (!FLAGS_shm_prefix.empty()) {
+        receiver->startShmOutput(FLAGS_shm_prefix, [](violetrx::ErrorCode err) {
+            if (err != violetrx::ErrorCode::OK)
+                spdlog::error("Shared memory output: {}",
+                              violetrx::errorMsg(err));
+        });
+    }
+
     // Wait for SIGTERM/SIGINT signals.
     boost::asio::io_context ctx;
     boost::asio::signal_set signals{ctx, SIGINT, SIGTERM};
@@ -0,0 +1,355 @@
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <istream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+#include <spdlog/spdlog.h>
+
+#include "async_core/error_codes.h"
+#include "metrics_server.h"
+
+namespace violetrx
+{
+
+using boost::asio::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+/* How long a scrape waits for the receiver before leaving its metrics out. */
+static constexpr auto COLLECT_TIMEOUT = std::chrono::seconds(1);
+
+/* Requests are a request line and a few headers, anything longer is dropped. */
+static constexpr size_t MAX_REQUEST_SIZE = 8192;
+
+template <typename T>
+using Pending = std::future<std::optional<T>>;
+
+/* Start an asynchronous call, its result can be waited on with get(). */
+template <typename T, typename Function>
+static Pending<T> request(Function&& function)
+{
+    // shared with the callback, which may run after the scrape gave up on it
+    auto promise = std::make_shared<std::promise<std::optional<T>>>();
+    auto future = promise->get_future();
+
+    function([promise](ErrorCode err, T value) {
+        if (err == ErrorCode::OK)
+            promise->set_value(std::move(value));
+        else
+            promise->set_value(std::nullopt);
+    });
+
+    return future;
+}
+
+template <typename T>
+static std::optional<T> get(Pending<T>& pending, Clock::time_point deadline)
+{
+    if (pending.wait_until(deadline) != std::future_status::ready)
+        return std::nullopt;
+
+    return pending.get();
+}
+
+static std::string escapeLabel(std::string_view value)
+{
+    std::string result;
+    result.reserve(value.size());
+
+    for (char c : value) {
+        switch (c) {
+        case '\\':
+            result += "\\\\";
+            break;
+        case '"':
+            result += "\\\"";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        default:
+            result += c;
+        }
+    }
+
+    return result;
+}
+
+class MetricsWriter
+{
+public:
+    void header(std::string_view name, std::string_view type,
+                std::string_view help)
+    {
+        fmt::format_to(out(), "# HELP {} {}\n# TYPE {} {}\n", name, help,
+                       name, type);
+    }
+
+    template <typename T>
+    void sample(std::string_view name, T value)
+    {
+        fmt::format_to(out(), "{} {}\n", name, value);
+    }
+
+    template <typename T>
+    void sample(std::string_view name, std::string_view labels, T value)
+    {
+        fmt::format_to(out(), "{}{{{}}} {}\n", name, labels, value);
+    }
+
+    // Power of two microsecond buckets, see WorkerThread::Histogram
+    void histogram(std::string_view name, std::string_view labels,
+                   const LatencyHistogram& histogram)
+    {
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i + 1 < histogram.buckets.size(); i++) {
+            cumulative += histogram.buckets[i];
+            fmt::format_to(out(), "{}_bucket{{{},le=\"{}\"}} {}\n", name,
+                           labels, std::ldexp(1e-6, i), cumulative);
+        }
+        fmt::format_to(out(), "{}_bucket{{{},le=\"+Inf\"}} {}\n", name, labels,
+                       histogram.count);
+        fmt::format_to(out(), "{}_sum{{{}}} {}\n", name, labels,
+                       histogram.sum);
+        fmt::format_to(out(), "{}_count{{{}}} {}\n", name, labels,
+                       histogram.count);
+    }
+
+    std::string str() const { return fmt::to_string(buffer); }
+
+private:
+    std::back_insert_iterator<fmt::memory_buffer> out()
+    {
+        return std::back_inserter(buffer);
+    }
+
+    fmt::memory_buffer buffer;
+};
+
+static tcp::endpoint parseEndpoint(const std::string& addr_url)
+{
+    size_t colon = addr_url.rfind(':');
+    if (colon == std::string::npos)
+        throw std::invalid_argument("expected host:port, got " + addr_url);
+
+    return tcp::endpoint{
+        boost::asio::ip::make_address(addr_url.substr(0, colon)),
+        static_cast<unsigned short>(std::stoi(addr_url.substr(colon + 1))),
+    };
+}
+
+MetricsServer::MetricsServer(std::shared_ptr<AsyncReceiver> receiver,
+                             const GrpcServer& server,
+                             const std::string& addr_url) :
+    receiver_{std::move(receiver)},
+    server_{server},
+    acceptor_{ctx_, parseEndpoint(addr_url)}
+{
+    receiver_->enableMetrics();
+
+    Accept();
+
+    thread_ = std::jthread([this]() { ctx_.run(); });
+
+    spdlog::info("Metrics served on http://{}/metrics", addr_url);
+}
+
+MetricsServer::~MetricsServer()
+{
+    ctx_.stop();
+    thread_.join();
+}
+
+void MetricsServer::Accept()
+{
+    acceptor_.async_accept(
+        [this](const boost::system::error_code& err, tcp::socket socket) {
+            if (err) {
+                spdlog::error("Metrics: accept failed: {}", err.message());
+                return;
+            }
+
+            Serve(std::make_shared<tcp::socket>(std::move(socket)));
+            Accept();
+        });
+}
+
+void MetricsServer::Serve(std::shared_ptr<tcp::socket> socket)
+{
+    auto buffer = std::make_shared<boost::asio::streambuf>(MAX_REQUEST_SIZE);
+
+    boost::asio::async_read_until(
+        *socket, *buffer, "\r\n\r\n",
+        [this, socket, buffer](const boost::system::error_code& err,
+                               size_t /* size */) {
+            if (err)
+                return;
+
+            std::istream stream{buffer.get()};
+            std::string method, target;
+            stream >> method >> target;
+
+            std::string status = "200 OK";
+            std::string body;
+            if (method != "GET") {
+                status = "405 Method Not Allowed";
+            } else if (target != "/metrics") {
+                status = "404 Not Found";
+            } else {
+                body = Collect();
+            }
+
+            auto response = std::make_shared<std::string>(fmt::format(
+                "HTTP/1.1 {}\r\n"
+                "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                "Content-Length: {}\r\n"
+                "Connection: close\r\n"
+                "\r\n"
+                "{}",
+                status, body.size(), body));
+
+            boost::asio::async_write(
+                *socket, boost::asio::buffer(*response),
+                [socket, response](const boost::system::error_code&, size_t) {
+                    boost::system::error_code ignored;
+                    socket->shutdown(tcp::socket::shutdown_both, ignored);
+                });
+        });
+}
+
+std::string MetricsServer::Collect()
+{
+    auto worker = request<WorkerStats>(
+        [&](auto callback) { receiver_->getWorkerStats(std::move(callback)); });
+
+    const auto deadline = Clock::now() + COLLECT_TIMEOUT;
+    bool complete = true;
+
+    MetricsWriter w;
+
+    const AsyncReceiver::Metrics m = receiver_->getMetrics();
+
+    w.header("violetrx_running", "gauge", "Whether the flow graph is running.");
+    w.sample("violetrx_running", m.running ? 1 : 0);
+
+    w.header("violetrx_iq_recording_bytes_total", "counter",
+             "Bytes written by the I/Q recorder.");
+    w.sample("violetrx_iq_recording_bytes_total", m.iqRecording.bytes_written);
+    w.header("violetrx_iq_recording_buffers_dropped_total", "counter",
+             "I/Q buffers dropped because the disk couldn't keep up.");
+    w.sample("violetrx_iq_recording_buffers_dropped_total",
+             m.iqRecording.buffers_dropped);
+    w.header("violetrx_iq_recording_write_errors_total", "counter",
+             "Failed writes of the I/Q recorder.");
+    w.sample("violetrx_iq_recording_write_errors_total",
+             m.iqRecording.write_errors);
+    w.header("violetrx_iq_recording_queue_depth", "gauge",
+             "I/Q buffers waiting to be written to disk.");
+    w.sample("violetrx_iq_recording_queue_depth", m.iqRecording.queue_depth);
+
+    w.header("violetrx_vfo_signal_level_db", "gauge",
+             "Signal level after the channel filter.");
+    for (const auto& vfo : m.vfos) {
+        w.sample("violetrx_vfo_signal_level_db",
+                 fmt::format("vfo=\"{}\"", vfo.handle), vfo.signalLevel);
+    }
+    w.header("violetrx_vfo_squelch_open", "gauge",
+             "Whether the squelch of the VFO is open.");
+    for (const auto& vfo : m.vfos) {
+        w.sample("violetrx_vfo_squelch_open",
+                 fmt::format("vfo=\"{}\"", vfo.handle), vfo.sqlOpen ? 1 : 0);
+    }
+
+    const PerfStats& p = m.perf;
+    w.header("violetrx_block_work_seconds_total", "counter",
+             "Time spent in the work function of the DSP blocks.");
+    for (const auto& block : p.blocks) {
+        w.sample("violetrx_block_work_seconds_total",
+                 fmt::format("vfo=\"\",block=\"{}\"", escapeLabel(block.name)),
+                 block.workTimeTotal);
+    }
+    for (const auto& vfo : p.vfos) {
+        for (const auto& block : vfo.blocks) {
+            w.sample("violetrx_block_work_seconds_total",
+                     fmt::format("vfo=\"{}\",block=\"{}\"", vfo.handle,
+                                 escapeLabel(block.name)),
+                     block.workTimeTotal);
+        }
+    }
+
+    w.header("violetrx_vfo_work_seconds_total", "counter",
+             "Time spent in the work function of the blocks of a VFO.");
+    for (const auto& vfo : p.vfos) {
+        w.sample("violetrx_vfo_work_seconds_total",
+                 fmt::format("vfo=\"{}\"", vfo.handle), vfo.workTimeTotal);
+    }
+
+    w.header("violetrx_taps_cache_hits_total", "counter",
+             "Filter designs served from the taps cache.");
+    w.sample("violetrx_taps_cache_hits_total", m.tapsCache.hits);
+    w.header("violetrx_taps_cache_misses_total", "counter",
+             "Filter designs computed because they weren't cached.");
+    w.sample("violetrx_taps_cache_misses_total", m.tapsCache.misses);
+    w.header("violetrx_taps_cache_entries", "gauge",
+             "Filter designs held by the taps cache.");
+    w.sample("violetrx_taps_cache_entries", m.tapsCache.size);
+
+    // Answers right away, it doesn't go through the worker queue
+    if (auto s = get(worker, deadline)) {
+        w.header("violetrx_worker_queue_depth", "gauge",
+                 "Commands waiting for the worker thread.");
+        w.sample("violetrx_worker_queue_depth", s->queueDepth);
+        w.header("violetrx_worker_stalled", "gauge",
+                 "Whether the worker thread is refusing new commands.");
+        w.sample("violetrx_worker_stalled", s->stalled ? 1 : 0);
+        w.header("violetrx_worker_avg_latency_seconds", "gauge",
+                 "Moving average of the time commands wait in the queue.");
+        w.sample("violetrx_worker_avg_latency_seconds", s->avgLatency);
+
+        w.header("violetrx_worker_queue_wait_seconds", "histogram",
+                 "Time commands waited in the queue of the worker thread.");
+        for (const auto& command : s->commands) {
+            w.histogram("violetrx_worker_queue_wait_seconds",
+                        fmt::format("command=\"{}\"",
+                                    escapeLabel(command.command)),
+                        command.queueWait);
+        }
+        w.header("violetrx_worker_execution_seconds", "histogram",
+                 "Time commands ran on the worker thread.");
+        for (const auto& command : s->commands) {
+            w.histogram("violetrx_worker_execution_seconds",
+                        fmt::format("command=\"{}\"",
+                                    escapeLabel(command.command)),
+                        command.execution);
+        }
+    } else {
+        complete = false;
+    }
+
+    GrpcServer::Stats grpc = server_.GetStats();
+
+    w.header("violetrx_grpc_subscribers", "gauge",
+             "Clients subscribed to the events.");
+    w.sample("violetrx_grpc_subscribers", grpc.subscribers);
+    w.header("violetrx_grpc_iq_streams", "gauge",
+             "Clients reading the I/Q of a VFO.");
+    w.sample("violetrx_grpc_iq_streams", grpc.iqStreams);
+    w.header("violetrx_grpc_lagged_disconnects_total", "counter",
+             "Clients disconnected for falling behind the events or I/Q.");
+    w.sample("violetrx_grpc_lagged_disconnects_total", grpc.laggedDisconnects);
+    w.header("violetrx_grpc_events_total", "counter",
+             "Events published to the subscribers.");
+    w.sample("violetrx_grpc_events_total", grpc.eventsPublished);
+
+    w.header("violetrx_scrape_complete", "gauge",
+             "0 if some metrics were left out because the receiver didn't "
+             "answer in time.");
+    w.sample("violetrx_scrape_complete", complete ? 1 : 0);
+
+    return w.str();
+}
+
+} // namespace violetrx
@@ -0,0 +1,50 @@
+#ifndef VIOLETRX_GRPC_METRICS_SERVER_H
+#define VIOLETRX_GRPC_METRICS_SERVER_H
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "async_core/async_receiver.h"
+#include "server.h"
+
+// After our headers: asio pulls in <termios.h>, which defines CS8 as a macro
+// and breaks IqFormat::CS8.
+#include <boost/asio.hpp>
+
+namespace violetrx
+{
+
+/* Serves the metrics of headless_server in the Prometheus text format, on
+ * GET /metrics of a minimal HTTP listener running in its own thread.
+ *
+ * A scrape only reads probes of the flow graph and a snapshot that the worker
+ * thread refreshes between its tasks, so it neither waits on the flow graph
+ * nor queues anything on the worker. The worker thread stats are read even
+ * while the worker is stuck, and are left out if they don't answer in time. */
+class MetricsServer
+{
+public:
+    /* \p addr_url is host:port. Throws boost::system::system_error if the
+     * address can't be bound. */
+    MetricsServer(std::shared_ptr<AsyncReceiver> receiver,
+                  const GrpcServer& server, const std::string& addr_url);
+    ~MetricsServer();
+
+private:
+    void Accept();
+    void Serve(std::shared_ptr<boost::asio::ip::tcp::socket> socket);
+    std::string Collect();
+
+private:
+    std::shared_ptr<AsyncReceiver> receiver_;
+    const GrpcServer& server_;
+
+    boost::asio::io_context ctx_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::jthread thread_;
+};
+
+} // namespace violetrx
+
+#endif // VIOLETRX_GRPC_METRICS_SERVER_H
@@ -35,10 +35,32 @@ namespace violetrx
 
 constexpr int kEventsQueueSize = 64;
 
+// Events a subscriber may have missed and still resume from.
+constexpr size_t kEventsLogSize = 1024;
+
+// Returns false if the event doesn't have an equivalent proto event.
+static bool SerializeEvent(const Event& event, Receiver::Event* proto_event,
+                           grpc::ByteBuffer* buffer)
+{
+    if (!EventCoreToProto(event, proto_event)) {
+        return false;
+    }
+
+    // The buffer is written into, so it must not hold a previous event.
+    buffer->Clear();
+
+    bool own_buffer;
+    grpc::Status status = grpc::SerializationTraits<Receiver::Event>::Serialize(
+        *proto_event, buffer, &own_buffer);
+
+    return status.ok();
+}
+
 GrpcServer::GrpcServer(AsyncReceiverIface::sptr async_receiver,
                        const std::string& addr_url) :
     async_receiver_{std::move(async_receiver)},
     events_queue_{kEventsQueueSize},
+    events_log_horizon_{EventCommon::last_id.load() - 1},
     last_fft_frame_{},
     other_fft_frame_{}
 {
@@ -81,7 +103,7 @@ void GrpcServer::HandleReceiverEvent(const ReceiverEvent& event)
     spdlog::debug("{}", event);
 
     // TODO: Assert that we're in the async receiver thread
-    events_queue_.push(ToGeneralEvent(event));
+    PushEvent(ToGeneralEvent(event));
 
     if (std::holds_alternative<VfoAdded>(event)) {
         const auto& vfo_added_event = std::get<VfoAdded>(event);
@@ -93,8 +115,7 @@ void GrpcServer::HandleReceiverEvent(const ReceiverEvent& event)
             [this, handle](ErrorCode err, Connection connection) {
                 if (err == ErrorCode::OK) {
                     vfo_connections_.emplace(handle,
-                                             boost::signals2::scoped_connection(
-                                                 std::move(connection)));
+                                             ScopedConnection(connection));
                 } else {
                     // FIXME
                 }
@@ -119,7 +140,71 @@ void GrpcServer::HandleVfoEvent(const VfoEvent& event)
         return;
     }
 
-    events_queue_.push(ToGeneralEvent(event));
+    PushEvent(ToGeneralEvent(event));
+}
+
+void GrpcServer::PushEvent(const Event& event)
+{
+    // Converted and serialized here once, instead of once per subscriber.
+    SerializedEvent serialized;
+    if (!SerializeEvent(event, &event_proto_, &serialized.buffer)) {
+        return;
+    }
+    serialized.unsubscribed = std::holds_alternative<Unsubscribed>(event);
+
+    int64_t id = std::visit([](const auto& ev) { return ev.id; }, event);
+
+    std::scoped_lock lock{events_mutex_};
+
+    // Unsubscribed would end the stream of a subscriber resuming later.
+    if (id >= 0 && !serialized.unsubscribed) {
+        if (events_log_.size() == kEventsLogSize) {
+            events_log_horizon_ = events_log_.front().first;
+            events_log_.pop_front();
+        }
+        events_log_.emplace_back(id, serialized);
+    } else {
+        // Not logged, like the VfoSyncStart ... VfoSyncEnd state sent when a
+        // VFO is added, which has no id. Whoever was subscribed before it and
+        // may have missed it must get a full sync.
+        events_log_horizon_ = EventCommon::last_id.load();
+    }
+
+    events_queue_.push(std::move(serialized));
+    events_published_++;
+}
+
+bool GrpcServer::ResumeEvents(
+    int64_t last_seen_event_id, std::queue<SerializedEvent>* replay,
+    broadcast_queue::receiver<SerializedEvent>* reader)
+{
+    std::scoped_lock lock{events_mutex_};
+
+    // Either events after it were dropped from the log or never logged, or
+    // it was never given by this server.
+    if (last_seen_event_id < events_log_horizon_ ||
+        last_seen_event_id >= EventCommon::last_id.load()) {
+        return false;
+    }
+
+    for (const auto& [id, event] : events_log_) {
+        if (id > last_seen_event_id) {
+            replay->push(event);
+        }
+    }
+    *reader = events_queue_.subscribe();
+
+    return true;
+}
+
+GrpcServer::Stats GrpcServer::GetStats() const
+{
+    return Stats{
+        .subscribers = subscribers_,
+        .iqStreams = iq_streams_,
+        .laggedDisconnects = lagged_disconnects_,
+        .eventsPublished = events_published_,
+    };
 }
 
 grpc::ServerUnaryReactor*
@@ -1068,11 +1153,218 @@ GrpcServer::GetRdsData(grpc::CallbackServerContext* context,
     return reactor;
 }
 
+grpc::ServerUnaryReactor*
+GrpcServer::StartIqStream(grpc::CallbackServerContext* context,
+                          const Receiver::VfoIqStreamRequest* request,
+                          Receiver::EmptyResponse* response)
+{
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+
+    ENTER_VFO_CONTEXT(reactor, response, request->handle(), vfo);
+
+    IqStreamParams params{
+        .sampleRate = static_cast<int>(request->sample_rate()),
+        .format = static_cast<IqFormat>(request->format()),
+        .transport = static_cast<IqTransport>(request->transport()),
+        .host = request->host(),
+        .port = static_cast<int>(request->port()),
+    };
+
+    vfo->startIqStream(params, [=](ErrorCode err) {
+        response->set_code(ErrorCodeCoreToProto(err));
+        reactor->Finish(grpc::Status::OK);
+    });
+
+    EXIT_VFO_CONTEXT();
+
+    return reactor;
+}
+
+grpc::ServerUnaryReactor*
+GrpcServer::StopIqStream(grpc::CallbackServerContext* context,
+                         const Receiver::VfoHandle* request,
+                         Receiver::EmptyResponse* response)
+{
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+
+    ENTER_VFO_CONTEXT(reactor, response, request->handle(), vfo);
+
+    vfo->stopIqStream([=](ErrorCode err) {
+        response->set_code(ErrorCodeCoreToProto(err));
+        reactor->Finish(grpc::Status::OK);
+    });
+
+    EXIT_VFO_CONTEXT();
+
+    return reactor;
+}
+
+grpc::ServerUnaryReactor* GrpcServer::GetPerfStats(
+    grpc::CallbackServerContext* context,
+    [[maybe_unused]] const google::protobuf::Empty* request,
+    Receiver::PerfStatsResponse* response)
+{
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+
+    async_receiver_->getPerfStats([=](ErrorCode err, PerfStats stats) {
+        response->set_code(ErrorCodeCoreToProto(err));
+        PerfStatsCoreToProto(stats, response);
+        reactor->Finish(grpc::Status::OK);
+    });
+
+    return reactor;
+}
+
+grpc::ServerUnaryReactor* GrpcServer::GetWorkerStats(
+    grpc::CallbackServerContext* context,
+    [[maybe_unused]] const google::protobuf::Empty* request,
+    Receiver::WorkerStatsResponse* response)
+{
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+
+    async_receiver_->getWorkerStats([=](ErrorCode err, WorkerStats stats) {
+        response->set_code(ErrorCodeCoreToProto(err));
+        WorkerStatsCoreToProto(stats, response);
+        reactor->Finish(grpc::Status::OK);
+    });
+
+    return reactor;
+}
+
+// Streams the I/Q packets of a vfo until the client goes away. The stream has
+// no gaps: a client that can't keep up is disconnected, like with events.
+class GrpcServer::IqStreamReactor
+    : public grpc::ServerWriteReactor<Receiver::IqChunk>
+{
+public:
+    IqStreamReactor(grpc::CallbackServerContext* context, GrpcServer* server,
+                    uint64_t handle) :
+        context_{context},
+        server_{server},
+        finished_{false},
+        peer{context_->peer()}
+    {
+        spdlog::info("GrpcServer: Client ({}) is reading I/Q", peer);
+        server_->iq_streams_++;
+
+        server->async_receiver_->getVfo(
+            handle, [this](ErrorCode err, AsyncVfoIface::sptr vfo) {
+                if (err != ErrorCode::OK) {
+                    FinishIfNotAlreadyFinished(
+                        grpc::Status(grpc::StatusCode::NOT_FOUND,
+                                     errorMsg(err)));
+                    return;
+                }
+
+                vfo->subscribeIq([this](ErrorCode err, IqReceiver reader) {
+                    if (err != ErrorCode::OK) {
+                        FinishIfNotAlreadyFinished(grpc::Status(
+                            grpc::StatusCode::UNAVAILABLE, errorMsg(err)));
+                        return;
+                    }
+
+                    reader_ = std::move(reader);
+
+                    worker_thread_.start();
+                    worker_thread_.schedule("WaitAndWriteChunk",
+                                            [this]() { WaitAndWriteChunk(); });
+                });
+            });
+    }
+
+    void WaitAndWriteChunk()
+    {
+        while (true) {
+            broadcast_queue::Error err =
+                reader_.wait_dequeue_timed(&packet_, std::chrono::seconds(1));
+
+            switch (err) {
+            case broadcast_queue::Error::None:
+                chunk_.set_offset(packet_.offset);
+                chunk_.set_sample_rate(packet_.sampleRate);
+                chunk_.set_format(
+                    static_cast<Receiver::IqFormat>(packet_.format));
+                chunk_.set_data(packet_.data, packet_.size);
+
+                StartWrite(&chunk_);
+                return;
+            case broadcast_queue::Error::Timeout:
+                // The stream may be stopped, or not started yet.
+                break;
+            case broadcast_queue::Error::Lagged:
+                spdlog::info("Client ({}) lagged. Disconnecting...", peer);
+                server_->lagged_disconnects_++;
+                FinishIfNotAlreadyFinished(grpc::Status::CANCELLED);
+                return;
+            case broadcast_queue::Error::Closed:
+                FinishIfNotAlreadyFinished(grpc::Status::CANCELLED);
+                return;
+            }
+
+            if (context_->IsCancelled()) {
+                FinishIfNotAlreadyFinished(grpc::Status::CANCELLED);
+                return;
+            }
+        }
+    }
+
+    void FinishIfNotAlreadyFinished(const grpc::Status& status)
+    {
+        bool expected = false;
+
+        if (finished_.compare_exchange_strong(expected, true)) {
+            Finish(status);
+        }
+    }
+
+    void OnWriteDone(bool ok) override
+    {
+        if (!ok) {
+            spdlog::info("Failed to send I/Q to ({}). Disconnecting...", peer);
+            FinishIfNotAlreadyFinished(grpc::Status::OK);
+            return;
+        }
+
+        worker_thread_.schedule("WaitAndWriteChunk",
+                                [this]() { WaitAndWriteChunk(); });
+    }
+
+    void OnDone() override
+    {
+        spdlog::info("GrpcServer: Finished streaming I/Q to ({})", peer);
+        server_->iq_streams_--;
+        delete this;
+    }
+
+private:
+    grpc::CallbackServerContext* context_;
+    GrpcServer* server_;
+    Receiver::IqChunk chunk_;
+
+    IqReceiver reader_;
+    IqPacket packet_;
+
+    WorkerThread worker_thread_;
+
+    std::atomic<bool> finished_;
+
+    // context_->peer() becomes "unknown" once the client is disconnected.
+    std::string peer;
+};
+
+grpc::ServerWriteReactor<Receiver::IqChunk>*
+GrpcServer::ReadIqStream(grpc::CallbackServerContext* context,
+                         const Receiver::VfoHandle* request)
+{
+    return new IqStreamReactor(context, this, request->handle());
+}
+
 class GrpcServer::EventsReactor
-    : public grpc::ServerWriteReactor<Receiver::Event>
+    : public grpc::ServerWriteReactor<grpc::ByteBuffer>
 {
 public:
-    EventsReactor(grpc::CallbackServerContext* context, GrpcServer* server) :
+    EventsReactor(grpc::CallbackServerContext* context, GrpcServer* server,
+                  std::optional<int64_t> last_seen_event_id) :
         context_{context},
         server_{server},
         finished_{false},
@@ -1080,6 +1372,23 @@ public:
         peer{context_->peer()}
     {
         spdlog::info("GrpcServer: Client ({}) has subscribed", peer);
+        server_->subscribers_++;
+
+        // Only the missed events, no need to go through the receiver.
+        if (last_seen_event_id &&
+            server_->ResumeEvents(*last_seen_event_id, &replayed_events_,
+                                  &events_reader_)) {
+            spdlog::info("GrpcServer: Client ({}) resumed after event {}, {} "
+                         "events replayed",
+                         peer, *last_seen_event_id, replayed_events_.size());
+
+            worker_thread_.start();
+            if (!WriteSyncEvent()) {
+                worker_thread_.schedule("WaitAndWriteEvent",
+                                        [this]() { WaitAndWriteEvent(); });
+            }
+            return;
+        }
 
         server_->async_receiver_->synchronize([this](ErrorCode err) {
             if (err != ErrorCode::OK) {
@@ -1146,33 +1455,48 @@ public:
             Event event = std::move(sync_events_.front());
             sync_events_.pop();
 
-            success = WriteEvent(event);
+            // Sync events are specific to this subscriber, so they are
+            // serialized here.
+            success = SerializeEvent(event, &sync_proto_, &response_);
+            if (success) {
+                StartWrite(&response_);
+            }
+        }
+
+        if (!success && !replayed_events_.empty()) {
+            // Already serialized by PushEvent.
+            response_.Swap(&replayed_events_.front().buffer);
+            replayed_events_.pop();
+
+            StartWrite(&response_);
+            success = true;
         }
         return success;
     }
 
     void WaitAndWriteEvent()
     {
-        Event event;
+        SerializedEvent event;
         while (true) {
             broadcast_queue::Error err = events_reader_.wait_dequeue_timed(
                 &event, std::chrono::seconds(5));
 
             switch (err) {
             case broadcast_queue::Error::None:
-                if (std::holds_alternative<Unsubscribed>(event)) {
+                if (event.unsubscribed) {
                     unsubscribed_ = true;
                 }
 
-                if (WriteEvent(event)) {
-                    return;
-                }
-                break;
+                // Only references the buffer serialized by PushEvent.
+                response_.Swap(&event.buffer);
+                StartWrite(&response_);
+                return;
             case broadcast_queue::Error::Timeout:
                 // Keep trying!
                 break;
             case broadcast_queue::Error::Lagged:
                 spdlog::info("Client ({}) lagged. Disconnecting...", peer);
+                server_->lagged_disconnects_++;
                 FinishIfNotAlreadyFinished(grpc::Status::CANCELLED);
                 return;
 
@@ -1201,18 +1525,6 @@ public:
         }
     }
 
-    // Returns false if the event doesn't have an equivalent proto event.
-    bool WriteEvent(const Event& event)
-    {
-        bool ok = EventCoreToProto(event, &response_);
-
-        if (ok) {
-            StartWrite(&response_);
-        }
-
-        return ok;
-    }
-
     void OnWriteDone(bool ok) override
     {
         if (!ok) {
@@ -1240,20 +1552,24 @@ public:
     void OnDone() override
     {
         spdlog::info("GrpcServer: Finished dealing with ({})", peer);
+        server_->subscribers_--;
         // Very scary!
         delete this;
     }
 
 private:
     grpc::CallbackServerContext* context_;
-    Receiver::Event response_;
+    grpc::ByteBuffer response_;
+    Receiver::Event sync_proto_;
     GrpcServer* server_;
 
     // First events to send, and after we finish them, we read from the
-    // broadcast_queue
+    // broadcast_queue. A resumed subscription has no sync events, only the
+    // replayed ones.
     std::queue<Event> sync_events_;
+    std::queue<SerializedEvent> replayed_events_;
     std::mutex sync_events_mtx_;
-    broadcast_queue::receiver<Event> events_reader_;
+    broadcast_queue::receiver<SerializedEvent> events_reader_;
 
     // Is using a worker thread an overkill? Maybe use a raw thread?
     WorkerThread worker_thread_;
@@ -1267,11 +1583,24 @@ private:
     std::string peer;
 };
 
-grpc::ServerWriteReactor<Receiver::Event>*
+grpc::ServerWriteReactor<grpc::ByteBuffer>*
 GrpcServer::Subscribe(grpc::CallbackServerContext* context,
-                      [[maybe_unused]] const google::protobuf::Empty* request)
+                      const grpc::ByteBuffer* request)
 {
-    return new EventsReactor(context, this);
+    // A raw method gets the request unparsed. The copy only references the
+    // same slices, Deserialize consumes it.
+    grpc::ByteBuffer buffer{*request};
+    Receiver::SubscribeRequest subscribe_request;
+
+    std::optional<int64_t> last_seen_event_id;
+    if (grpc::SerializationTraits<Receiver::SubscribeRequest>::Deserialize(
+            &buffer, &subscribe_request)
+            .ok() &&
+        subscribe_request.has_last_seen_event_id()) {
+        last_seen_event_id = subscribe_request.last_seen_event_id();
+    }
+
+    return new EventsReactor(context, this, last_seen_event_id);
 }
 
 GrpcServer::~GrpcServer() { Shutdown(); }
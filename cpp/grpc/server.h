@@ -1,11 +1,15 @@
 #ifndef VIOLETRX_GRPC_SERVER_H
 #define VIOLETRX_GRPC_SERVER_H
 
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
 #include <shared_mutex>
 #include <string>
 
-#include <boost/signals2.hpp>
 #include <broadcast_queue.h>
 #include <unordered_map>
 
@@ -16,7 +20,10 @@
 namespace violetrx
 {
 
-class GrpcServer : public Receiver::Rx::CallbackService
+// Subscribe is implemented as a raw method, so that every event is
+// serialized once and the same buffer is written to all subscribers.
+class GrpcServer : public Receiver::Rx::WithRawCallbackMethod_Subscribe<
+                       Receiver::Rx::CallbackService>
 {
 public:
     GrpcServer(violetrx::AsyncReceiverIface::sptr async_receiver,
@@ -26,10 +33,21 @@ public:
     void Shutdown();
     void Wait();
 
+    // Read from the atomics below, for the metrics endpoint
+    struct Stats {
+        uint64_t subscribers;       // Connected event subscribers
+        uint64_t iqStreams;         // Connected I/Q stream readers
+        uint64_t laggedDisconnects; // Clients dropped for falling behind
+        uint64_t eventsPublished;
+    };
+
+    Stats GetStats() const;
+
 private:
     // Runs in the async receiver thread
     void HandleReceiverEvent(const ReceiverEvent&);
     void HandleVfoEvent(const VfoEvent&);
+    void PushEvent(const Event&);
 
 private:
     grpc::ServerUnaryReactor* Start(grpc::CallbackServerContext* context,
@@ -264,26 +282,75 @@ private:
                const Receiver::VfoHandle* request,
                Receiver::RdsDataResponse* response) override;
 
-    grpc::ServerWriteReactor<Receiver::Event>*
+    grpc::ServerUnaryReactor*
+    StartIqStream(grpc::CallbackServerContext* context,
+                  const Receiver::VfoIqStreamRequest* request,
+                  Receiver::EmptyResponse* response) override;
+
+    grpc::ServerUnaryReactor*
+    StopIqStream(grpc::CallbackServerContext* context,
+                 const Receiver::VfoHandle* request,
+                 Receiver::EmptyResponse* response) override;
+
+    grpc::ServerUnaryReactor*
+    GetPerfStats(grpc::CallbackServerContext* context,
+                 const google::protobuf::Empty* request,
+                 Receiver::PerfStatsResponse* response) override;
+
+    grpc::ServerUnaryReactor*
+    GetWorkerStats(grpc::CallbackServerContext* context,
+                   const google::protobuf::Empty* request,
+                   Receiver::WorkerStatsResponse* response) override;
+
+    grpc::ServerWriteReactor<Receiver::IqChunk>*
+    ReadIqStream(grpc::CallbackServerContext* context,
+                 const Receiver::VfoHandle* request) override;
+
+    grpc::ServerWriteReactor<grpc::ByteBuffer>*
     Subscribe(grpc::CallbackServerContext* context,
-              const google::protobuf::Empty* request) override;
+              const grpc::ByteBuffer* request) override;
 
 private:
     class EventsReactor;
+    class IqStreamReactor;
+
+    // A Receiver::Event in its wire format. Copying it only references the
+    // same slices.
+    struct SerializedEvent {
+        grpc::ByteBuffer buffer;
+        bool unsubscribed = false;
+    };
+
+    // Subscribes \p reader to the events after \p last_seen_event_id, and
+    // copies the logged ones into \p replay. Returns false, and subscribes
+    // nothing, if some of these events are no longer logged.
+    bool ResumeEvents(int64_t last_seen_event_id,
+                      std::queue<SerializedEvent>* replay,
+                      broadcast_queue::receiver<SerializedEvent>* reader);
 
 private:
     std::unique_ptr<grpc::Server> server_;
     violetrx::AsyncReceiverIface::sptr async_receiver_;
 
-    boost::signals2::scoped_connection connection_;
-    std::unordered_map<uint64_t, boost::signals2::scoped_connection>
-        vfo_connections_;
+    ScopedConnection connection_;
+    std::unordered_map<uint64_t, ScopedConnection> vfo_connections_;
     // FIXME: Currently broadcast_queue is single producer multiple consumer.
     // But this queue will accept events from the receiver and the vfos, so the
     // underlying assumption here is that these events will come from a single
     // thread, which is true but maybe it's time to extend the broadcast queue
     // to be multiple producer?
-    broadcast_queue::sender<Event> events_queue_;
+    broadcast_queue::sender<SerializedEvent> events_queue_;
+    Receiver::Event event_proto_; // Reused to convert events
+
+    // The last published events, oldest first, for the subscribers resuming
+    // after a disconnection. Pushed to together with events_queue_ under
+    // events_mutex_, so that a resuming subscriber neither misses nor gets
+    // twice the events between the two.
+    std::mutex events_mutex_;
+    std::deque<std::pair<int64_t, SerializedEvent>> events_log_;
+    // Resuming after an id below this one could miss events that were
+    // dropped from the log, or never logged.
+    int64_t events_log_horizon_;
 
     // Fft caching
     FftFrame last_fft_frame_;
@@ -291,6 +358,11 @@ private:
 
     std::shared_mutex fft_mutex_;
     std::atomic<bool> updating_fft_frame_;
+
+    std::atomic<uint64_t> subscribers_{0};
+    std::atomic<uint64_t> iq_streams_{0};
+    std::atomic<uint64_t> lagged_disconnects_{0};
+    std::atomic<uint64_t> events_published_{0};
 };
 
 } // namespace violetrx
@@ -1,7 +1,6 @@
 #ifndef SERVER_TRANSACTIONS_POSTER
 #define SERVER_TRANSACTIONS_POSTER
 
-#include <boost/signals2/connection.hpp>
 #include <broadcast_queue.h>
 
 #include "async_core/async_receiver_iface.h"
@@ -26,12 +25,12 @@ private:
 private:
     struct VfoData {
         violetrx::AsyncVfoIface::sptr vfo;
-        boost::signals2::scoped_connection connection;
+        violetrx::ScopedConnection connection;
     };
 
     broadcast_queue::sender<Transaction> tx_sender;
     violetrx::AsyncReceiverIface::sptr rx;
-    boost::signals2::scoped_connection connection;
+    violetrx::ScopedConnection connection;
     // std::vector<VfoData>
 };
 
@@ -98,6 +98,137 @@ Device DeviceProtoToCore(const Receiver::Device& proto_device)
     return result;
 }
 
+static void BlockPerfStatsCoreToProto(const BlockPerfStats& stats,
+                                      Receiver::BlockPerfStats* proto_stats)
+{
+    proto_stats->set_name(stats.name);
+    proto_stats->set_work_time_avg(stats.workTimeAvg);
+    proto_stats->set_work_time_total(stats.workTimeTotal);
+    proto_stats->set_nproduced_avg(stats.nproducedAvg);
+    proto_stats->set_input_buffers_full(stats.inputBuffersFull);
+    proto_stats->set_output_buffers_full(stats.outputBuffersFull);
+}
+
+static BlockPerfStats
+BlockPerfStatsProtoToCore(const Receiver::BlockPerfStats& proto_stats)
+{
+    return BlockPerfStats{
+        .name = proto_stats.name(),
+        .workTimeAvg = proto_stats.work_time_avg(),
+        .workTimeTotal = proto_stats.work_time_total(),
+        .nproducedAvg = proto_stats.nproduced_avg(),
+        .inputBuffersFull = proto_stats.input_buffers_full(),
+        .outputBuffersFull = proto_stats.output_buffers_full(),
+    };
+}
+
+void PerfStatsCoreToProto(const PerfStats& stats,
+                          Receiver::PerfStatsResponse* response)
+{
+    for (const auto& block : stats.blocks) {
+        BlockPerfStatsCoreToProto(block, response->add_blocks());
+    }
+
+    for (const auto& vfo : stats.vfos) {
+        Receiver::VfoPerfStats* proto_vfo = response->add_vfos();
+        proto_vfo->set_handle(vfo.handle);
+        proto_vfo->set_work_time_total(vfo.workTimeTotal);
+
+        for (const auto& block : vfo.blocks) {
+            BlockPerfStatsCoreToProto(block, proto_vfo->add_blocks());
+        }
+    }
+}
+
+PerfStats PerfStatsProtoToCore(const Receiver::PerfStatsResponse& response)
+{
+    PerfStats result;
+
+    for (const auto& proto_block : response.blocks()) {
+        result.blocks.push_back(BlockPerfStatsProtoToCore(proto_block));
+    }
+
+    for (const auto& proto_vfo : response.vfos()) {
+        VfoPerfStats vfo{
+            .handle = proto_vfo.handle(),
+            .workTimeTotal = proto_vfo.work_time_total(),
+            .blocks = {},
+        };
+        for (const auto& proto_block : proto_vfo.blocks()) {
+            vfo.blocks.push_back(BlockPerfStatsProtoToCore(proto_block));
+        }
+
+        result.vfos.push_back(std::move(vfo));
+    }
+
+    return result;
+}
+
+static void LatencyHistogramCoreToProto(const LatencyHistogram& histogram,
+                                        Receiver::LatencyHistogram* proto)
+{
+    proto->mutable_buckets()->Add(histogram.buckets.begin(),
+                                  histogram.buckets.end());
+    proto->set_count(histogram.count);
+    proto->set_sum(histogram.sum);
+    proto->set_max(histogram.max);
+}
+
+static LatencyHistogram
+LatencyHistogramProtoToCore(const Receiver::LatencyHistogram& proto)
+{
+    return LatencyHistogram{
+        .buckets = {proto.buckets().begin(), proto.buckets().end()},
+        .count = proto.count(),
+        .sum = proto.sum(),
+        .max = proto.max(),
+    };
+}
+
+void WorkerStatsCoreToProto(const WorkerStats& stats,
+                            Receiver::WorkerStatsResponse* response)
+{
+    response->set_queue_depth(stats.queueDepth);
+    response->set_stalled(stats.stalled);
+    response->set_current_command(stats.currentCommand);
+    response->set_current_command_duration(stats.currentCommandDuration);
+    response->set_avg_latency(stats.avgLatency);
+
+    for (const auto& command : stats.commands) {
+        Receiver::CommandStats* proto_command = response->add_commands();
+        proto_command->set_command(command.command);
+        LatencyHistogramCoreToProto(command.queueWait,
+                                    proto_command->mutable_queue_wait());
+        LatencyHistogramCoreToProto(command.execution,
+                                    proto_command->mutable_execution());
+    }
+}
+
+WorkerStats
+WorkerStatsProtoToCore(const Receiver::WorkerStatsResponse& response)
+{
+    WorkerStats result{
+        .queueDepth = response.queue_depth(),
+        .stalled = response.stalled(),
+        .currentCommand = response.current_command(),
+        .currentCommandDuration = response.current_command_duration(),
+        .avgLatency = response.avg_latency(),
+        .commands = {},
+    };
+
+    for (const auto& proto_command : response.commands()) {
+        result.commands.push_back(CommandStats{
+            .command = proto_command.command(),
+            .queueWait =
+                LatencyHistogramProtoToCore(proto_command.queue_wait()),
+            .execution =
+                LatencyHistogramProtoToCore(proto_command.execution()),
+        });
+    }
+
+    return result;
+}
+
 std::optional<Event> EventProtoToCore(const Receiver::Event& proto_event)
 {
     std::optional<Event> event = std::nullopt;
@@ -198,6 +329,9 @@ std::optional<Event> EventProtoToCore(const Receiver::Event& proto_event)
         event = FftWindowChanged{
             ec, WindowProtoToCore(proto_event.fft_window_changed().window())};
         break;
+    case Receiver::Event::TxCase::kInputEof:
+        event = InputEof{ec};
+        break;
     case Receiver::Event::TxCase::kVfoAdded:
         event = VfoAdded{VfoEventCommon{ec, proto_event.vfo_added().handle()}};
         break;
@@ -330,6 +464,29 @@ std::optional<Event> EventProtoToCore(const Receiver::Event& proto_event)
         event = RecordingStopped{
             VfoEventCommon{ec, proto_event.recording_stopped().handle()}};
         break;
+    case Receiver::Event::TxCase::kAudioSegmentRecorded:
+        event = AudioSegmentRecorded{
+            VfoEventCommon{ec, proto_event.audio_segment_recorded().handle()},
+            proto_event.audio_segment_recorded().path(),
+            TimestampProtoToCore(proto_event.audio_segment_recorded().start()),
+            proto_event.audio_segment_recorded().duration(),
+        };
+        break;
+    case Receiver::Event::TxCase::kIqStreamStarted:
+        event = IqStreamStarted{
+            VfoEventCommon{ec, proto_event.iq_stream_started().handle()},
+            static_cast<int>(proto_event.iq_stream_started().sample_rate()),
+            static_cast<IqFormat>(proto_event.iq_stream_started().format()),
+            static_cast<IqTransport>(
+                proto_event.iq_stream_started().transport()),
+            proto_event.iq_stream_started().host(),
+            static_cast<int>(proto_event.iq_stream_started().port()),
+        };
+        break;
+    case Receiver::Event::TxCase::kIqStreamStopped:
+        event = IqStreamStopped{
+            VfoEventCommon{ec, proto_event.iq_stream_stopped().handle()}};
+        break;
     case Receiver::Event::TxCase::kSnifferStarted:
         event = SnifferStarted{
             VfoEventCommon{ec, proto_event.sniffer_started().handle()},
@@ -548,6 +705,10 @@ bool EventCoreToProto(const Event& event, Receiver::Event* proto_event)
                     "an equivalent proto type!");
                 return false;
             },
+            [&](const InputEof&) {
+                proto_event->set_allocated_input_eof(new Receiver::InputEof());
+                return true;
+            },
             [&](const VfoAdded& ev) {
                 auto* proto_specific_event = new Receiver::VfoAdded();
                 proto_specific_event->set_handle(ev.handle);
@@ -755,6 +916,20 @@ bool EventCoreToProto(const Event& event, Receiver::Event* proto_event)
                     proto_specific_event);
                 return true;
             },
+            [&](const AudioSegmentRecorded& ev) {
+                auto* proto_specific_event =
+                    new Receiver::AudioSegmentRecorded();
+                proto_specific_event->set_handle(ev.handle);
+                proto_specific_event->set_path(ev.path);
+                proto_specific_event->set_allocated_start(
+                    new google::protobuf::Timestamp(
+                        TimestampCoreToProto(ev.start)));
+                proto_specific_event->set_duration(ev.duration);
+
+                proto_event->set_allocated_audio_segment_recorded(
+                    proto_specific_event);
+                return true;
+            },
             [&](const SnifferStarted& ev) {
                 auto* proto_specific_event = new Receiver::SnifferStarted();
                 proto_specific_event->set_handle(ev.handle);
@@ -785,6 +960,29 @@ bool EventCoreToProto(const Event& event, Receiver::Event* proto_event)
                     "an equivalent proto type!");
                 return false;
             },
+            [&](const IqStreamStarted& ev) {
+                auto* proto_specific_event = new Receiver::IqStreamStarted();
+                proto_specific_event->set_handle(ev.handle);
+                proto_specific_event->set_sample_rate(ev.sample_rate);
+                proto_specific_event->set_format(
+                    static_cast<Receiver::IqFormat>(ev.format));
+                proto_specific_event->set_transport(
+                    static_cast<Receiver::IqTransport>(ev.transport));
+                proto_specific_event->set_host(ev.host);
+                proto_specific_event->set_port(ev.port);
+
+                proto_event->set_allocated_iq_stream_started(
+                    proto_specific_event);
+                return true;
+            },
+            [&](const IqStreamStopped& ev) {
+                auto* proto_specific_event = new Receiver::IqStreamStopped();
+                proto_specific_event->set_handle(ev.handle);
+
+                proto_event->set_allocated_iq_stream_stopped(
+                    proto_specific_event);
+                return true;
+            },
             [&](const RdsDecoderStarted& ev) {
                 auto* proto_specific_event = new Receiver::RdsDecoderStarted();
                 proto_specific_event->set_handle(ev.handle);
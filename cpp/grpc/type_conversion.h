@@ -32,6 +32,14 @@ Device DeviceProtoToCore(const Receiver::Device& proto_device);
 void FftFrameCoreToProto(const FftFrame& frame,
                          Receiver::FftFrame* proto_frame);
 
+void PerfStatsCoreToProto(const PerfStats& stats,
+                          Receiver::PerfStatsResponse* response);
+PerfStats PerfStatsProtoToCore(const Receiver::PerfStatsResponse& response);
+void WorkerStatsCoreToProto(const WorkerStats& stats,
+                            Receiver::WorkerStatsResponse* response);
+WorkerStats
+WorkerStatsProtoToCore(const Receiver::WorkerStatsResponse& response);
+
 } // namespace violetrx
 
 #endif // VIOLETRX_TYPE_CONVERSION_H
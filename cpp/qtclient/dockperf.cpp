@@ -0,0 +1,98 @@
+#include "dockperf.h"
+#include "receiver_model.h"
+
+#include <QHeaderView>
+#include <QTimer>
+#include <QTreeWidget>
+
+enum Column {
+    COL_NAME,
+    COL_WORK_TOTAL,
+    COL_WORK_AVG,
+    COL_NPRODUCED,
+    COL_IN_FULL,
+    COL_OUT_FULL,
+};
+
+DockPerf::DockPerf(ReceiverModel* rxModel_, QWidget* parent) :
+    QDockWidget("DSP performance", parent), rxModel(rxModel_)
+{
+    setObjectName("DockPerf");
+
+    tree = new QTreeWidget(this);
+    tree->setHeaderLabels({"Block", "Total (s)", "Avg work (us)", "Avg items",
+                           "In full", "Out full"});
+    tree->header()->setSectionResizeMode(COL_NAME,
+                                         QHeaderView::ResizeToContents);
+    tree->setUniformRowHeights(true);
+    setWidget(tree);
+
+    timer = new QTimer(this);
+    timer->setInterval(1000);
+    connect(timer, &QTimer::timeout, this, &DockPerf::refresh);
+
+    connect(this, &QDockWidget::visibilityChanged, this,
+            &DockPerf::onVisibilityChanged);
+}
+
+void DockPerf::onVisibilityChanged(bool visible)
+{
+    if (visible) {
+        refresh();
+        timer->start();
+    } else {
+        timer->stop();
+    }
+}
+
+void DockPerf::refresh()
+{
+    rxModel->getPerfStats()
+        .then(this, [this](violetrx::PerfStats stats) { setStats(stats); })
+        .onFailed(this, [this]() { tree->clear(); });
+}
+
+void DockPerf::setStats(const violetrx::PerfStats& stats)
+{
+    tree->clear();
+
+    auto* receiver = new QTreeWidgetItem(tree, {"Receiver"});
+    addBlocks(receiver, stats.blocks);
+    receiver->setExpanded(true);
+
+    for (const auto& vfo : stats.vfos) {
+        QString name = QString("VFO %1").arg(vfo.handle);
+        for (VFOChannelModel* model : rxModel->vfoChannels()) {
+            if (model->getId() == vfo.handle) {
+                name = model->name();
+                break;
+            }
+        }
+
+        auto* item = new QTreeWidgetItem(tree, {name});
+        item->setText(COL_WORK_TOTAL,
+                      QString::number(vfo.workTimeTotal, 'f', 3));
+        addBlocks(item, vfo.blocks);
+    }
+}
+
+void DockPerf::addBlocks(QTreeWidgetItem* parent,
+                         const std::vector<violetrx::BlockPerfStats>& blocks)
+{
+    for (const auto& block : blocks) {
+        auto* item = new QTreeWidgetItem(parent);
+        item->setText(COL_NAME, QString::fromStdString(block.name));
+        item->setText(COL_WORK_TOTAL,
+                      QString::number(block.workTimeTotal, 'f', 3));
+        item->setText(COL_WORK_AVG,
+                      QString::number(block.workTimeAvg * 1e6, 'f', 1));
+        item->setText(COL_NPRODUCED,
+                      QString::number(block.nproducedAvg, 'f', 0));
+        item->setText(COL_IN_FULL,
+                      QString::number(block.inputBuffersFull * 100, 'f', 0) +
+                          "%");
+        item->setText(COL_OUT_FULL,
+                      QString::number(block.outputBuffersFull * 100, 'f', 0) +
+                          "%");
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef DOCKPERF_H
+#define DOCKPERF_H
+
+#include <QDockWidget>
+
+#include "async_core/types.h"
+
+class ReceiverModel;
+class QTimer;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+/*! \brief Time spent in the DSP blocks of the receiver and of every VFO.
+ *
+ * The counters are only polled while the dock is visible.
+ */
+class DockPerf : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DockPerf(ReceiverModel* rxModel, QWidget* parent = nullptr);
+
+private:
+    void onVisibilityChanged(bool visible);
+    void refresh();
+    void setStats(const violetrx::PerfStats& stats);
+
+    void addBlocks(QTreeWidgetItem* parent,
+                   const std::vector<violetrx::BlockPerfStats>& blocks);
+
+private:
+    ReceiverModel* rxModel;
+
+    QTreeWidget* tree;
+    QTimer* timer;
+};
+
+#endif // DOCKPERF_H
@@ -46,6 +46,7 @@
 #include <QVBoxLayout>
 #include <QtGlobal>
 
+#include "dockperf.h"
 #include "grpc/grpc_async_receiver.h"
 #include "ioconfig.h"
 #include "mainwindow.h"
@@ -107,6 +108,7 @@ MainWindow::MainWindow(QWidget* parent) :
 
     uiDockInputCtl = new DockInputCtl(rxModel, this);
     uiDockFft = new DockFft(rxModel, this);
+    uiDockPerf = new DockPerf(rxModel, this);
 
     // setup some toggle view shortcuts
     uiDockInputCtl->toggleViewAction()->setShortcut(
@@ -137,7 +139,9 @@ MainWindow::MainWindow(QWidget* parent) :
     addDockWidget(Qt::RightDockWidgetArea, uiDockVfosOpt);
     addDockWidget(Qt::RightDockWidgetArea, uiDockFft);
     tabifyDockWidget(uiDockInputCtl, uiDockVfosOpt);
+    addDockWidget(Qt::RightDockWidgetArea, uiDockPerf);
     tabifyDockWidget(uiDockVfosOpt, uiDockFft);
+    tabifyDockWidget(uiDockFft, uiDockPerf);
     uiDockVfosOpt->raise();
 
     /* Add dock widget actions to View menu. By doing it this way all
@@ -146,6 +150,7 @@ MainWindow::MainWindow(QWidget* parent) :
     ui->menu_View->addAction(uiDockInputCtl->toggleViewAction());
     ui->menu_View->addAction(uiDockVfosOpt->toggleViewAction());
     ui->menu_View->addAction(uiDockFft->toggleViewAction());
+    ui->menu_View->addAction(uiDockPerf->toggleViewAction());
     ui->menu_View->addSeparator();
     ui->menu_View->addAction(ui->mainToolBar->toggleViewAction());
     ui->menu_View->addSeparator();
@@ -222,6 +227,7 @@ MainWindow::~MainWindow()
     delete ui;
     delete uiDockVfosOpt;
     delete uiDockFft;
+    delete uiDockPerf;
     delete uiDockInputCtl;
     delete fftAverager;
 }
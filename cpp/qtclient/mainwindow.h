@@ -43,6 +43,7 @@ namespace Ui
 class MainWindow; /*! The main window UI */
 }
 
+class DockPerf;
 class FftAverager;
 class VFOGraphicsItem;
 class VfosOpt;
@@ -95,6 +96,7 @@ private:
 
     DockInputCtl* uiDockInputCtl;
     DockFft* uiDockFft;
+    DockPerf* uiDockPerf;
 
     /* data decoders */
     bool dec_rds{};
@@ -165,6 +165,7 @@ void ReceiverModel::onStateChanged(const void* event_erased)
             [&](const IqRecordingStopped&) {
                 INVOKE_METHOD(onIqRecordingStopped());
             },
+            [&](const InputEof&) {},
             [&](const FreqCorrChanged& ev) {
                 INVOKE_METHOD(onFreqCorrChanged(ev.ppm));
             },
@@ -393,7 +394,8 @@ QFuture<void> ReceiverModel::startIqRecording(const QString& filename)
     QPromise<void> promise;
     QFuture<void> future = promise.future();
 
-    rx->startIqRecording(filename.toStdString(), DEFAULT_VOID_CALLBACK);
+    rx->startIqRecording(filename.toStdString(), violetrx::IqFormat::CF32,
+                         DEFAULT_VOID_CALLBACK);
 
     return future;
 }
@@ -414,6 +416,16 @@ QFuture<void> ReceiverModel::seekIqFile(long /* pos */)
     return QtFuture::makeReadyFuture();
 }
 
+QFuture<violetrx::PerfStats> ReceiverModel::getPerfStats()
+{
+    QPromise<violetrx::PerfStats> promise;
+    QFuture<violetrx::PerfStats> future = promise.future();
+
+    rx->getPerfStats(DEFAULT_ARG_CALLBACK);
+
+    return future;
+}
+
 QFuture<VFOChannelModel*> ReceiverModel::addVFOChannel()
 {
     QPromise<VFOChannelModel*> promise;
@@ -1054,7 +1066,7 @@ QFuture<void> VFOChannelModel::startUdpStreaming(const QString host, int port,
     QPromise<void> promise;
     QFuture<void> future = promise.future();
 
-    vfo->startUdpStreaming(host.toStdString(), port, stereo,
+    vfo->startUdpStreaming(host.toStdString(), port, stereo, false,
                            DEFAULT_VOID_CALLBACK);
 
     return future;
@@ -1486,6 +1498,7 @@ void VFOChannelModel::onStateChanged(const void* event_erased)
             [&](const RecordingStopped&) {
                 INVOKE_METHOD(onRecordingStopped());
             },
+            [&](const AudioSegmentRecorded&) {},
             [&](const SnifferStarted& ev) {
                 INVOKE_METHOD(onSnifferStarted(ev.sample_rate, ev.size));
             },
@@ -1497,6 +1510,8 @@ void VFOChannelModel::onStateChanged(const void* event_erased)
             [&](const UdpStreamingStopped&) {
                 INVOKE_METHOD(onUdpStreamingStopped());
             },
+            [&](const IqStreamStarted&) {},
+            [&](const IqStreamStopped&) {},
             [&](const RdsDecoderStarted&) {
                 INVOKE_METHOD(onRdsDecoderStarted());
             },
@@ -6,8 +6,6 @@
 #include <QObject>
 #include <QString>
 
-#include <boost/signals2/connection.hpp>
-
 #include "async_core/types.h"
 
 // Not really necessary, but I would like to give this "style" a chance instead
@@ -396,7 +394,7 @@ private:
     QString m_name;
 
     /* connections */
-    boost::signals2::scoped_connection conStateChanged;
+    violetrx::ScopedConnection conStateChanged;
 };
 
 class ReceiverModel : public QObject
@@ -442,6 +440,9 @@ public:
     QFuture<void> stopIqRecording();
     QFuture<void> seekIqFile(long pos);
 
+    /* DSP performance counters */
+    QFuture<violetrx::PerfStats> getPerfStats();
+
     QFuture<VFOChannelModel*> addVFOChannel();
     QFuture<void> removeVFOChannel(VFOChannelModel*);
 
@@ -561,7 +562,7 @@ private:
     QList<QString> m_antennas;
 
     /* connections */
-    boost::signals2::scoped_connection conStateChanged;
+    violetrx::ScopedConnection conStateChanged;
 };
 
 #endif // RECEIVER_MODEL_H
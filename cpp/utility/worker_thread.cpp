@@ -1,6 +1,8 @@
 #include "worker_thread.h"
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
 #include <chrono>
 #include <fmt/chrono.h>
 #include <spdlog/spdlog.h>
@@ -55,11 +57,23 @@ bool WorkerThread::scheduleImpl(const char* cmd, Function<void()> task)
     }
 }
 
+bool WorkerThread::isStalled() const
+{
+    std::scoped_lock lock{statsMutex};
+    return isStalledLocked(std::chrono::steady_clock::now());
+}
+
+// statsMutex must be held
+bool WorkerThread::isStalledLocked(
+    std::chrono::steady_clock::time_point now) const
+{
+    return inTask.load(std::memory_order_relaxed) &&
+           (now - taskStartTime) > MAX_TASK_DURATION;
+}
+
 bool WorkerThread::isPaused()
 {
-    if (inTask.load(std::memory_order_relaxed) &&
-        (std::chrono::steady_clock::now() - taskStartTime) >
-            MAX_TASK_DURATION) {
+    if (isStalled()) {
         spdlog::error("The worker thread has been doing one task ({}) for over "
                       "{} seconds. The thread will not accept any more tasks "
                       "until the task queue is empty to prevent overflowing!",
@@ -87,9 +101,10 @@ void WorkerThread::start()
 
 bool WorkerThread::isJoinable() const { return thread.joinable(); }
 
-std::chrono::microseconds WorkerThread::getAvgLatency()
+std::chrono::microseconds WorkerThread::getAvgLatency() const
 {
-    return std::chrono::microseconds(avgLatency / FACTOR);
+    return std::chrono::microseconds(
+        avgLatency.load(std::memory_order_relaxed) / FACTOR);
 }
 
 void WorkerThread::updateAvgLatency(const Task& task)
@@ -100,20 +115,148 @@ void WorkerThread::updateAvgLatency(const Task& task)
                            .count() *
                        FACTOR;
 
-    // exponentially moving average
-    avgLatency = (avgLatency * ONE_MINUS_ALPHA + latency * ALPHA) / FACTOR;
+    // exponentially moving average, only the worker writes it
+    uint64_t avg = avgLatency.load(std::memory_order_relaxed);
+    avgLatency.store((avg * ONE_MINUS_ALPHA + latency * ALPHA) / FACTOR,
+                     std::memory_order_relaxed);
+}
+
+void WorkerThread::Histogram::add(std::chrono::microseconds duration)
+{
+    uint64_t us = std::max<int64_t>(duration.count(), 0);
+    size_t bucket = std::min<size_t>(std::bit_width(us), HISTOGRAM_BUCKETS - 1);
+
+    buckets[bucket]++;
+    count++;
+    sum += duration;
+    max = std::max(max, duration);
+}
+
+WorkerThread::Stats WorkerThread::getStats() const
+{
+    Stats stats{
+        .queueDepth = tasks.size_approx(),
+        .stalled = false,
+        .currentCmd = {},
+        .currentTaskDuration = std::chrono::microseconds{0},
+        .avgLatency = getAvgLatency(),
+        .commands = {},
+    };
+
+    std::scoped_lock lock{statsMutex};
+
+    const auto now = std::chrono::steady_clock::now();
+    stats.stalled = isStalledLocked(now);
+
+    if (inTask.load(std::memory_order_relaxed)) {
+        stats.currentCmd = lastCmd.load();
+        stats.currentTaskDuration =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                now - taskStartTime);
+    }
+
+    stats.commands.reserve(commandStats.size());
+    for (const auto& [cmd, command] : commandStats) {
+        stats.commands.push_back(command);
+    }
+
+    return stats;
+}
+
+void WorkerThread::setPeriodicTask(std::chrono::milliseconds interval,
+                                   Function<void()> task)
+{
+    std::unique_lock lock{periodicMutex};
+
+    // the task can replace itself, but can't wait for its own run
+    if (std::this_thread::get_id() != getId()) {
+        periodicDone.wait(lock, [this]() { return !periodicRunning; });
+    }
+
+    periodicTask = std::move(task);
+    periodicInterval = interval;
+    periodicNextRun = std::chrono::steady_clock::now();
+    periodicGeneration++;
+}
+
+// Returns how long the event loop may wait for the next task
+std::chrono::steady_clock::duration WorkerThread::runPeriodicTask()
+{
+    using std::chrono::steady_clock;
+
+    steady_clock::duration timeout = std::chrono::seconds(1);
+
+    std::unique_lock lock{periodicMutex};
+
+    if (!periodicTask)
+        return timeout;
+
+    auto now = steady_clock::now();
+    if (now >= periodicNextRun) {
+        // run without the lock, so that the task may call setPeriodicTask()
+        // and take locks its callers hold
+        auto task = std::move(periodicTask);
+        const uint64_t generation = periodicGeneration;
+        periodicRunning = true;
+        lock.unlock();
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            spdlog::error("Periodic task raised an exception: {}", e.what());
+        }
+
+        lock.lock();
+        periodicRunning = false;
+        now = steady_clock::now();
+
+        // unless it was replaced in the meantime
+        if (periodicGeneration == generation) {
+            periodicTask = std::move(task);
+
+            // skip the runs that were missed while a task was running
+            periodicNextRun = std::max(periodicNextRun + periodicInterval, now);
+        }
+        periodicDone.notify_all();
+
+        if (!periodicTask)
+            return timeout;
+    }
+
+    return std::clamp<steady_clock::duration>(periodicNextRun - now,
+                                              steady_clock::duration::zero(),
+                                              timeout);
 }
 
 void WorkerThread::startEventLoop(std::stop_token stopToken)
 {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
     Task task;
 
     while (!stopToken.stop_requested()) {
-        if (tasks.wait_dequeue_timed(task, std::chrono::seconds(1))) {
+        auto timeout = runPeriodicTask();
+
+        if (tasks.wait_dequeue_timed(task, timeout)) {
             updateAvgLatency(task);
 
-            taskStartTime = std::chrono::steady_clock::now();
-            lastCmd = task.cmd;
+            CommandStats* command;
+            {
+                std::scoped_lock lock{statsMutex};
+
+                taskStartTime = std::chrono::steady_clock::now();
+                lastCmd = task.cmd;
+
+                // the entries are never erased, the pointer stays valid
+                auto [it, inserted] = commandStats.try_emplace(task.cmd);
+                if (inserted) {
+                    it->second.cmd = task.cmd;
+                }
+                command = &it->second;
+                command->queueWait.add(duration_cast<microseconds>(
+                    taskStartTime - task.timestamp));
+            }
 
             inTask = true;
 
@@ -124,6 +267,12 @@ void WorkerThread::startEventLoop(std::stop_token stopToken)
                               lastCmd.load(), e.what());
             }
             inTask = false;
+
+            auto duration = std::chrono::steady_clock::now() - taskStartTime;
+            {
+                std::scoped_lock lock{statsMutex};
+                command->execution.add(duration_cast<microseconds>(duration));
+            }
         }
     }
 }
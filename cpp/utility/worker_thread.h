@@ -1,12 +1,19 @@
 #ifndef WORKER_THREAD_H
 #define WORKER_THREAD_H
 
+#include <array>
 #include <atomic>
 #include <blockingconcurrentqueue.h>
 #include <chrono>
+#include <condition_variable>
 #include <function2/function2.hpp>
 #include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <vector>
 
 namespace violetrx
 {
@@ -25,6 +32,35 @@ private:
 public:
     using sptr = std::shared_ptr<WorkerThread>;
 
+    // Durations in power of two buckets: bucket 0 counts the ones under 1 us,
+    // bucket i the ones in [2^(i-1), 2^i) us, and the last one everything
+    // longer.
+    static constexpr size_t HISTOGRAM_BUCKETS = 24;
+
+    struct Histogram {
+        std::array<uint64_t, HISTOGRAM_BUCKETS> buckets{};
+        uint64_t count = 0;
+        std::chrono::microseconds sum{0};
+        std::chrono::microseconds max{0};
+
+        void add(std::chrono::microseconds duration);
+    };
+
+    struct CommandStats {
+        std::string cmd;
+        Histogram queueWait; // From schedule() to the start of the task
+        Histogram execution;
+    };
+
+    struct Stats {
+        size_t queueDepth;
+        bool stalled; // The current task is running for too long
+        std::string currentCmd;
+        std::chrono::microseconds currentTaskDuration;
+        std::chrono::microseconds avgLatency;
+        std::vector<CommandStats> commands;
+    };
+
     WorkerThread();
     ~WorkerThread();
 
@@ -66,23 +102,49 @@ public:
 
     bool isPaused();
 
+    // Safe to call from any thread, even while the worker is stuck in a task
+    Stats getStats() const;
+
+    // Run a task on the worker thread every interval, between two tasks of
+    // the queue, e.g. to refresh snapshots read by other threads. It doesn't
+    // go through the queue, so it isn't counted in the stats. Safe to call
+    // from any thread, and returns once a run in progress is over, except
+    // from the task itself. An empty task removes the current one.
+    void setPeriodicTask(std::chrono::milliseconds interval,
+                         Function<void()> task);
+
 private:
     bool scheduleImpl(const char* cmd, Function<void()> task);
     void scheduleForcedImpl(const char* cmd, Function<void()> task);
     void updateAvgLatency(const Task& task);
-    std::chrono::microseconds getAvgLatency();
+    std::chrono::microseconds getAvgLatency() const;
+    bool isStalled() const;
+    bool isStalledLocked(std::chrono::steady_clock::time_point now) const;
 
     void startEventLoop(std::stop_token);
+    std::chrono::steady_clock::duration runPeriodicTask();
 
 private:
     moodycamel::BlockingConcurrentQueue<Task> tasks;
-    uint64_t avgLatency;
+    // Written by the worker, read by getStats() from any thread
+    std::atomic<uint64_t> avgLatency;
 
     std::atomic<bool> inTask;
-    std::chrono::steady_clock::time_point taskStartTime;
 
     std::jthread thread;
     std::atomic<const char*> lastCmd;
+
+    std::mutex periodicMutex; // Not held while the task runs
+    std::condition_variable periodicDone;
+    Function<void()> periodicTask; // Moved out while it runs
+    std::chrono::milliseconds periodicInterval{0};
+    std::chrono::steady_clock::time_point periodicNextRun;
+    bool periodicRunning = false;
+    uint64_t periodicGeneration = 0; // Bumped by setPeriodicTask()
+
+    mutable std::mutex statsMutex; // Protects the members below
+    std::chrono::steady_clock::time_point taskStartTime;
+    std::map<std::string_view, CommandStats> commandStats;
 };
 } // namespace violetrx
 
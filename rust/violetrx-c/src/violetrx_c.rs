@@ -103,6 +103,7 @@ enum CVioletEventType {
     FftWindowChanged,
     IqRecordingStarted,
     IqRecordingStopped,
+    InputEof,
 
     // vfo events
     VfoSyncStart,
@@ -130,10 +131,13 @@ enum CVioletEventType {
     VfoAmSyncPllBwChanged,
     VfoRecordingStarted,
     VfoRecordingStopped,
+    VfoAudioSegmentRecorded,
     VfoSnifferStarted,
     VfoSnifferStopped,
     VfoUdpStreamingStarted,
     VfoUdpStreamingStopped,
+    VfoIqStreamStarted,
+    VfoIqStreamStopped,
     VfoRdsDecoderStarted,
     VfoRdsDecoderStopped,
     VfoRdsParserReset,
@@ -281,6 +285,11 @@ struct CVioletIqRecordingStopped {
     base: CVioletEventCommon,
 }
 
+#[repr(C)]
+struct CVioletInputEof {
+    base: CVioletEventCommon,
+}
+
 #[repr(C)]
 struct CVioletVfoSyncStart {
     base: CVioletVfoEventCommon,
@@ -430,6 +439,14 @@ struct CVioletRecordingStopped {
     base: CVioletVfoEventCommon,
 }
 
+#[repr(C)]
+struct CVioletAudioSegmentRecorded {
+    base: CVioletVfoEventCommon,
+    path: *const c_char,
+    start: CVioletTimestamp,
+    duration: f64,
+}
+
 #[repr(C)]
 struct CVioletSnifferStarted {
     base: CVioletVfoEventCommon,
@@ -463,6 +480,7 @@ struct CVioletUdpStreamingStarted {
     host: *const c_char,
     port: i32,
     stereo: bool,
+    rtp: bool,
 }
 
 #[repr(C)]
@@ -470,6 +488,21 @@ struct CVioletUdpStreamingStopped {
     base: CVioletVfoEventCommon,
 }
 
+#[repr(C)]
+struct CVioletIqStreamStarted {
+    base: CVioletVfoEventCommon,
+    sample_rate: i32,
+    format: c_int,
+    transport: c_int,
+    host: *const c_char,
+    port: i32,
+}
+
+#[repr(C)]
+struct CVioletIqStreamStopped {
+    base: CVioletVfoEventCommon,
+}
+
 #[repr(C)]
 struct CVioletAudioGainChanged {
     base: CVioletVfoEventCommon,
@@ -1413,6 +1446,10 @@ fn get_violet_event_data(c_violet_event_ptr: *const CVioletEventCommon) -> Recei
             // TODO
             ReceiverEventData::Unknown
         }
+        CVioletEventType::InputEof => {
+            // TODO
+            ReceiverEventData::Unknown
+        }
         CVioletEventType::VfoSyncStart => {
             // TODO
             ReceiverEventData::Unknown
@@ -1513,6 +1550,10 @@ fn get_violet_event_data(c_violet_event_ptr: *const CVioletEventCommon) -> Recei
             // TODO
             ReceiverEventData::Unknown
         }
+        CVioletEventType::VfoAudioSegmentRecorded => {
+            // TODO
+            ReceiverEventData::Unknown
+        }
         CVioletEventType::VfoSnifferStarted => {
             // TODO
             ReceiverEventData::Unknown
@@ -1529,6 +1570,14 @@ fn get_violet_event_data(c_violet_event_ptr: *const CVioletEventCommon) -> Recei
             // TODO
             ReceiverEventData::Unknown
         }
+        CVioletEventType::VfoIqStreamStarted => {
+            // TODO
+            ReceiverEventData::Unknown
+        }
+        CVioletEventType::VfoIqStreamStopped => {
+            // TODO
+            ReceiverEventData::Unknown
+        }
         CVioletEventType::VfoRdsDecoderStarted => {
             // TODO
             ReceiverEventData::Unknown